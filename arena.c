@@ -0,0 +1,172 @@
+/*
+ *  arena.c
+ *  dang
+ *
+=head1 NAME
+
+arena
+
+=head1 INTRODUCTION
+
+An arena is a stack-like allocator for objects whose lifetimes are (almost always) nested, such as call frames.
+Allocating bumps a pointer within the current block, and releasing the most recent allocation moves it back again, so
+neither normally touches malloc.  An arena belongs to a single thread, and does no locking.
+
+Allocations may be released out of order.  The memory of an allocation released early is only reused once every
+allocation made after it has been released too.
+
+=head1 PUBLIC INTERFACE
+
+=over
+
+=cut
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug.h"
+
+#include "arena.h"
+
+#define ARENA_ALIGN(size)   (((size) + sizeof(arena_align_t) - 1) & ~(sizeof(arena_align_t) - 1))
+
+static arena_block_t *_arena_block_allocate(arena_t *, size_t);
+
+/*
+=item arena_init()
+
+=item arena_destroy()
+
+Setup and teardown functions for arenas.  Destroying an arena frees all of its memory, including any allocations that
+haven't been released.
+
+=cut
+ */
+int arena_init(arena_t *self) {
+    assert(self != NULL);
+
+    memset(self, 0, sizeof(*self));
+    return 0;
+}
+
+int arena_destroy(arena_t *self) {
+    assert(self != NULL);
+
+    while (self->m_top != NULL) {
+        arena_block_t *block = self->m_top;
+        self->m_top = block->m_prev;
+        free(block);
+    }
+    if (self->m_spare != NULL)  free(self->m_spare);
+
+    memset(self, 0, sizeof(*self));
+    return 0;
+}
+
+/*
+=item arena_allocate()
+
+Allocates size bytes from the arena, suitably aligned for any type.  The memory is not initialised.
+
+Returns a pointer to the allocated memory, or NULL if it couldn't be allocated.
+
+=cut
+ */
+void *arena_allocate(arena_t *self, size_t size) {
+    assert(self != NULL);
+
+    const size_t needed = ARENA_ALIGN(sizeof(arena_record_t)) + ARENA_ALIGN(size);
+
+    arena_block_t *block = self->m_top;
+    if (block == NULL || block->m_size - block->m_used < needed) {
+        if (NULL == (block = _arena_block_allocate(self, needed)))  return NULL;
+    }
+
+    arena_record_t *record = (arena_record_t *) ((char *) block->m_data + block->m_used);
+    record->m_prev = block->m_last;
+    record->m_released = 0;
+
+    block->m_last = record;
+    block->m_used += needed;
+
+    return (char *) record + ARENA_ALIGN(sizeof(arena_record_t));
+}
+
+/*
+=item arena_release()
+
+Releases an allocation previously returned by arena_allocate().  If it's the most recent allocation still held, its
+memory (and that of any earlier allocations already released) becomes available again immediately.
+
+=cut
+ */
+void arena_release(arena_t *self, void *ptr) {
+    assert(self != NULL);
+    assert(ptr != NULL);
+
+    arena_record_t *record = (arena_record_t *) ((char *) ptr - ARENA_ALIGN(sizeof(arena_record_t)));
+    assert(record->m_released == 0);
+    record->m_released = 1;
+
+    while (self->m_top != NULL) {
+        arena_block_t *block = self->m_top;
+
+        while (block->m_last != NULL && block->m_last->m_released) {
+            block->m_used = (char *) block->m_last - (char *) block->m_data;
+            block->m_last = block->m_last->m_prev;
+        }
+
+        if (block->m_last != NULL || block->m_prev == NULL)  break;
+
+        // this block is now empty, keep it as the spare and carry on with the one below
+        self->m_top = block->m_prev;
+        if (self->m_spare != NULL)  free(self->m_spare);
+        self->m_spare = block;
+    }
+}
+
+/*
+=back
+
+=head1 PRIVATE INTERFACE
+
+=over
+
+=item _arena_block_allocate()
+
+Pushes a new block, big enough for at least the given number of bytes, onto the arena.  Reuses the spare block if
+it's big enough.
+
+=cut
+ */
+static arena_block_t *_arena_block_allocate(arena_t *self, size_t needed) {
+    arena_block_t *block;
+
+    if (self->m_spare != NULL && self->m_spare->m_size >= needed) {
+        block = self->m_spare;
+        self->m_spare = NULL;
+    }
+    else {
+        const size_t size = (needed > ARENA_BLOCK_SIZE ? needed : ARENA_BLOCK_SIZE);
+        if (NULL == (block = malloc(sizeof(*block) + size))) {
+            debug("couldn't allocate arena block of %zu bytes\n", size);
+            return NULL;
+        }
+        block->m_size = size;
+    }
+
+    block->m_used = 0;
+    block->m_last = NULL;
+    block->m_prev = self->m_top;
+    self->m_top = block;
+
+    return block;
+}
+
+/*
+=back
+
+=cut
+ */
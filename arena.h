@@ -0,0 +1,48 @@
+/*
+ *  arena.h
+ *  dang
+ *
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef ARENA_BLOCK_SIZE
+#define ARENA_BLOCK_SIZE    (16384)
+#endif
+
+/* n.b. max_align_t isn't available before C11 */
+typedef union arena_align_t {
+    intmax_t m_int;
+    long double m_float;
+    void *m_pointer;
+} arena_align_t;
+
+typedef struct arena_record_t {
+    struct arena_record_t *m_prev;
+    size_t m_released;
+} arena_record_t;
+
+typedef struct arena_block_t {
+    struct arena_block_t *m_prev;
+    arena_record_t *m_last;
+    size_t m_size;
+    size_t m_used;
+    arena_align_t m_data[];
+} arena_block_t;
+
+typedef struct arena_t {
+    arena_block_t *m_top;
+    arena_block_t *m_spare;
+} arena_t;
+
+int arena_init(arena_t *);
+int arena_destroy(arena_t *);
+
+void *arena_allocate(arena_t *, size_t);
+void arena_release(arena_t *, void *);
+
+#endif
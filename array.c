@@ -49,7 +49,13 @@ array
 
 =item array_pool_destroy()
 
-Setup and teardown functions for the array pool.
+=item array_pool_flush()
+
+=item array_pool_stats()
+
+Setup and teardown functions for the array pool.  array_pool_flush() gives the calling thread's cached free arrays
+back to the pool, and must be called by each thread before it finishes.  array_pool_stats() fills in stats with the
+pool's allocation counts, as POOL_MAGAZINE_STATS() does.
 
 =cut
  */
@@ -61,6 +67,14 @@ int array_pool_destroy(void) {
     return POOL_DESTROY(array_t);
 }
 
+int array_pool_flush(void) {
+    return POOL_FLUSH(array_t);
+}
+
+int array_pool_stats(pool_magazine_stats_t *stats) {
+    return POOL_MAGAZINE_STATS(array_t, stats);
+}
+
 /*
 =item array_allocate()
 
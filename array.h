@@ -27,12 +27,14 @@ typedef struct array_t {
 
 int _array_init(array_t *);
 int _array_destroy(array_t *);
-POOL_HEADER_CONTENTS(array_t, array_handle_t, PTHREAD_MUTEX_ERRORCHECK, _array_init, _array_destroy);
+POOL_HEADER_CONTENTS(array_t, array_handle_t, PTHREAD_MUTEX_ERRORCHECK, POOL_LOCK_MUTEX, _array_init, _array_destroy);
 
 struct scalar_t;
 
 int array_pool_init(void);
 int array_pool_destroy(void);
+int array_pool_flush(void);
+int array_pool_stats(pool_magazine_stats_t *);
 
 array_handle_t array_allocate(flags8_t);
 array_handle_t array_allocate_many(size_t, flags8_t);
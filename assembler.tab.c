@@ -0,0 +1,2563 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+/* Substitute the variable and function names.  */
+#define yyparse         ass_parse
+#define yylex           ass_lex
+#define yyerror         ass_error
+#define yydebug         ass_debug
+#define yynerrs         ass_nerrs
+#define yylval          ass_lval
+#define yychar          ass_char
+#define yylloc          ass_lloc
+
+/* First part of user prologue.  */
+#line 10 "assembler.y"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "assembler.h"
+#include "bytecode.h"
+#include "debug.h"
+#include "floatptr_t.h"
+#include "util.h"
+#include "vmtypes.h"
+
+    static int ass_lex(void);
+    static void ass_error(const char *);
+    
+    static char *read_identifier(void);
+    static char *read_quoted(int);
+    static int read_hex_byte(void);
+    static int read_octal_byte(void);
+    static int read_hex_value(void);
+    static int read_octal_value(void);
+    
+    typedef struct line_t line_t;
+    typedef struct param_t param_t;
+    typedef struct label_t label_t;
+    typedef struct label_ref_t label_ref_t;
+    
+    static label_t *get_label(const char *, const char *);
+    static line_t *get_line(label_t *, uintptr_t, param_t *);
+    static void append_param(param_t *, param_t *);
+
+    static FILE     *g_input = NULL;
+    static line_t   *g_lines = NULL;
+    static line_t   *g_last_line = NULL;
+    static label_t  *g_labels = NULL;
+    static label_t  *g_last_label = NULL;
+    static char     *g_last_label_defined = NULL;
+
+    struct label_t {
+        label_t *m_next;
+        char *m_label;
+        line_t *m_line;
+    };
+    
+    struct param_t {
+        param_t *m_next;
+        enum param_type_t { P_INTEGER, P_FLOAT, P_STRING, P_LABEL_LOC, P_LABEL_OFF, } m_type;
+        union param_value_t {
+            intptr_t as_integer;
+            floatptr_t as_float;
+            char *as_string;
+            label_t *as_label;
+        } m_value;
+    };
+    
+    struct line_t {
+        line_t *m_next;
+        uintptr_t m_position;
+        uintptr_t m_length;
+        label_t *m_label;
+        param_t *m_params;
+        uintptr_t m_instruction;
+    };
+    
+    
+
+#line 149 "assembler.tab.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int ass_debug;
+#endif
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    INTEGER = 258,                 /* INTEGER  */
+    FLOAT = 259,                   /* FLOAT  */
+    STRING = 260,                  /* STRING  */
+    LABEL = 261,                   /* LABEL  */
+    INST = 262                     /* INST  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 80 "assembler.y"
+
+    intptr_t ival;
+    floatptr_t fval;
+    char *sval;
+    uintptr_t instruction;
+    label_t *label;
+    line_t *line;
+    param_t *param;
+
+#line 213 "assembler.tab.c"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+/* Location type.  */
+#if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
+typedef struct YYLTYPE YYLTYPE;
+struct YYLTYPE
+{
+  int first_line;
+  int first_column;
+  int last_line;
+  int last_column;
+};
+# define YYLTYPE_IS_DECLARED 1
+# define YYLTYPE_IS_TRIVIAL 1
+#endif
+
+
+extern YYSTYPE ass_lval;
+extern YYLTYPE ass_lloc;
+
+int ass_parse (void);
+
+
+
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_INTEGER = 3,                    /* INTEGER  */
+  YYSYMBOL_FLOAT = 4,                      /* FLOAT  */
+  YYSYMBOL_STRING = 5,                     /* STRING  */
+  YYSYMBOL_LABEL = 6,                      /* LABEL  */
+  YYSYMBOL_INST = 7,                       /* INST  */
+  YYSYMBOL_8_n_ = 8,                       /* '\n'  */
+  YYSYMBOL_9_ = 9,                         /* ':'  */
+  YYSYMBOL_10_ = 10,                       /* '.'  */
+  YYSYMBOL_11_ = 11,                       /* ','  */
+  YYSYMBOL_12_ = 12,                       /* '&'  */
+  YYSYMBOL_13_ = 13,                       /* '~'  */
+  YYSYMBOL_YYACCEPT = 14,                  /* $accept  */
+  YYSYMBOL_program = 15,                   /* program  */
+  YYSYMBOL_line = 16,                      /* line  */
+  YYSYMBOL_labeldef = 17,                  /* labeldef  */
+  YYSYMBOL_params = 18,                    /* params  */
+  YYSYMBOL_params1 = 19,                   /* params1  */
+  YYSYMBOL_param = 20,                     /* param  */
+  YYSYMBOL_label = 21                      /* label  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if 1
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* 1 */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL \
+             && defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+  YYLTYPE yyls_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
+      + 2 * YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  2
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   25
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  14
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  8
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  20
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  30
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   262
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       8,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,    12,     2,
+       2,     2,     2,     2,    11,     2,    10,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     9,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,    13,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_uint8 yyrline[] =
+{
+       0,   105,   105,   106,   109,   110,   113,   114,   115,   118,
+     119,   122,   123,   126,   127,   128,   129,   130,   133,   134,
+     135
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if 1
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "INTEGER", "FLOAT",
+  "STRING", "LABEL", "INST", "'\\n'", "':'", "'.'", "','", "'&'", "'~'",
+  "$accept", "program", "line", "labeldef", "params", "params1", "param",
+  "label", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-7)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-1)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int8 yypact[] =
+{
+      -7,     5,    -7,    -6,     6,    -7,    -1,    -7,     4,    -3,
+      -7,    -7,    -7,    -7,    -7,    -2,    -2,     8,     3,    -7,
+       7,    12,    -7,    -7,    -7,    -3,    13,    -7,    -7,    -7
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       2,     6,     1,     0,     0,     3,     0,     7,     0,     9,
+       4,     8,    13,    14,    15,     0,     0,     0,    10,    11,
+      20,     0,    16,    17,     5,     0,     0,    19,    12,    18
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int8 yypgoto[] =
+{
+      -7,    -7,    -7,    -7,    -7,    -7,    -5,     9
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,     1,     5,     6,    17,    18,    19,    22
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
+{
+      12,    13,    14,     7,    20,     2,     9,    10,    21,    15,
+      16,     3,     8,    11,    25,     4,    24,    26,    27,    29,
+      28,     0,     0,     0,     0,    23
+};
+
+static const yytype_int8 yycheck[] =
+{
+       3,     4,     5,     9,     6,     0,     7,     8,    10,    12,
+      13,     6,     6,     9,    11,    10,     8,    10,     6,     6,
+      25,    -1,    -1,    -1,    -1,    16
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,    15,     0,     6,    10,    16,    17,     9,     6,     7,
+       8,     9,     3,     4,     5,    12,    13,    18,    19,    20,
+       6,    10,    21,    21,     8,    11,    10,     6,    20,     6
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    14,    15,    15,    16,    16,    17,    17,    17,    18,
+      18,    19,    19,    20,    20,    20,    20,    20,    21,    21,
+      21
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     0,     2,     2,     4,     0,     2,     3,     0,
+       1,     1,     3,     1,     1,     1,     2,     2,     3,     2,
+       1
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
+   If N is 0, then set CURRENT to the empty location which ends
+   the previous symbol: RHS[0] (always defined).  */
+
+#ifndef YYLLOC_DEFAULT
+# define YYLLOC_DEFAULT(Current, Rhs, N)                                \
+    do                                                                  \
+      if (N)                                                            \
+        {                                                               \
+          (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;        \
+          (Current).first_column = YYRHSLOC (Rhs, 1).first_column;      \
+          (Current).last_line    = YYRHSLOC (Rhs, N).last_line;         \
+          (Current).last_column  = YYRHSLOC (Rhs, N).last_column;       \
+        }                                                               \
+      else                                                              \
+        {                                                               \
+          (Current).first_line   = (Current).last_line   =              \
+            YYRHSLOC (Rhs, 0).last_line;                                \
+          (Current).first_column = (Current).last_column =              \
+            YYRHSLOC (Rhs, 0).last_column;                              \
+        }                                                               \
+    while (0)
+#endif
+
+#define YYRHSLOC(Rhs, K) ((Rhs)[K])
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+/* YYLOCATION_PRINT -- Print the location on the stream.
+   This macro was not mandated originally: define only if we know
+   we won't break user code: when these are the locations we know.  */
+
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+
+/* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
+
+YY_ATTRIBUTE_UNUSED
+static int
+yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
+{
+  int res = 0;
+  int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
+  if (0 <= yylocp->first_line)
+    {
+      res += YYFPRINTF (yyo, "%d", yylocp->first_line);
+      if (0 <= yylocp->first_column)
+        res += YYFPRINTF (yyo, ".%d", yylocp->first_column);
+    }
+  if (0 <= yylocp->last_line)
+    {
+      if (yylocp->first_line < yylocp->last_line)
+        {
+          res += YYFPRINTF (yyo, "-%d", yylocp->last_line);
+          if (0 <= end_col)
+            res += YYFPRINTF (yyo, ".%d", end_col);
+        }
+      else if (0 <= end_col && yylocp->first_column < end_col)
+        res += YYFPRINTF (yyo, "-%d", end_col);
+    }
+  return res;
+}
+
+#   define YYLOCATION_PRINT  yy_location_print_
+
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, Location); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  YYLOCATION_PRINT (yyo, yylocationp);
+  YYFPRINTF (yyo, ": ");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]));
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, yylsp, Rule); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+/* Context of a parse error.  */
+typedef struct
+{
+  yy_state_t *yyssp;
+  yysymbol_kind_t yytoken;
+  YYLTYPE *yylloc;
+} yypcontext_t;
+
+/* Put in YYARG at most YYARGN of the expected tokens given the
+   current YYCTX, and return the number of tokens stored in YYARG.  If
+   YYARG is null, return the number of expected tokens (guaranteed to
+   be less than YYNTOKENS).  Return YYENOMEM on memory exhaustion.
+   Return 0 if there are more than YYARGN expected tokens, yet fill
+   YYARG up to YYARGN. */
+static int
+yypcontext_expected_tokens (const yypcontext_t *yyctx,
+                            yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  int yyn = yypact[+*yyctx->yyssp];
+  if (!yypact_value_is_default (yyn))
+    {
+      /* Start YYX at -YYN if negative to avoid negative indexes in
+         YYCHECK.  In other words, skip the first -YYN actions for
+         this state because they are default actions.  */
+      int yyxbegin = yyn < 0 ? -yyn : 0;
+      /* Stay within bounds of both yycheck and yytname.  */
+      int yychecklim = YYLAST - yyn + 1;
+      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
+      int yyx;
+      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
+        if (yycheck[yyx + yyn] == yyx && yyx != YYSYMBOL_YYerror
+            && !yytable_value_is_error (yytable[yyx + yyn]))
+          {
+            if (!yyarg)
+              ++yycount;
+            else if (yycount == yyargn)
+              return 0;
+            else
+              yyarg[yycount++] = YY_CAST (yysymbol_kind_t, yyx);
+          }
+    }
+  if (yyarg && yycount == 0 && 0 < yyargn)
+    yyarg[0] = YYSYMBOL_YYEMPTY;
+  return yycount;
+}
+
+
+
+
+#ifndef yystrlen
+# if defined __GLIBC__ && defined _STRING_H
+#  define yystrlen(S) (YY_CAST (YYPTRDIFF_T, strlen (S)))
+# else
+/* Return the length of YYSTR.  */
+static YYPTRDIFF_T
+yystrlen (const char *yystr)
+{
+  YYPTRDIFF_T yylen;
+  for (yylen = 0; yystr[yylen]; yylen++)
+    continue;
+  return yylen;
+}
+# endif
+#endif
+
+#ifndef yystpcpy
+# if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
+#  define yystpcpy stpcpy
+# else
+/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
+   YYDEST.  */
+static char *
+yystpcpy (char *yydest, const char *yysrc)
+{
+  char *yyd = yydest;
+  const char *yys = yysrc;
+
+  while ((*yyd++ = *yys++) != '\0')
+    continue;
+
+  return yyd - 1;
+}
+# endif
+#endif
+
+#ifndef yytnamerr
+/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
+   quotes and backslashes, so that it's suitable for yyerror.  The
+   heuristic is that double-quoting is unnecessary unless the string
+   contains an apostrophe, a comma, or backslash (other than
+   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
+   null, do not copy; instead, return the length of what the result
+   would have been.  */
+static YYPTRDIFF_T
+yytnamerr (char *yyres, const char *yystr)
+{
+  if (*yystr == '"')
+    {
+      YYPTRDIFF_T yyn = 0;
+      char const *yyp = yystr;
+      for (;;)
+        switch (*++yyp)
+          {
+          case '\'':
+          case ',':
+            goto do_not_strip_quotes;
+
+          case '\\':
+            if (*++yyp != '\\')
+              goto do_not_strip_quotes;
+            else
+              goto append;
+
+          append:
+          default:
+            if (yyres)
+              yyres[yyn] = *yyp;
+            yyn++;
+            break;
+
+          case '"':
+            if (yyres)
+              yyres[yyn] = '\0';
+            return yyn;
+          }
+    do_not_strip_quotes: ;
+    }
+
+  if (yyres)
+    return yystpcpy (yyres, yystr) - yyres;
+  else
+    return yystrlen (yystr);
+}
+#endif
+
+
+static int
+yy_syntax_error_arguments (const yypcontext_t *yyctx,
+                           yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  /* There are many possibilities here to consider:
+     - If this state is a consistent state with a default action, then
+       the only way this function was invoked is if the default action
+       is an error action.  In that case, don't check for expected
+       tokens because there are none.
+     - The only way there can be no lookahead present (in yychar) is if
+       this state is a consistent state with a default action.  Thus,
+       detecting the absence of a lookahead is sufficient to determine
+       that there is no unexpected or expected token to report.  In that
+       case, just report a simple "syntax error".
+     - Don't assume there isn't a lookahead just because this state is a
+       consistent state with a default action.  There might have been a
+       previous inconsistent state, consistent state with a non-default
+       action, or user semantic action that manipulated yychar.
+     - Of course, the expected token list depends on states to have
+       correct lookahead information, and it depends on the parser not
+       to perform extra reductions after fetching a lookahead from the
+       scanner and before detecting a syntax error.  Thus, state merging
+       (from LALR or IELR) and default reductions corrupt the expected
+       token list.  However, the list is correct for canonical LR with
+       one exception: it will still contain any token that will not be
+       accepted due to an error action in a later state.
+  */
+  if (yyctx->yytoken != YYSYMBOL_YYEMPTY)
+    {
+      int yyn;
+      if (yyarg)
+        yyarg[yycount] = yyctx->yytoken;
+      ++yycount;
+      yyn = yypcontext_expected_tokens (yyctx,
+                                        yyarg ? yyarg + 1 : yyarg, yyargn - 1);
+      if (yyn == YYENOMEM)
+        return YYENOMEM;
+      else
+        yycount += yyn;
+    }
+  return yycount;
+}
+
+/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
+   about the unexpected token YYTOKEN for the state stack whose top is
+   YYSSP.
+
+   Return 0 if *YYMSG was successfully written.  Return -1 if *YYMSG is
+   not large enough to hold the message.  In that case, also set
+   *YYMSG_ALLOC to the required number of bytes.  Return YYENOMEM if the
+   required number of bytes is too large to store.  */
+static int
+yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
+                const yypcontext_t *yyctx)
+{
+  enum { YYARGS_MAX = 5 };
+  /* Internationalized format string. */
+  const char *yyformat = YY_NULLPTR;
+  /* Arguments of yyformat: reported tokens (one for the "unexpected",
+     one per "expected"). */
+  yysymbol_kind_t yyarg[YYARGS_MAX];
+  /* Cumulated lengths of YYARG.  */
+  YYPTRDIFF_T yysize = 0;
+
+  /* Actual size of YYARG. */
+  int yycount = yy_syntax_error_arguments (yyctx, yyarg, YYARGS_MAX);
+  if (yycount == YYENOMEM)
+    return YYENOMEM;
+
+  switch (yycount)
+    {
+#define YYCASE_(N, S)                       \
+      case N:                               \
+        yyformat = S;                       \
+        break
+    default: /* Avoid compiler warnings. */
+      YYCASE_(0, YY_("syntax error"));
+      YYCASE_(1, YY_("syntax error, unexpected %s"));
+      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
+      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
+      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
+      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
+#undef YYCASE_
+    }
+
+  /* Compute error message size.  Don't count the "%s"s, but reserve
+     room for the terminator.  */
+  yysize = yystrlen (yyformat) - 2 * yycount + 1;
+  {
+    int yyi;
+    for (yyi = 0; yyi < yycount; ++yyi)
+      {
+        YYPTRDIFF_T yysize1
+          = yysize + yytnamerr (YY_NULLPTR, yytname[yyarg[yyi]]);
+        if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
+          yysize = yysize1;
+        else
+          return YYENOMEM;
+      }
+  }
+
+  if (*yymsg_alloc < yysize)
+    {
+      *yymsg_alloc = 2 * yysize;
+      if (! (yysize <= *yymsg_alloc
+             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
+        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
+      return -1;
+    }
+
+  /* Avoid sprintf, as that infringes on the user's name space.
+     Don't have undefined behavior even if the translation
+     produced a string with the wrong number of "%s"s.  */
+  {
+    char *yyp = *yymsg;
+    int yyi = 0;
+    while ((*yyp = *yyformat) != '\0')
+      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
+        {
+          yyp += yytnamerr (yyp, yytname[yyarg[yyi++]]);
+          yyformat += 2;
+        }
+      else
+        {
+          ++yyp;
+          ++yyformat;
+        }
+  }
+  return 0;
+}
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp)
+{
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Location data for the lookahead symbol.  */
+YYLTYPE yylloc
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+  = { 1, 1, 1, 1 }
+# endif
+;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (void)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+    /* The location stack: array, bottom, top.  */
+    YYLTYPE yylsa[YYINITDEPTH];
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+  YYLTYPE yyloc;
+
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
+
+  /* Buffer for error messages, and its allocated size.  */
+  char yymsgbuf[128];
+  char *yymsg = yymsgbuf;
+  YYPTRDIFF_T yymsg_alloc = sizeof yymsgbuf;
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  yylsp[0] = yylloc;
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+        YYLTYPE *yyls1 = yyls;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+        yyls = yyls1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        YYSTACK_RELOCATE (yyls_alloc, yyls);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+      yylsp = yyls + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+  *++yylsp = yylloc;
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+  /* Default location. */
+  YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+  yyerror_range[1] = yyloc;
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 3: /* program: program line  */
+#line 106 "assembler.y"
+                                        { if (!g_lines) g_lines = (yyvsp[0].line); if (g_last_line) g_last_line->m_next = (yyvsp[0].line); g_last_line = (yyvsp[0].line); }
+#line 1619 "assembler.tab.c"
+    break;
+
+  case 4: /* line: labeldef '\n'  */
+#line 109 "assembler.y"
+                                        { (yyval.line) = get_line((yyvsp[-1].label), UINTPTR_MAX, NULL); }
+#line 1625 "assembler.tab.c"
+    break;
+
+  case 5: /* line: labeldef INST params '\n'  */
+#line 110 "assembler.y"
+                                        { (yyval.line) = get_line((yyvsp[-3].label), (yyvsp[-2].instruction), (yyvsp[-1].param)); }
+#line 1631 "assembler.tab.c"
+    break;
+
+  case 6: /* labeldef: %empty  */
+#line 113 "assembler.y"
+                                        { (yyval.label) = NULL; }
+#line 1637 "assembler.tab.c"
+    break;
+
+  case 7: /* labeldef: LABEL ':'  */
+#line 114 "assembler.y"
+                                        { (yyval.label) = get_label((yyvsp[-1].sval), NULL); g_last_label_defined = (yyval.label)->m_label; free((yyvsp[-1].sval)); }
+#line 1643 "assembler.tab.c"
+    break;
+
+  case 8: /* labeldef: '.' LABEL ':'  */
+#line 115 "assembler.y"
+                                        { (yyval.label) = get_label(g_last_label_defined, (yyvsp[-1].sval)); free((yyvsp[-1].sval)); }
+#line 1649 "assembler.tab.c"
+    break;
+
+  case 9: /* params: %empty  */
+#line 118 "assembler.y"
+                                        { (yyval.param) = NULL; }
+#line 1655 "assembler.tab.c"
+    break;
+
+  case 10: /* params: params1  */
+#line 119 "assembler.y"
+                                        { (yyval.param) = (yyvsp[0].param); }
+#line 1661 "assembler.tab.c"
+    break;
+
+  case 11: /* params1: param  */
+#line 122 "assembler.y"
+                                        { (yyval.param) = (yyvsp[0].param); }
+#line 1667 "assembler.tab.c"
+    break;
+
+  case 12: /* params1: params1 ',' param  */
+#line 123 "assembler.y"
+                                        { (yyval.param) = (yyvsp[-2].param); append_param((yyval.param), (yyvsp[0].param)); }
+#line 1673 "assembler.tab.c"
+    break;
+
+  case 13: /* param: INTEGER  */
+#line 126 "assembler.y"
+                                        { (yyval.param) = calloc(1, sizeof(*(yyval.param))); (yyval.param)->m_type = P_INTEGER; (yyval.param)->m_value.as_integer = (yyvsp[0].ival); }
+#line 1679 "assembler.tab.c"
+    break;
+
+  case 14: /* param: FLOAT  */
+#line 127 "assembler.y"
+                                        { (yyval.param) = calloc(1, sizeof(*(yyval.param))); (yyval.param)->m_type = P_FLOAT; (yyval.param)->m_value.as_float = (yyvsp[0].fval); }
+#line 1685 "assembler.tab.c"
+    break;
+
+  case 15: /* param: STRING  */
+#line 128 "assembler.y"
+                                        { (yyval.param) = calloc(1, sizeof(*(yyval.param))); (yyval.param)->m_type = P_STRING; (yyval.param)->m_value.as_string = (yyvsp[0].sval); }
+#line 1691 "assembler.tab.c"
+    break;
+
+  case 16: /* param: '&' label  */
+#line 129 "assembler.y"
+                                        { (yyval.param) = calloc(1, sizeof(*(yyval.param))); (yyval.param)->m_type = P_LABEL_LOC; (yyval.param)->m_value.as_label = (yyvsp[0].label); }
+#line 1697 "assembler.tab.c"
+    break;
+
+  case 17: /* param: '~' label  */
+#line 130 "assembler.y"
+                                        { (yyval.param) = calloc(1, sizeof(*(yyval.param))); (yyval.param)->m_type = P_LABEL_OFF; (yyval.param)->m_value.as_label = (yyvsp[0].label); }
+#line 1703 "assembler.tab.c"
+    break;
+
+  case 18: /* label: LABEL '.' LABEL  */
+#line 133 "assembler.y"
+                                        { (yyval.label) = get_label((yyvsp[-2].sval), (yyvsp[0].sval)); free((yyvsp[-2].sval)); free((yyvsp[0].sval)); }
+#line 1709 "assembler.tab.c"
+    break;
+
+  case 19: /* label: '.' LABEL  */
+#line 134 "assembler.y"
+                                        { (yyval.label) = get_label(g_last_label_defined, (yyvsp[0].sval)); free((yyvsp[0].sval)); }
+#line 1715 "assembler.tab.c"
+    break;
+
+  case 20: /* label: LABEL  */
+#line 135 "assembler.y"
+                                        { (yyval.label) = get_label((yyvsp[0].sval), NULL); free((yyvsp[0].sval)); }
+#line 1721 "assembler.tab.c"
+    break;
+
+
+#line 1725 "assembler.tab.c"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+  *++yylsp = yyloc;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      {
+        yypcontext_t yyctx
+          = {yyssp, yytoken, &yylloc};
+        char const *yymsgp = YY_("syntax error");
+        int yysyntax_error_status;
+        yysyntax_error_status = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+        if (yysyntax_error_status == 0)
+          yymsgp = yymsg;
+        else if (yysyntax_error_status == -1)
+          {
+            if (yymsg != yymsgbuf)
+              YYSTACK_FREE (yymsg);
+            yymsg = YY_CAST (char *,
+                             YYSTACK_ALLOC (YY_CAST (YYSIZE_T, yymsg_alloc)));
+            if (yymsg)
+              {
+                yysyntax_error_status
+                  = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+                yymsgp = yymsg;
+              }
+            else
+              {
+                yymsg = yymsgbuf;
+                yymsg_alloc = sizeof yymsgbuf;
+                yysyntax_error_status = YYENOMEM;
+              }
+          }
+        yyerror (yymsgp);
+        if (yysyntax_error_status == YYENOMEM)
+          YYNOMEM;
+      }
+    }
+
+  yyerror_range[1] = yylloc;
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, &yylloc);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+      yyerror_range[1] = *yylsp;
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  yyerror_range[2] = yylloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, &yylloc);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+  if (yymsg != yymsgbuf)
+    YYSTACK_FREE (yymsg);
+  return yyresult;
+}
+
+#line 138 "assembler.y"
+
+
+static void append_param(param_t *list, param_t *param) {
+    param_t *p = list;
+    while (p && p->m_next != NULL) {
+        p = p->m_next;
+    }
+    p->m_next = param;
+}
+
+static line_t *get_line(label_t *label, uintptr_t instruction, param_t *params) {
+    line_t *line = calloc(1, sizeof(*line));
+    
+    line->m_label = label;
+    line->m_instruction = instruction;
+    line->m_params = params;
+    line->m_position = UINTPTR_MAX;
+    line->m_length = UINTPTR_MAX;
+    return line;
+}
+
+static label_t *get_label(const char *prim, const char *sub) {
+    label_t *label = g_labels;
+    char *key;
+    size_t keylen = 0;
+
+    if (prim)   keylen += strlen(prim);
+    if (sub)    keylen += 1 + strlen(sub);
+
+    if (keylen == 0)  return NULL;
+
+    key = calloc(1, ++keylen);
+
+    if (prim) {
+        strcat(key, prim);
+    }
+    
+    if (sub) {
+        strcat(key, ".");
+        strcat(key, sub);
+    }
+        
+    while (label != NULL) {
+        if (0 == strcmp(label->m_label, key)) {
+            free(key);
+            return label;
+        }
+        label = label->m_next;
+    }
+    
+    label = calloc(1, sizeof(*label));
+    label->m_label = key;
+
+    if (!g_labels)  g_labels = label;
+    if (g_last_label)  g_last_label->m_next = label;
+    g_last_label = label;
+
+    // n.b. don't free key, as the label now owns it
+    return label;
+}
+
+assembler_output_t *assemble(const char *filename) {
+    int status;
+    line_t *line;
+    label_t *label;
+
+    if (filename != NULL) {
+        g_input = fopen(filename, "r");
+    }
+    else {
+        g_input = stdin;
+    }
+    
+    if (g_input != NULL) {
+        flockfile(g_input);
+        status = yyparse();
+        clearerr_unlocked(g_input);
+        funlockfile(g_input);
+        if (g_input != stdin)  fclose(g_input);        
+        g_input = NULL;
+    }
+    else {
+        status = errno;
+        perror(filename);
+    }
+    
+    if (status != 0)  return NULL;
+
+    // walk the parse tree (g_lines, g_labels) and resolve all the lengths and positions
+    line = g_lines;
+    uintptr_t next_position = 1;    // compile the first instruction to location 1
+    while (line != NULL) {
+        if (line->m_instruction == UINTPTR_MAX) {
+            // this line hasn't got an instruction (i.e. it's just a floating label)
+            line->m_length = 0;
+        }
+        else if (line->m_instruction == i_STR || line->m_instruction == i_STRING) {
+            // special case length for string literals -- need to include the length of the string itself
+            line->m_length = instruction_sizes[line->m_instruction];
+            if (line->m_params != NULL && line->m_params->m_type == P_STRING) {
+                line->m_length += strlen(line->m_params->m_value.as_string);
+            }
+        }
+        else {
+            line->m_length = instruction_sizes[line->m_instruction];
+        }
+
+        line->m_position = next_position;
+        if (line->m_length > 2 && line->m_instruction != i_STR) {
+            // complex instructions should have their position aligned one byte before a four byte boundary
+            while (line->m_position % 4 < 3)  line->m_position++;
+        }
+        
+        if (line->m_label != NULL) {
+            if (line->m_label->m_line == NULL) {
+                line->m_label->m_line = line;
+            }
+            else if (line->m_label->m_line == line) {
+                ;
+            }
+            else {
+                debug("multiple definitions of label %s\n", line->m_label->m_label);
+                status = -1;
+            }
+        }
+    
+        next_position = line->m_position + line->m_length;
+        line = line->m_next;
+    }
+    
+    label = g_labels;
+    while (label != NULL) {
+        if (label->m_line == NULL) {
+            debug("label '%s' is used but never defined\n", label->m_label);
+            status = -1;
+        }
+        label = label->m_next;
+    }
+    
+    // allocate space for the output and initialise values
+    size_t len = g_last_line->m_position + g_last_line->m_length + 1;
+    assembler_output_t *output = malloc(sizeof(*output) + len);
+    output->m_bytecode_length = len;
+    output->m_bytecode_start = 1;   // first instruction is at location 1 by default
+    memset(output->m_bytecode, i_NOOP, len - 1);
+    output->m_bytecode[0] = i_END;          // guard values
+    output->m_bytecode[len - 1] = i_END;    // guard values
+
+    // reduce each line to bytecode and inject it at the right position
+    line = g_lines;
+    while (status == 0 && line != NULL) {
+        if (line->m_length == 0) {
+            line = line->m_next;
+            continue;   
+        }
+        
+        output->m_bytecode[line->m_position] = (uint8_t) line->m_instruction;
+        if (line->m_length > 1) {
+            switch (line->m_instruction) {
+                case i_BYTE:
+                case i_OPEN:
+                    if (line->m_params != NULL && line->m_params->m_type == P_INTEGER) {
+                        uint8_t i = (uint8_t) line->m_params->m_value.as_integer;
+                        output->m_bytecode[line->m_position + 1] = i;
+                    }
+                    else {
+                        debug("instruction '%s' requires an integer parameter\n", instruction_names[line->m_instruction]);
+                        status = -1;
+                    }
+                    break;
+                
+                case i_CALL:
+                case i_CORO:
+                case i_FUNLIT:
+                    if (line->m_params != NULL && line->m_params->m_type == P_LABEL_LOC) {
+                        function_handle_t handle = line->m_params->m_value.as_label->m_line->m_position;
+                        * (function_handle_t *) &(output->m_bytecode[line->m_position + 1]) = handle;
+                    }
+                    else {
+                        debug("instruction '%s' requires a label location parameter\n", instruction_names[line->m_instruction]);
+                        status = -1;
+                    }
+                    break;
+                
+                case i_INT:
+                    if (line->m_params != NULL && line->m_params->m_type == P_INTEGER) {
+                        intptr_t i = line->m_params->m_value.as_integer;
+                        * (intptr_t *) &(output->m_bytecode[line->m_position + 1]) = i;
+                    }
+                    else {
+                        debug("instruction '%s' requires an integer parameter\n", instruction_names[line->m_instruction]);
+                        status = -1;
+                    }
+                    break;
+
+                case i_FLOAT:
+                    if (line->m_params != NULL && line->m_params->m_type == P_FLOAT) {
+                        floatptr_t f = line->m_params->m_value.as_float;
+                        * (floatptr_t *) &(output->m_bytecode[line->m_position + 1]) = f;
+                    }
+                    else {
+                        debug("instruction '%s' requires a float parameter\n", instruction_names[line->m_instruction]);
+                        status = -1;
+                    }
+                    break;
+
+                case i_STR:
+                    if (line->m_params != NULL && line->m_params->m_type == P_STRING) {
+                        uint8_t length = line->m_length - instruction_sizes[i_STR];
+                        * (uint8_t *) &(output->m_bytecode[line->m_position + 1]) = length;
+                        memcpy(&(output->m_bytecode[line->m_position + instruction_sizes[i_STR]]), line->m_params->m_value.as_string, length);
+                    }
+                    else {
+                        debug("instruction '%s' requires a string parameter\n", instruction_names[line->m_instruction]);
+                        status = -1;
+                    }
+                    break;
+
+                case i_STRING:
+                    if (line->m_params != NULL && line->m_params->m_type == P_STRING) {
+                        uint32_t length = line->m_length - instruction_sizes[i_STRING];
+                        * (uint32_t *) &(output->m_bytecode[line->m_position + 1]) = length;
+                        memcpy(&(output->m_bytecode[line->m_position + instruction_sizes[i_STRING]]), line->m_params->m_value.as_string, length);
+                    }
+                    else {
+                        debug("instruction '%s' requires a string parameter\n", instruction_names[line->m_instruction]);
+                        status = -1;
+                    }
+                    break;
+
+                case i_JMP:
+                case i_JMP0:
+                case i_JMPU:
+                    if (line->m_params != NULL && line->m_params->m_type == P_LABEL_OFF) {
+                        intptr_t offset = line->m_params->m_value.as_label->m_line->m_position - line->m_position;
+                        * (intptr_t *) &(output->m_bytecode[line->m_position + 1]) = offset;
+                    }
+                    else {
+                        debug("instruction '%s' requires a label offset parameter\n", instruction_names[line->m_instruction]);
+                        status = -1;
+                    }
+                    break;
+
+                case i_SYMDEF:
+                    if (line->m_params != NULL && line->m_params->m_type == P_INTEGER) {
+                        flags32_t flags = (flags32_t) line->m_params->m_value.as_integer;
+                        if (line->m_params->m_next != NULL && line->m_params->m_next->m_type == P_INTEGER) {
+                            identifier_t identifier = (identifier_t) line->m_params->m_next->m_value.as_integer;
+                            * (flags32_t *) &(output->m_bytecode[line->m_position + 1]) = flags;
+                            * (identifier_t *) &(output->m_bytecode[line->m_position + 1 + sizeof(flags)]) = identifier;
+                        }
+                        else {
+                            debug("instruction '%s' requires integer flags and integer identifier parameters\n", instruction_names[i_SYMDEF]);
+                            status = -1;
+                        }                        
+                    }
+                    else {
+                        debug("instruction '%s' requires integer flags and integer identifier parameters\n", instruction_names[i_SYMDEF]);
+                        status = -1;
+                    }
+                    break;
+                    
+                case i_SYMFIND:
+                case i_SYMCLONE:
+                case i_SYMUNDEF:
+                    if (line->m_params != NULL && line->m_params->m_type == P_INTEGER) {
+                        identifier_t identifier = (identifier_t) line->m_params->m_value.as_integer;
+                        * (identifier_t *) &(output->m_bytecode[line->m_position + 1]) = identifier;
+                    }
+                    else {
+                        debug("instruction '%s' requires an integer identifier parameter\n", instruction_names[line->m_instruction]);
+                        status = -1;
+                    }
+                    break;
+
+                default:
+                    debug("unhandled multibyte instruction: %s\n", instruction_names[line->m_instruction]);
+                    break;
+            }
+        }
+        else {
+            if (line->m_params != NULL) {
+                debug("unused parameters being ignored by instruction %s\n", instruction_names[line->m_instruction]);
+            }
+        }
+        line = line->m_next;
+    }    
+    
+    // if there was a main label defined, make it the start point
+    label = get_label("main", NULL);
+    if (status == 0 && label != NULL && label->m_line != NULL) {
+        output->m_bytecode_start = label->m_line->m_position;
+    }
+    
+    // clean up the parse tree
+    line = g_lines;
+    while (line != NULL) {
+        param_t *param = line->m_params;
+        while (param != NULL) {
+            if (param->m_type == P_STRING)  free(param->m_value.as_string);
+            param_t *tmp = param;
+            param = param->m_next;
+            free(tmp);
+        }
+
+        line_t *tmp = line;
+        line = line->m_next;
+        free (tmp);
+    }
+    g_lines = g_last_line = NULL;
+    
+    label = g_labels;
+    while (label != NULL) {
+        free(label->m_label);
+        label_t *tmp = label;
+        label = label->m_next;
+        free(tmp);
+    }
+    g_labels = g_last_label = NULL;
+            
+    if (status != 0) {
+        free(output);
+        return NULL;
+    }
+    
+    return output;
+}
+
+static void ass_error(char const *s) {
+    printf("line %i column %i - %s\n", yylloc.first_line, yylloc.first_column, s);
+}
+
+#ifndef digittoint
+#define digittoint(c) ((c) - '0')
+#endif
+
+static inline int peek(void) {
+    return peekc_unlocked(g_input);
+}
+
+static inline int next(void) {
+    int c = getc_unlocked(g_input);
+    ++yylloc.last_column;
+    return c;
+}
+
+static int ass_lex(void) {
+    int c;
+    
+    // skip over whitespace
+    do {
+        c = next();
+    } while (c == ' ' || c == '\t');
+    
+    // update location
+    yylloc.first_line = yylloc.last_line;
+    yylloc.first_column = yylloc.last_column;
+    
+    // bail out at end of file
+    if (c == EOF)  return EOF;
+
+    if (c == '0' && peek() != '.') {
+        // parse a literal integer in either hex or octal
+        if (peek() == 'x') {
+            c = next();
+            yylval.ival = read_hex_value();
+            return INTEGER;
+        }
+        else {
+            yylval.ival = read_octal_value();
+            return INTEGER;
+        }
+    }
+
+    if (isdigit(c)) {
+        // parse a literal number - either int or float
+        intptr_t i = digittoint(c);
+        
+        while (isdigit(peek())) {
+            c = next();
+            i = 10 * i + digittoint(c);
+        }
+        
+        if (peek() == '.') {
+            floatptr_t f = i, div = 10.0;
+            
+            next();  // consume the '.'
+            while (isdigit(peek())) {
+                c = next();
+                f += digittoint(c) / div;
+                div *= 10.0;
+            }
+            
+            yylval.fval = f;
+            return FLOAT;
+        }
+        else {
+            yylval.ival = i;
+            return INTEGER;
+        }
+    }
+    
+    if (isalpha(c)) {
+        // parse a string -- either an instruction or an identifier
+        ungetc(c, g_input);
+        --yylloc.last_column;
+        char *str = read_identifier();
+
+        // n.b. quickened instructions are internal to the vm, so they aren't accepted here
+        for (size_t i = 0; i < i__QUICK_MIN; i++) {
+            if (0 == strcmp(str, instruction_names[i])) {
+                free(str);
+                yylval.instruction = i;
+                return INST;
+            }
+        }
+        
+        yylval.sval = str;
+        return LABEL;
+    }
+    
+    if (c == '"') {
+        // read a literal string
+        char *str = read_quoted('"');
+        
+        yylval.sval = str;
+        return STRING;
+    }
+    
+    if (c == '\'') {
+        // read a single-quoted character
+        char *str = read_quoted('\'');
+        if (str) {
+            yylval.ival = str[0];
+            if (strlen(str) > 1)  fprintf(stderr, "Ignoring extra characters in character literal: %s\n", str + 1);
+            free(str);
+        }
+        return INTEGER;
+    }
+    
+    if (c == ';' || c == '#') {
+        // comment - discard until eol
+        do {
+            c = next();
+        } while (c != EOF && c != '\n');
+        return c;
+    }
+    
+    if (c == '\n') {
+        ++yylloc.last_line;
+        yylloc.last_column = 0;
+    }
+
+    // by default just return the character read
+    return c;
+}
+
+char *read_identifier(void) {
+    int c;
+    size_t i = 0, buflen = 64;
+    char *buffer = calloc(1, buflen);
+    
+    while ((c = peek()) && (c == '_' || isalnum(c))) {
+        if (buflen - i < 2) {
+            buflen *= 2;
+            char *tmp = calloc(1, buflen);
+            memcpy(tmp, buffer, i);
+            free(buffer);
+            buffer = tmp;
+        }
+        c = next();
+        buffer[i++] = c;
+    }
+    
+    return buffer;
+}
+
+static char *read_quoted(int delimiter) {
+    int c, found_closing_delim = 0;
+    size_t i = 0, buflen = 64;
+    char *buffer = calloc(1, buflen);
+    
+    while (!found_closing_delim) {
+        if (buflen - i <= 2) {
+            buflen *= 2;
+            char *tmp = calloc(1, buflen);
+            memcpy(tmp, buffer, i);
+            free(buffer);
+            buffer = tmp;
+        }
+        switch ((c = next())) {
+            case '\\':
+                switch (peek()) {
+                    case '\\':  next(); buffer[i++] = '\\'; break;
+                    case '\'':  next(); buffer[i++] = '\''; break;
+                    case '"':   next(); buffer[i++] = '"';  break;
+                    case 'a':   next(); buffer[i++] = '\a'; break;
+                    case 'b':   next(); buffer[i++] = '\b'; break;
+                    case 'f':   next(); buffer[i++] = '\f'; break;
+                    case 'n':   next(); buffer[i++] = '\n'; break;
+                    case 'r':   next(); buffer[i++] = '\r'; break;
+                    case 't':   next(); buffer[i++] = '\t'; break;
+                    case 'v':   next(); buffer[i++] = '\v'; break;
+                        
+                    case 'x':
+                        next();
+                        buffer[i++] = read_hex_byte();
+                        break;
+                        
+                    case '0':
+                    case '1':
+                    case '2':
+                    case '3':
+                        buffer[i++] = read_octal_byte();
+                        break;
+                        
+                    default:  // unrecognised escape sequence, ignore the backslash
+                        buffer[i++] = next();
+                }
+                break;
+                
+            case EOF:
+            case '\n':
+                buffer[i] = '\0';
+                fprintf(stderr, "Unterminated quoted string\n");
+                free(buffer);
+                return NULL;
+                
+            default:
+                if (c == delimiter) {
+                    found_closing_delim = 1;
+                }
+                else {
+                    buffer[i++] = c;
+                }
+                break;
+        }
+    }
+
+    return buffer;
+}
+
+static int read_hex_byte(void) {
+    int i = 0, val;
+    char digits[3], *endptr=NULL;
+    
+    memset(digits, 0, sizeof(digits));
+    while (i < 2 && isxdigit(peek())) {
+        digits[i++] = (char) next();
+    }
+    
+    val = strtol(digits, &endptr, 16);
+    if (endptr != NULL && *endptr != '\0') {
+        fprintf(stderr, "warning: invalid characters in hex byte '\\x%s'\n", digits);
+    }
+    return (char) val;
+}
+
+static int read_octal_byte(void) {
+    int i = 0, val;
+    char digits[4], *endptr=NULL;
+    
+    memset(digits, 0, sizeof(digits));
+    while (i < 3 && isdigit(peek())) {
+        digits[i++] = (char) next();
+    }
+    
+    val = strtol(digits, &endptr, 8);
+    if (endptr != NULL && *endptr != '\0') {
+        fprintf(stderr, "warning: invalid characters in octal byte '\\%s'\n", digits);
+    }
+    if (val > 0xFF) {
+        fprintf(stderr, "warning: octal byte value out of range '\\%s'\n", digits);
+    }
+    return (char) val;
+}
+
+static int read_hex_value(void) {
+    int i = 0, val;
+    char digits[64], *endptr=NULL;
+    
+    memset(digits, 0, sizeof(digits));
+    while(i < sizeof(digits) - 1 && isxdigit(peek())) {
+        digits[i++] = (char) next();
+    }
+    
+    val = strtol(digits, &endptr, 16);
+    if (endptr != NULL && *endptr != '\0') {
+        fprintf(stderr, "warning: invalid characters in hex value '0x%s'\n", digits);
+    }
+    
+    return val;
+}
+
+static int read_octal_value(void) {
+    int i = 0, val;
+    char digits[64], *endptr=NULL;
+    
+    memset(digits, 0, sizeof(digits));
+    while(i < sizeof(digits) - 1 && isdigit(peek())) {
+        digits[i++] = (char) next();
+    }
+    
+    val = strtol(digits, &endptr, 8);
+    if (endptr != NULL && *endptr != '\0') {
+        fprintf(stderr, "warning: invalid characters in octal value '0%s'\n", digits);
+    }
+    
+    return val;
+}
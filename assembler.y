@@ -398,6 +398,7 @@ assembler_output_t *assemble(const char *filename) {
                     break;
                     
                 case i_SYMFIND:
+                case i_SYMCLONE:
                 case i_SYMUNDEF:
                     if (line->m_params != NULL && line->m_params->m_type == P_INTEGER) {
                         identifier_t identifier = (identifier_t) line->m_params->m_value.as_integer;
@@ -542,7 +543,8 @@ static int ass_lex(void) {
         --yylloc.last_column;
         char *str = read_identifier();
 
-        for (size_t i = 0; i < i__MAX; i++) {
+        // n.b. quickened instructions are internal to the vm, so they aren't accepted here
+        for (size_t i = 0; i < i__QUICK_MIN; i++) {
             if (0 == strcmp(str, instruction_names[i])) {
                 free(str);
                 yylval.instruction = i;
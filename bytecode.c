@@ -21,6 +21,7 @@ bytecode
  */
 
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
 #include <inttypes.h>
 #include <math.h>
@@ -31,36 +32,90 @@ bytecode
 #include "channel.h"
 #include "debug.h"
 #include "hash.h"
+#include "program.h"
 #include "scalar.h"
+#include "search.h"
 #include "stream.h"
 #include "util.h"
 #include "vm.h"
 
+static void _bytecode_call(vm_context_t *, const op_t *, const op_t *);
+static int _bytecode_frame_unseen(const symboltable_t *, const op_t *);
+static void _bytecode_rewrite(const op_t *, instruction_t);
+static const op_t *_bytecode_deoptimise(vm_context_t *, const op_t *, instruction_t);
+static int _bytecode_split_field(scalar_t **, size_t *, size_t *, const scalar_t *, size_t, size_t);
+
 #include "bytecode.h"
 
-#define NEXT_BYTE(x) (const uint8_t*)(&(x)->m_bytecode[(x)->m_counter + 1])
+#if defined(__GNUC__) && !defined(BYTECODE_SWITCH_DISPATCH)
+#define BYTECODE_THREADED_DISPATCH
+#endif
+
+#if defined(BYTECODE_THREADED_DISPATCH) && !defined(BYTECODE_NO_TOS_CACHE)
+#define BYTECODE_TOS_CACHE
+#endif
+
+#ifdef BYTECODE_TOS_CACHE
+static void _bytecode_tos_spill(vm_context_t *, size_t, intptr_t, intptr_t);
+#endif
+
+#define BYTECODE_SIGNAL_CHECK(x, op) do {                                           \
+    if (atomic_load_explicit(&(x)->m_signal_pending, memory_order_relaxed)) {       \
+        (x)->m_counter = (op);                                                      \
+        vm_poll_signals(x);                                                         \
+        (op) = (x)->m_counter;                                                      \
+    }                                                                               \
+} while (0)
 
 #define BYTECODE_NUMERIC_OP(type, op) do {                                          \
     scalar_t a = {0}, b = {0}, c = {0};                                             \
-    vm_ds_pop(context, &b);                                                         \
-    vm_ds_pop(context, &a);                                                         \
+    vm_ds_take(context, &b);                                                         \
+    vm_ds_take(context, &a);                                                         \
     anon_scalar_set_##type##_value(&c,                                              \
         anon_scalar_get_##type##_value(&a) op anon_scalar_get_##type##_value(&b));  \
-    vm_ds_push(context, &c);                                                        \
-    anon_scalar_destroy(&c);                                                        \
+    vm_ds_give(context, &c);                                                        \
     anon_scalar_destroy(&b);                                                        \
     anon_scalar_destroy(&a);                                                        \
 } while (0)
 
 
+#define BYTECODE_DS_COUNT(x)        ((x)->m_data_stack.m_count)
+#define BYTECODE_DS_ITEM(x, n)      ((x)->m_data_stack.m_items[(x)->m_data_stack.m_count - 1 - (n)])
+#define BYTECODE_DS_IS_INT(x, n)    (BYTECODE_DS_COUNT(x) > (n) && anon_scalar_is_int(&BYTECODE_DS_ITEM(x, n)))
+
+/* relaxed is enough: both forms of a quickened instruction are correct wherever they run */
+#define BYTECODE_OP_HANDLER(op)     atomic_load_explicit(&(op)->m_handler, memory_order_relaxed)
+#define BYTECODE_OP_INSTRUCTION(op) atomic_load_explicit(&(op)->m_instruction, memory_order_relaxed)
+#define BYTECODE_OP_FLAGS(op)       atomic_load_explicit(&(op)->m_flags, memory_order_relaxed)
+
+#define BYTECODE_QUICKEN(op, guard, quick) do {                                     \
+    if (!(BYTECODE_OP_FLAGS(op) & OP_FLAG_NO_QUICKEN) && (guard))                   \
+        _bytecode_rewrite((op), (quick));                                           \
+} while (0)
+
+#define BYTECODE_INT_GUARD(count, generic) do {                                     \
+    for (size_t i = 0; i < (count); i++) {                                          \
+        if (!BYTECODE_DS_IS_INT(context, i))                                        \
+            return _bytecode_deoptimise(context, op, (generic));                    \
+    }                                                                               \
+} while (0)
+
+#define BYTECODE_INT_INT_OP(generic, oper) do {                                     \
+    BYTECODE_INT_GUARD(2, generic);                                                 \
+    anon_scalar_put_int(&BYTECODE_DS_ITEM(context, 1),                              \
+        anon_scalar_int(&BYTECODE_DS_ITEM(context, 1))                              \
+        oper anon_scalar_int(&BYTECODE_DS_ITEM(context, 0)));                       \
+    anon_scalar_init(&BYTECODE_DS_ITEM(context, 0));                                \
+    --BYTECODE_DS_COUNT(context);                                                   \
+} while (0)
+
 #define BYTECODE_LOGICAL_OP(op) do {                                                \
     scalar_t a = {0}, b = {0}, c = {0};                                             \
-    vm_ds_pop(context, &b);                                                         \
-    vm_ds_pop(context, &a);                                                         \
+    vm_ds_take(context, &b);                                                         \
+    vm_ds_take(context, &a);                                                         \
     anon_scalar_set_int_value(&c,                                                   \
         (anon_scalar_get_bool_value(&a) op anon_scalar_get_bool_value(&b)));        \
-    vm_ds_push(context, &c);                                                        \
-    anon_scalar_destroy(&c);                                                        \
+    vm_ds_give(context, &c);                                                        \
     anon_scalar_destroy(&b);                                                        \
     anon_scalar_destroy(&a);                                                        \
 } while (0)
@@ -72,10 +127,9 @@ Terminates execution of the current context (causing vm_execute to return).
  
 =cut
  */
-int inst_END(vm_context_t *context) {
-    // dummy function for lookup table -- should not be executed!
-    assert("should not get here" == 0);
-    return 0;
+const op_t *inst_END(vm_context_t *context, const op_t *op) {
+    // no next op tells bytecode_execute() to stop
+    return NULL;
 }
 
 /*
@@ -85,10 +139,8 @@ Does nothing.  Used to pad the bytecode when alignment is important.
 
 =cut
  */
-int inst_NOOP(vm_context_t *context) {
-    // dummy function for lookup table -- should not be executed!
-    assert("should not get here" == 0);
-    return 0;
+const op_t *inst_NOOP(vm_context_t *context, const op_t *op) {
+    return op + 1;
 }
 
 /*
@@ -96,20 +148,15 @@ int inst_NOOP(vm_context_t *context) {
 
 Reads a jump destination from the following bytecode.  Pushes the location of the bytecode following the jump destination
 to the return stack, starts a new symbol table scope, then transfers execution control to the jump destination.
+
+A CALL immediately followed by RETURN is a tail call, which doesn't push to the return stack (see _bytecode_call()).
  
 =cut
  */
-int inst_CALL(vm_context_t *context) {
-    const function_handle_t jump_dest = *(const function_handle_t *) NEXT_BYTE(context);
-    
-    vm_state_t ret_state = {0};
-    vm_state_init(&ret_state, context->m_counter + 1 + sizeof(function_handle_t), context->m_flags, context->m_symboltable);
-    vm_rs_push(context, &ret_state);
-    vm_state_destroy(&ret_state);
-
-    vm_start_scope(context);
+const op_t *inst_CALL(vm_context_t *context, const op_t *op) {
+    _bytecode_call(context, op, op->m_target);
     
-    return jump_dest - context->m_counter;
+    return op->m_target;
 }
 
 /*
@@ -122,17 +169,16 @@ Pops n and n parameters from the caller's stack and pushes them in the same orde
 
 =cut
  */
-int inst_CORO(struct vm_context_t *context) {
-    const function_handle_t jump_dest = *(const function_handle_t *) NEXT_BYTE(context);
+const op_t *inst_CORO(vm_context_t *context, const op_t *op) {
     scalar_t *params = NULL;
     uintptr_t num_params = 0;
     
     scalar_t n = {0};
-    vm_ds_pop(context, &n);    
+    vm_ds_take(context, &n);    
     if (anon_scalar_get_int_value(&n) > 0) {
         num_params = anon_scalar_get_int_value(&n);
         if (NULL != (params = calloc(num_params, sizeof(*params)))) {
-            vm_ds_npop(context, num_params, params);
+            vm_ds_ntake(context, num_params, params);
         }
         else {
             debug("couldn't allocate space for %"PRIuPTR" parameters to coro\n", num_params);
@@ -143,13 +189,10 @@ int inst_CORO(struct vm_context_t *context) {
     
     vm_context_t *child_context;
     if (NULL != (child_context = calloc(1, sizeof(*child_context)))) {
-        vm_context_init(child_context, context->m_bytecode, context->m_bytecode_length, jump_dest);
+        vm_context_init(child_context, context->m_program, op->m_target);
         
         if (params != NULL) {
-            vm_ds_npush(child_context, num_params, params);
-            for (uintptr_t i = 0; i < num_params; i++) {
-                anon_scalar_destroy(&params[i]);
-            }
+            vm_ds_ngive(child_context, num_params, params);
             free(params);
             params = NULL;
         }
@@ -171,7 +214,7 @@ int inst_CORO(struct vm_context_t *context) {
         FIXME("what to do here?\n");
     }
     
-    return 1 + sizeof(jump_dest);
+    return op + 1;
 }
 
 /*
@@ -181,9 +224,9 @@ Ends the current symbol table scope.  Pops a return destination from the return
 
 =cut
  */
-int inst_RETURN(vm_context_t *context) {
+const op_t *inst_RETURN(vm_context_t *context, const op_t *op) {
     vm_state_t ret_state = {0};
-    function_handle_t jump_dest;
+    const op_t *jump_dest;
     symboltable_t *symboltable_top;
 
     vm_rs_pop(context, &ret_state);
@@ -196,7 +239,7 @@ int inst_RETURN(vm_context_t *context) {
         vm_end_scope(context);
     }
     
-    return jump_dest - context->m_counter;
+    return jump_dest;
 }
 
 /*
@@ -206,9 +249,9 @@ Drops an item from the data stack
  
 =cut
  */
-int inst_DROP(vm_context_t *context) {
+const op_t *inst_DROP(vm_context_t *context, const op_t *op) {
     vm_ds_pop(context, NULL);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -218,9 +261,9 @@ Swaps the two items at the top of the data stack
 
 =cut
  */
-int inst_SWAP(vm_context_t *context) {
+const op_t *inst_SWAP(vm_context_t *context, const op_t *op) {
     vm_ds_swap(context);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -230,9 +273,9 @@ Duplicates the item on the top of the data stack
  
 =cut
  */
-int inst_DUP(vm_context_t *context) {
+const op_t *inst_DUP(vm_context_t *context, const op_t *op) {
     vm_ds_dup(context);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -242,9 +285,9 @@ Duplicates the next from top item on the data stack
 
 =cut
  */
-int inst_OVER(vm_context_t *context) {
+const op_t *inst_OVER(vm_context_t *context, const op_t *op) {
     vm_ds_over(context);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -254,33 +297,23 @@ Rotates n items on the stack such that the top item is moved to the bottom.
 
 =cut
 */
-int inst_ROT(struct vm_context_t *context) {
-    scalar_t count = {0}, top = {0}, *items = NULL;
+const op_t *inst_ROT(vm_context_t *context, const op_t *op) {
+    scalar_t count = {0}, top = {0};
     
-    vm_ds_pop(context, &count);
+    vm_ds_take(context, &count);
     size_t n = anon_scalar_get_int_value(&count);
     
     if (n > 1) {
-        if (NULL != (items = calloc(n - 1, sizeof(*items)))) {
-            vm_ds_pop(context, &top);
-            vm_ds_npop(context, n - 1, items);
+        scalar_t *items = vm_ds_peek(context, n - 1);
 
-            vm_ds_push(context, &top);
-            vm_ds_npush(context, n - 1, items);
-
-            anon_scalar_destroy(&top);
-        
-            for (size_t i = 0; i < n - 1; i++)  anon_scalar_destroy(&items[i]);
-            free(items);
-        }
-        else {
-            debug("calloc failed\n");
-        }
+        memcpy(&top, &items[n - 1], sizeof(top));
+        memmove(&items[1], &items[0], (n - 1) * sizeof(items[0]));
+        memcpy(&items[0], &top, sizeof(top));
     }
     
     anon_scalar_destroy(&count);
 
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -290,33 +323,23 @@ Rotates n items on the stack such that the bottom is moved to the top.
 
 =cut
 */
-int inst_TOR(struct vm_context_t *context) {
-    scalar_t count = {0}, bottom = {0}, *items = NULL;
+const op_t *inst_TOR(vm_context_t *context, const op_t *op) {
+    scalar_t count = {0}, bottom = {0};
     
-    vm_ds_pop(context, &count);
+    vm_ds_take(context, &count);
     size_t n = anon_scalar_get_int_value(&count);
     
     if (n > 1) {
-        if (NULL != (items = calloc(n - 1, sizeof(*items)))) {
-            vm_ds_npop(context, n - 1, items);
-            vm_ds_pop(context, &bottom);
-            
-            vm_ds_npush(context, n - 1, items);
-            vm_ds_push(context, &bottom);
-            
-            anon_scalar_destroy(&bottom);
-        
-            for (size_t i = 0; i < n - 1; i++)  anon_scalar_destroy(&items[i]);
-            free(items);
-        }
-        else {
-            debug("calloc failed\n");
-        }
+        scalar_t *items = vm_ds_peek(context, n - 1);
+
+        memcpy(&bottom, &items[0], sizeof(bottom));
+        memmove(&items[0], &items[1], (n - 1) * sizeof(items[0]));
+        memcpy(&items[n - 1], &bottom, sizeof(bottom));
     }
     
     anon_scalar_destroy(&count);
-    
-    return 1;
+
+    return op + 1;
 }
 
 /*
@@ -326,9 +349,9 @@ Pops two values from the stack, and pushes back the result of a logical and of t
 
 =cut
  */
-int inst_AND(struct vm_context_t *context) {
+const op_t *inst_AND(vm_context_t *context, const op_t *op) {
     BYTECODE_LOGICAL_OP(&&);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -338,9 +361,9 @@ Pops two values from the stack, and pushes back the result of a logical or of th
 
 =cut
  */
-int inst_OR(struct vm_context_t *context) {
+const op_t *inst_OR(vm_context_t *context, const op_t *op) {
     BYTECODE_LOGICAL_OP(||);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -350,18 +373,17 @@ Pops two values from the stack, and pushes back the result of a logical xor of t
 
 =cut
  */
-int inst_XOR(struct vm_context_t *context) {
+const op_t *inst_XOR(vm_context_t *context, const op_t *op) {
     scalar_t a = {0}, b = {0}, c = {0};
-    vm_ds_pop(context, &b);
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &b);
+    vm_ds_take(context, &a);
     int a_val = anon_scalar_get_bool_value(&a);
     int b_val = anon_scalar_get_bool_value(&b);
     anon_scalar_set_int_value(&c, ((a_val || b_val) && (!(a_val && b_val))));
-    vm_ds_push(context, &c);
-    anon_scalar_destroy(&c);
+    vm_ds_give(context, &c);
     anon_scalar_destroy(&b);
     anon_scalar_destroy(&a);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -371,14 +393,13 @@ Pops a value from the stack, and pushes back the result of a boolean not of the
 
 =cut
  */
-int inst_NOT(struct vm_context_t *context) {
+const op_t *inst_NOT(vm_context_t *context, const op_t *op) {
     scalar_t a = {0}, b = {0};
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &a);
     anon_scalar_set_int_value(&b, !anon_scalar_get_bool_value(&a));
-    vm_ds_push(context, &b);
-    anon_scalar_destroy(&b);
+    vm_ds_give(context, &b);
     anon_scalar_destroy(&a);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -388,9 +409,8 @@ Reads a jump destination from the following bytecode and transfers execution con
  
 =cut
  */
-int inst_JMP(vm_context_t *context) {
-    const intptr_t offset = *(const intptr_t *) NEXT_BYTE(context);
-    return offset;
+const op_t *inst_JMP(vm_context_t *context, const op_t *op) {
+    return op->m_target;
 }
 
 /*
@@ -402,24 +422,25 @@ control to the next instruction.
  
 =cut
  */
-int inst_JMP0(vm_context_t *context) {
-    const intptr_t branch_offset = *(const intptr_t *) NEXT_BYTE(context);
-    int incr = 0;
+const op_t *inst_JMP0(vm_context_t *context, const op_t *op) {
+    BYTECODE_QUICKEN(op, BYTECODE_DS_IS_INT(context, 0), i_JMP0_INT);
+
+    const op_t *next;
 
     scalar_t a = {0};
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &a);
 
     if (anon_scalar_get_bool_value(&a) == 0) {
-        // branch by offset
-        incr = branch_offset;
+        // branch
+        next = op->m_target;
     }
     else {
         // skip to the next instruction
-        incr = 1 + sizeof(branch_offset);
+        next = op + 1;
     }
     
     anon_scalar_destroy(&a);
-    return incr;
+    return next;
 }
 
 /*
@@ -430,22 +451,21 @@ transfers execution control to the jump destination.  Otherwise, transfers execu
 
 =cut
 */
-int inst_JMPU(struct vm_context_t *context) {
-    const intptr_t branch_offset = *(const intptr_t *) NEXT_BYTE(context);
-    int incr = 0;
+const op_t *inst_JMPU(vm_context_t *context, const op_t *op) {
+    const op_t *next;
     
     scalar_t a = {0};
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &a);
     if (anon_scalar_is_defined(&a) == 0) {
-        // branch by offset
-        incr = branch_offset;
+        // branch
+        next = op->m_target;
     }
     else {
-        incr = 1 + sizeof(branch_offset);
+        next = op + 1;
     }
     
     anon_scalar_destroy(&a);
-    return incr;
+    return next;
 }
 
 /*
@@ -455,18 +475,18 @@ Defines a new empty scalar and places a reference to it on the stack.
 
 =cut
 */
-int inst_SCALAR(struct vm_context_t *context) {
+const op_t *inst_SCALAR(vm_context_t *context, const op_t *op) {
     scalar_t ref = {0};
     
     scalar_handle_t handle = scalar_allocate(0);  FIXME("handle flags\n");
     anon_scalar_set_scalar_reference(&ref, handle);
     
-    vm_ds_push(context, &ref);
+    vm_ds_give(context, &ref);
     
     scalar_release(handle);
     anon_scalar_destroy(&ref);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -476,18 +496,18 @@ Defines a new empty array and places a reference to it on the stack.
 
 =cut
 */
-int inst_ARRAY(struct vm_context_t *context) {
+const op_t *inst_ARRAY(vm_context_t *context, const op_t *op) {
     scalar_t ref = {0};
     
     array_handle_t handle = array_allocate(0);  FIXME("handle flags\n");
     anon_scalar_set_array_reference(&ref, handle);
     
-    vm_ds_push(context, &ref);
+    vm_ds_give(context, &ref);
     
     array_release(handle);
     anon_scalar_destroy(&ref);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -497,18 +517,18 @@ Defines a new empty hash and places a reference to it on the stack.
 
 =cut
 */
-int inst_HASH(struct vm_context_t *context) {
+const op_t *inst_HASH(vm_context_t *context, const op_t *op) {
     scalar_t ref = {0};
     
     hash_handle_t handle = hash_allocate();
     anon_scalar_set_hash_reference(&ref, handle);
     
-    vm_ds_push(context, &ref);
+    vm_ds_give(context, &ref);
     
     hash_release(handle);
     anon_scalar_destroy(&ref);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -518,18 +538,18 @@ Defines a new channel and places a reference to it on the stack.
 
 =cut
 */
-int inst_CHANNEL(struct vm_context_t *context) {
+const op_t *inst_CHANNEL(vm_context_t *context, const op_t *op) {
     scalar_t ref = {0};
     
     channel_handle_t handle = channel_allocate();
     anon_scalar_set_channel_reference(&ref, handle);
     
-    vm_ds_push(context, &ref);
+    vm_ds_give(context, &ref);
     
     channel_release(handle);
     anon_scalar_destroy(&ref);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -539,18 +559,18 @@ Defines a new stream and places a reference to it on the stack.
 
 =cut
 */
-int inst_STREAM(struct vm_context_t *context) {
+const op_t *inst_STREAM(vm_context_t *context, const op_t *op) {
     scalar_t ref = {0};
     
     stream_handle_t handle = stream_allocate();
     anon_scalar_set_stream_reference(&ref, handle);
     
-    vm_ds_push(context, &ref);
+    vm_ds_give(context, &ref);
     
     stream_release(handle);
     anon_scalar_destroy(&ref);
     
-    return 1;
+    return op + 1;
 }
 
 
@@ -580,34 +600,52 @@ Pushes back a reference to the new symbol on success, or undef on failure.
 
 =cut
  */
-int inst_SYMDEF(struct vm_context_t *context) {
-    const flags32_t flags = *(const flags32_t *) (&context->m_bytecode[context->m_counter + 1]);
-    const identifier_t identifier = *(const identifier_t *) (&context->m_bytecode[context->m_counter + 1 + sizeof(flags)]);
+const op_t *inst_SYMDEF(vm_context_t *context, const op_t *op) {
+    const flags32_t flags = BYTECODE_OP_FLAGS(op);
+    const identifier_t identifier = op->m_operand.as_identifier;
     
     scalar_t a = {0}, ref = {0};
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &a);
 
     const symbol_t *symbol = NULL;
     
     // define an entry in the symbol table
-    if ((a.m_flags & SCALAR_TYPE_MASK) == SCALAR_UNDEF) {
+    if (anon_scalar_type(&a) == SCALAR_UNDEF) {
         symbol = symbol_define(context->m_symboltable, identifier, flags, 0);
     }
-    else if ((a.m_flags & SCALAR_FLAG_REF)) {
+    else if ((anon_scalar_type(&a) & SCALAR_FLAG_REF)) {
         // getting the handle directly rather than requesting a reference to it is safe, because
         // a itself will continue to hold onto the reference and ensure it isn't deallocated
         // before we finish
-        handle_t handle = a.m_value.as_scalar_handle;  // handle types are interchangeable
+        handle_t handle = 0;
         flags32_t flags = 0;
-        switch (a.m_flags & SCALAR_TYPE_MASK) {
-            case SCALAR_SCAREF:     flags = SYMBOL_SCALAR;      break;
-            case SCALAR_ARRREF:     flags = SYMBOL_ARRAY;       break;
-            case SCALAR_HASHREF:    flags = SYMBOL_HASH;        break;
-            case SCALAR_CHANREF:    flags = SYMBOL_CHANNEL;     break;
-            case SCALAR_FUNCREF:    flags = SYMBOL_FUNCTION;    break;
-            case SCALAR_STRMREF:    flags = SYMBOL_STREAM;      break;
+        switch (anon_scalar_type(&a)) {
+            case SCALAR_SCAREF:
+                flags = SYMBOL_SCALAR;
+                handle = anon_scalar_deref_scalar_reference(&a);
+                break;
+            case SCALAR_ARRREF:
+                flags = SYMBOL_ARRAY;
+                handle = anon_scalar_deref_array_reference(&a);
+                break;
+            case SCALAR_HASHREF:
+                flags = SYMBOL_HASH;
+                handle = anon_scalar_deref_hash_reference(&a);
+                break;
+            case SCALAR_CHANREF:
+                flags = SYMBOL_CHANNEL;
+                handle = anon_scalar_deref_channel_reference(&a);
+                break;
+            case SCALAR_FUNCREF:
+                flags = SYMBOL_FUNCTION;
+                handle = anon_scalar_deref_function_reference(&a);
+                break;
+            case SCALAR_STRMREF:
+                flags = SYMBOL_STREAM;
+                handle = anon_scalar_deref_stream_reference(&a);
+                break;
             default:
-                debug("unhandled scalar reference type: %"PRIu32"\n", a.m_flags);
+                debug("unhandled scalar reference type: %"PRIu32"\n", anon_scalar_type(&a));
                 handle = 0;
                 break;
         }
@@ -656,27 +694,28 @@ int inst_SYMDEF(struct vm_context_t *context) {
     }
     
     // finish up
-    vm_ds_push(context, &ref);
+    vm_ds_give(context, &ref);
     
     anon_scalar_destroy(&ref);
     anon_scalar_destroy(&a);
     
-    return 1 + sizeof(flags) + sizeof(identifier);
+    return op + 1;
 }
 
 /*
 =item SYMFIND ( -- ref )
 
-Reads an identifier from the following bytecode and looks it up in the symbol table.
+Reads an identifier from the following bytecode and looks it up in the symbol table.  Each SYMFIND caches its most
+recent result until the symbol tables change (see symbol_lookup_cached()).
 
 Pushes a reference to the symbol to the data stack if found, or undef if not found.
  
 =cut
  */
-int inst_SYMFIND(struct vm_context_t *context) {
-    const identifier_t identifier = *(const identifier_t *) (&context->m_bytecode[context->m_counter + 1]);
+const op_t *inst_SYMFIND(vm_context_t *context, const op_t *op) {
+    const identifier_t identifier = op->m_operand.as_identifier;
     
-    const symbol_t *symbol = symbol_lookup(context->m_symboltable, identifier);
+    const symbol_t *symbol = symbol_lookup_cached(context->m_symboltable, identifier, op->m_symbol_cache);
 
     scalar_t ref = {0};
     
@@ -707,10 +746,9 @@ int inst_SYMFIND(struct vm_context_t *context) {
         }
     }
     
-    vm_ds_push(context, &ref);
-    anon_scalar_destroy(&ref);
+    vm_ds_give(context, &ref);
     
-    return 1 + sizeof(identifier);
+    return op + 1;
 }
 
 /*
@@ -721,10 +759,10 @@ a reference to the symbol to the data stack.
 
 =cut
  */
-int inst_SYMCLONE(struct vm_context_t *context) {
-    const identifier_t identifier = *(const identifier_t *) (&context->m_bytecode[context->m_counter + 1]);
+const op_t *inst_SYMCLONE(vm_context_t *context, const op_t *op) {
+    const identifier_t identifier = op->m_operand.as_identifier;
     
-    const symbol_t *symbol = symbol_clone(context->m_symboltable, identifier);
+    const symbol_t *symbol = symbol_clone_cached(context->m_symboltable, identifier, op->m_symbol_cache);
 
     scalar_t ref = {0};
     
@@ -755,10 +793,9 @@ int inst_SYMCLONE(struct vm_context_t *context) {
         }
     }
     
-    vm_ds_push(context, &ref);
-    anon_scalar_destroy(&ref);
+    vm_ds_give(context, &ref);
     
-    return 1 + sizeof(identifier);
+    return op + 1;
 }
 
 
@@ -769,12 +806,12 @@ Reads an identifier from the following bytecode.  Removes the identifier from th
 
 =cut
  */
-int inst_SYMUNDEF(struct vm_context_t *context) {
-    const identifier_t identifier = *(const identifier_t *) (&context->m_bytecode[context->m_counter + 1]);
+const op_t *inst_SYMUNDEF(vm_context_t *context, const op_t *op) {
+    const identifier_t identifier = op->m_operand.as_identifier;
     
     symbol_undefine(context->m_symboltable, identifier);
     
-    return 1 + sizeof(identifier);
+    return op + 1;
 }
 
 /*
@@ -784,14 +821,10 @@ Pops a scalar reference from the data stack and arranges for the referenced scal
 
 =cut
  */
-int inst_SRLOCK(struct vm_context_t *context) {
-    scalar_t sr = {0};
-    
-    vm_ds_top(context, &sr);
-    scalar_lock(anon_scalar_deref_scalar_reference(&sr));
-    
-    anon_scalar_destroy(&sr);
-    return 1;
+const op_t *inst_SRLOCK(vm_context_t *context, const op_t *op) {
+    scalar_lock(anon_scalar_deref_scalar_reference(vm_ds_peek(context, 0)));
+
+    return op + 1;
 }
 
 /*
@@ -801,14 +834,14 @@ Pops a scalar reference from the data stack and arranges for the referenced scal
 
 =cut
  */
-int inst_SRUNLOCK(struct vm_context_t *context) {
+const op_t *inst_SRUNLOCK(vm_context_t *context, const op_t *op) {
     scalar_t sr = {0};
     
-    vm_ds_pop(context, &sr);
+    vm_ds_take(context, &sr);
     scalar_unlock(anon_scalar_deref_scalar_reference(&sr));
     
     anon_scalar_destroy(&sr);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -818,17 +851,17 @@ Pops a scalar reference from the data stack.  Pushes the value of the referenced
 
 =cut
  */
-int inst_SRREAD(struct vm_context_t *context) {
+const op_t *inst_SRREAD(vm_context_t *context, const op_t *op) {
     scalar_t ref = {0}, a = {0};
 
-    vm_ds_pop(context, &ref);
+    vm_ds_take(context, &ref);
     scalar_get_value(anon_scalar_deref_scalar_reference(&ref), &a);
-    vm_ds_push(context, &a);
+    vm_ds_give(context, &a);
     
     anon_scalar_destroy(&a);
     anon_scalar_destroy(&ref);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -838,18 +871,63 @@ Pops a scalar reference and a scalar value from the data stack.  Stores the valu
  
 =cut
  */
-int inst_SRWRITE(struct vm_context_t *context) {
+const op_t *inst_SRWRITE(vm_context_t *context, const op_t *op) {
     scalar_t ref = {0}, a = {0};
     
-    vm_ds_pop(context, &ref);
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &ref);
+    vm_ds_take(context, &a);
 
     scalar_set_value(anon_scalar_deref_scalar_reference(&ref), &a);
     
     anon_scalar_destroy(&a);
     anon_scalar_destroy(&ref);
     
-    return 1;
+    return op + 1;
+}
+
+/*
+=item SRAPPEND ( a ref -- )
+
+Pops a scalar reference and a scalar value from the data stack.  Appends the string value of the value to the
+referenced scalar in place, without copying what's already there.  Appending to the same scalar repeatedly builds up
+a string in linear time, where CAT would copy the whole string each time.
+
+=cut
+ */
+const op_t *inst_SRAPPEND(vm_context_t *context, const op_t *op) {
+    scalar_t ref = {0}, a = {0};
+    
+    vm_ds_take(context, &ref);
+    vm_ds_take(context, &a);
+
+    scalar_append_value(anon_scalar_deref_scalar_reference(&ref), &a);
+    
+    anon_scalar_destroy(&a);
+    anon_scalar_destroy(&ref);
+    
+    return op + 1;
+}
+
+/*
+=item SRTAKE ( ref -- a )
+
+Pops a scalar reference from the data stack.  Pushes the value of the referenced scalar, and leaves the referenced
+scalar undefined.  Use this to finish off a string built with SRAPPEND: the string is handed over as is, rather than
+shared, so neither the result nor the next SRAPPEND to the scalar needs to copy it.
+
+=cut
+ */
+const op_t *inst_SRTAKE(vm_context_t *context, const op_t *op) {
+    scalar_t ref = {0}, a = {0};
+
+    vm_ds_take(context, &ref);
+    scalar_take_value(anon_scalar_deref_scalar_reference(&ref), &a);
+    vm_ds_give(context, &a);
+    
+    anon_scalar_destroy(&a);
+    anon_scalar_destroy(&ref);
+    
+    return op + 1;
 }
 
 /*
@@ -859,19 +937,19 @@ Pops an array reference from the stack.  Pushes back the number of items it cont
 
 =cut
 */
-int inst_ARLEN(struct vm_context_t *context) {
+const op_t *inst_ARLEN(vm_context_t *context, const op_t *op) {
     scalar_t ar = {0}, n = {0};
     
-    vm_ds_pop(context, &ar);
+    vm_ds_take(context, &ar);
     
     anon_scalar_set_int_value(&n, array_size(anon_scalar_deref_array_reference(&ar)));
     
-    vm_ds_push(context, &n);
+    vm_ds_give(context, &n);
     
     anon_scalar_destroy(&n);
     anon_scalar_destroy(&ar);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -885,23 +963,23 @@ Negative indices are treated as relative to the end of the array, thus -1 is the
 
 =cut
  */
-int inst_ARINDEX(struct vm_context_t *context) {
+const op_t *inst_ARINDEX(vm_context_t *context, const op_t *op) {
     scalar_t ar = {0}, i = {0}, sr = {0};
     
-    vm_ds_pop(context, &ar);
-    vm_ds_pop(context, &i);
+    vm_ds_take(context, &ar);
+    vm_ds_take(context, &i);
     
-    assert((ar.m_flags & SCALAR_TYPE_MASK) == SCALAR_ARRREF);
+    assert(anon_scalar_type(&ar) == SCALAR_ARRREF);
     scalar_handle_t s = array_item_at(anon_scalar_deref_array_reference(&ar), anon_scalar_get_int_value(&i));
     anon_scalar_set_scalar_reference(&sr, s);
     scalar_release(s);
-    vm_ds_push(context, &sr);
+    vm_ds_give(context, &sr);
     
     anon_scalar_destroy(&sr);
     anon_scalar_destroy(&i);
     anon_scalar_destroy(&ar);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -918,29 +996,24 @@ are undefined.
 
 =cut
 */
-int inst_ARSLICE(struct vm_context_t *context) {
+const op_t *inst_ARSLICE(vm_context_t *context, const op_t *op) {
     scalar_t ar = {0}, count = {0};
     
-    vm_ds_pop(context, &ar);
-    vm_ds_pop(context, &count);
+    vm_ds_take(context, &ar);
+    vm_ds_take(context, &count);
 
     intptr_t c = anon_scalar_get_int_value(&count);
     if (c > 0) {
         scalar_t *indices = calloc(c, sizeof(*indices));
         if (indices != NULL) {
-            vm_ds_npop(context, c, indices);
-
-            array_slice(ar.m_value.as_array_handle, indices, c);
+            vm_ds_ntake(context, c, indices);
 
-            vm_ds_npush(context, c, indices);
+            array_slice(anon_scalar_deref_array_reference(&ar), indices, c);
 
-            for (int i = 0; i < c; i++) {
-                anon_scalar_destroy(&indices[i]);
-            }
-            
+            vm_ds_ngive(context, c, indices);
             free(indices);
 
-            vm_ds_push(context, &count);
+            vm_ds_give(context, &count);
         }
         else {
             debug("calloc failed\n");
@@ -948,13 +1021,13 @@ int inst_ARSLICE(struct vm_context_t *context) {
     }
     else {
         anon_scalar_set_int_value(&count, 0);
-        vm_ds_push(context, &count);
+        vm_ds_give(context, &count);
     }
     
     anon_scalar_destroy(&count);
     anon_scalar_destroy(&ar);
 
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -965,29 +1038,23 @@ the number of items in the array.
 
 =cut
 */
-int inst_ARLIST(struct vm_context_t *context) {
+const op_t *inst_ARLIST(vm_context_t *context, const op_t *op) {
     scalar_t ar = {0}, *values = NULL, count = {0};
     size_t n = 0;
     
-    vm_ds_pop(context, &ar);
+    vm_ds_take(context, &ar);
     
-    if (0 == array_list(ar.m_value.as_array_handle, &values, &n)) {
-        if (n > 0)  vm_ds_npush(context, n, values);
+    if (0 == array_list(anon_scalar_deref_array_reference(&ar), &values, &n)) {
+        if (n > 0)  vm_ds_ngive(context, n, values);
         anon_scalar_set_int_value(&count, n);
     }
 
-    vm_ds_push(context, &count);
+    vm_ds_give(context, &count);
     
-    if (values != NULL) {
-        for (size_t i = 0; i < n; i++) {
-            anon_scalar_destroy(&values[i]);
-        }
-        free(values);
-    }
-    anon_scalar_destroy(&count);
+    if (values != NULL)  free(values);
     anon_scalar_destroy(&ar);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1000,25 +1067,25 @@ To empty an array, provide a count of zero.
 
 =cut
 */
-int inst_ARFILL(struct vm_context_t *context) {
+const op_t *inst_ARFILL(vm_context_t *context, const op_t *op) {
     scalar_t ar = {0}, count = {0}, *values = NULL;
     
-    vm_ds_pop(context, &ar);
-    assert((ar.m_flags & SCALAR_TYPE_MASK) == SCALAR_ARRREF);
+    vm_ds_take(context, &ar);
+    assert(anon_scalar_type(&ar) == SCALAR_ARRREF);
 
-    vm_ds_pop(context, &count);
+    vm_ds_take(context, &count);
     size_t n = anon_scalar_get_int_value(&count);
     
     if (n > 0) {
         if (NULL != (values = calloc(n, sizeof(*values)))) {
-            vm_ds_npop(context, n, values);
+            vm_ds_ntake(context, n, values);
             array_fill(anon_scalar_deref_array_reference(&ar), values, n);
             for (size_t i = 0; i < n; i++)  anon_scalar_destroy(&values[i]);
             free(values);
         }
         else {
             debug("calloc failed\n");
-            return 0;
+            return NULL;
         }
     }
     else {
@@ -1028,7 +1095,7 @@ int inst_ARFILL(struct vm_context_t *context) {
     anon_scalar_destroy(&count);
     anon_scalar_destroy(&ar);
 
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1038,18 +1105,18 @@ Pops an array reference, a count, and count values from the data stack, and adds
 
 =cut
  */
-int inst_ARPUSH(struct vm_context_t *context) {
+const op_t *inst_ARPUSH(vm_context_t *context, const op_t *op) {
     scalar_t *values = NULL, count = {0}, ar = {0};
     
-    vm_ds_pop(context, &ar);    
-    assert((ar.m_flags & SCALAR_TYPE_MASK) == SCALAR_ARRREF);
+    vm_ds_take(context, &ar);    
+    assert(anon_scalar_type(&ar) == SCALAR_ARRREF);
 
-    vm_ds_pop(context, &count);
+    vm_ds_take(context, &count);
     size_t n = anon_scalar_get_int_value(&count);
     
     if (n > 0) {
         if (NULL != (values = calloc(n, sizeof(*values)))) {
-            vm_ds_npop(context, n, values);
+            vm_ds_ntake(context, n, values);
 
             array_push(anon_scalar_deref_array_reference(&ar), values, n);
             
@@ -1064,7 +1131,7 @@ int inst_ARPUSH(struct vm_context_t *context) {
     anon_scalar_destroy(&count);
     anon_scalar_destroy(&ar);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1074,18 +1141,18 @@ Pops an array reference, a count, and count values from the data stack, and adds
 
 =cut
  */
-int inst_ARUNSHFT(struct vm_context_t *context) {
+const op_t *inst_ARUNSHFT(vm_context_t *context, const op_t *op) {
     scalar_t *values = NULL, count = {0}, ar = {0};
     
-    vm_ds_pop(context, &ar);    
-    assert((ar.m_flags & SCALAR_TYPE_MASK) == SCALAR_ARRREF);
+    vm_ds_take(context, &ar);    
+    assert(anon_scalar_type(&ar) == SCALAR_ARRREF);
 
-    vm_ds_pop(context, &count);
+    vm_ds_take(context, &count);
     size_t n = anon_scalar_get_int_value(&count);
     
     if (n > 0) {
         if (NULL != (values = calloc(n, sizeof(*values)))) {
-            vm_ds_npop(context, n, values);
+            vm_ds_ntake(context, n, values);
 
             array_unshift(anon_scalar_deref_array_reference(&ar), values, n);
             
@@ -1100,7 +1167,7 @@ int inst_ARUNSHFT(struct vm_context_t *context) {
     anon_scalar_destroy(&count);
     anon_scalar_destroy(&ar);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1111,20 +1178,20 @@ data stack.
 
 =cut
  */
-int inst_ARPOP(struct vm_context_t *context) {
+const op_t *inst_ARPOP(vm_context_t *context, const op_t *op) {
     scalar_t ar = {0}, a = {0};
     
-    vm_ds_pop(context, &ar);
+    vm_ds_take(context, &ar);
     
-    assert((ar.m_flags & SCALAR_TYPE_MASK) == SCALAR_ARRREF);
-    array_pop(ar.m_value.as_array_handle, &a);
+    assert(anon_scalar_type(&ar) == SCALAR_ARRREF);
+    array_pop(anon_scalar_deref_array_reference(&ar), &a);
     
-    vm_ds_push(context, &a);
+    vm_ds_give(context, &a);
 
     anon_scalar_destroy(&a);
     anon_scalar_destroy(&ar);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1135,20 +1202,20 @@ data stack.
 
 =cut
  */
-int inst_ARSHFT(struct vm_context_t *context) {
+const op_t *inst_ARSHFT(vm_context_t *context, const op_t *op) {
     scalar_t ar = {0}, a = {0};
     
-    vm_ds_pop(context, &ar);
+    vm_ds_take(context, &ar);
     
-    assert((ar.m_flags & SCALAR_TYPE_MASK) == SCALAR_ARRREF);
-    array_shift(ar.m_value.as_array_handle, &a);
+    assert(anon_scalar_type(&ar) == SCALAR_ARRREF);
+    array_shift(anon_scalar_deref_array_reference(&ar), &a);
     
-    vm_ds_push(context, &a);
+    vm_ds_give(context, &a);
     
     anon_scalar_destroy(&a);
     anon_scalar_destroy(&ar);
     
-    return 1;    
+    return op + 1;    
 }
 
 /*
@@ -1158,19 +1225,19 @@ Pops a hash reference from the stack.  Pushes back the number of items in the ha
 
 =cut
 */
-int inst_HRLEN(struct vm_context_t *context) {
+const op_t *inst_HRLEN(vm_context_t *context, const op_t *op) {
     scalar_t hr = {0}, n = {0};
     
-    vm_ds_pop(context, &hr);
+    vm_ds_take(context, &hr);
     
     anon_scalar_set_int_value(&n, hash_size(anon_scalar_deref_hash_reference(&hr)));
     
-    vm_ds_push(context, &n);
+    vm_ds_give(context, &n);
     
     anon_scalar_destroy(&n);
     anon_scalar_destroy(&hr);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1182,24 +1249,24 @@ If the key does not exist, it is automatically created and its value set to unde
 
 =cut
  */
-int inst_HRINDEX(struct vm_context_t *context) {
+const op_t *inst_HRINDEX(vm_context_t *context, const op_t *op) {
     scalar_t hr = {0}, k = {0}, sr = {0};
     
-    vm_ds_pop(context, &hr);
-    vm_ds_pop(context, &k);
+    vm_ds_take(context, &hr);
+    vm_ds_take(context, &k);
     
-    assert((hr.m_flags & SCALAR_TYPE_MASK) == SCALAR_HASHREF);
+    assert(anon_scalar_type(&hr) == SCALAR_HASHREF);
     scalar_handle_t s = hash_key_item(anon_scalar_deref_hash_reference(&hr), &k);
     anon_scalar_set_scalar_reference(&sr, s);
     scalar_release(s);
     
-    vm_ds_push(context, &sr);
+    vm_ds_give(context, &sr);
     
     anon_scalar_destroy(&sr);
     anon_scalar_destroy(&k);
     anon_scalar_destroy(&hr);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1212,20 +1279,20 @@ If any keys are not currently defined in the hash, they are automatically create
 
 =cut
 */
-int inst_HRSLICE(struct vm_context_t *context) {
+const op_t *inst_HRSLICE(vm_context_t *context, const op_t *op) {
     scalar_t *elements = NULL, count = {0}, hr = {0};
     
-    vm_ds_pop(context, &hr);
-    assert((hr.m_flags & SCALAR_TYPE_MASK) == SCALAR_HASHREF);
+    vm_ds_take(context, &hr);
+    assert(anon_scalar_type(&hr) == SCALAR_HASHREF);
     
-    vm_ds_pop(context, &count);
+    vm_ds_take(context, &count);
     size_t n = anon_scalar_get_int_value(&count);
     
     if (n > 0) {
         if (NULL != (elements = calloc(n, sizeof(*elements)))) {
-            vm_ds_npop(context, n, elements);
+            vm_ds_ntake(context, n, elements);
             hash_slice(anon_scalar_deref_hash_reference(&hr), elements, n);
-            vm_ds_npush(context, n, elements);
+            vm_ds_ngive(context, n, elements);
             free(elements);
         }
         else {
@@ -1237,12 +1304,12 @@ int inst_HRSLICE(struct vm_context_t *context) {
         anon_scalar_set_int_value(&count, 0);
     }
 
-    vm_ds_push(context, &count);
+    vm_ds_give(context, &count);
     
     anon_scalar_destroy(&count);
     anon_scalar_destroy(&hr);
 
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1252,27 +1319,27 @@ Pops a hash reference from the data stack.  Pushes back a list of the keys defin
 
 =cut
 */
-int inst_HRLISTK(struct vm_context_t *context) {
+const op_t *inst_HRLISTK(vm_context_t *context, const op_t *op) {
     scalar_t hr = {0}, *keys = NULL, count = {0};
     size_t n;
     
-    vm_ds_pop(context, &hr);
-    assert((hr.m_flags & SCALAR_TYPE_MASK) == SCALAR_HASHREF);
+    vm_ds_take(context, &hr);
+    assert(anon_scalar_type(&hr) == SCALAR_HASHREF);
 
     if (0 == hash_list_keys(anon_scalar_deref_hash_reference(&hr), &keys, &n)) {
         if (n > 0) {
-            vm_ds_npush(context, n, keys);
+            vm_ds_ngive(context, n, keys);
             free(keys);
         }
         anon_scalar_set_int_value(&count, n);
     }
     
-    vm_ds_push(context, &count);
+    vm_ds_give(context, &count);
     
     anon_scalar_destroy(&count);
     anon_scalar_destroy(&hr);
 
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1282,27 +1349,27 @@ Pops a hash reference from the data stack.  Pushes back a list of the values def
 
 =cut
 */
-int inst_HRLISTV(struct vm_context_t *context) {
+const op_t *inst_HRLISTV(vm_context_t *context, const op_t *op) {
     scalar_t hr = {0}, *values = NULL, count = {0};
     size_t n;
     
-    vm_ds_pop(context, &hr);
-    assert((hr.m_flags & SCALAR_TYPE_MASK) == SCALAR_HASHREF);
+    vm_ds_take(context, &hr);
+    assert(anon_scalar_type(&hr) == SCALAR_HASHREF);
 
     if (0 == hash_list_values(anon_scalar_deref_hash_reference(&hr), &values, &n)) {
         if (n > 0) {
-            vm_ds_npush(context, n, values);
+            vm_ds_ngive(context, n, values);
             free(values);
         }
         anon_scalar_set_int_value(&count, n);
     }
     
-    vm_ds_push(context, &count);
+    vm_ds_give(context, &count);
     
     anon_scalar_destroy(&count);
     anon_scalar_destroy(&hr);
 
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1313,28 +1380,27 @@ count of items (i.e. an even number).
 
 =cut
 */
-int inst_HRLISTP(struct vm_context_t *context) {
+const op_t *inst_HRLISTP(vm_context_t *context, const op_t *op) {
     scalar_t hr = {0}, *pairs = NULL, count = {0};
     size_t n;
     
-    vm_ds_pop(context, &hr);
-    assert((hr.m_flags & SCALAR_TYPE_MASK) == SCALAR_HASHREF);
+    vm_ds_take(context, &hr);
+    assert(anon_scalar_type(&hr) == SCALAR_HASHREF);
 
     if (0 == hash_list_pairs(anon_scalar_deref_hash_reference(&hr), &pairs, &n)) {
         if (n > 0) {
-            vm_ds_npush(context, n, pairs);
-            for (size_t i = 0; i < n; i++)  anon_scalar_destroy(&pairs[i]);
+            vm_ds_ngive(context, n, pairs);
             free(pairs);
         }
         anon_scalar_set_int_value(&count, n);
     }
     
-    vm_ds_push(context, &count);
+    vm_ds_give(context, &count);
     
     anon_scalar_destroy(&count);
     anon_scalar_destroy(&hr);
 
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1347,13 +1413,13 @@ To empty a hash, provide a count of zero.
 
 =cut
 */
-int inst_HRFILL(struct vm_context_t *context) {
+const op_t *inst_HRFILL(vm_context_t *context, const op_t *op) {
     scalar_t hr = {0}, count = {0}, *pairs = NULL;
     
-    vm_ds_pop(context, &hr);
-    assert((hr.m_flags & SCALAR_TYPE_MASK) == SCALAR_HASHREF);
+    vm_ds_take(context, &hr);
+    assert(anon_scalar_type(&hr) == SCALAR_HASHREF);
 
-    vm_ds_pop(context, &count);
+    vm_ds_take(context, &count);
     size_t n = anon_scalar_get_int_value(&count);
     
     if (n > 0) {
@@ -1363,14 +1429,14 @@ int inst_HRFILL(struct vm_context_t *context) {
         }
         
         if (NULL != (pairs = calloc(n, sizeof(*pairs)))) {
-            vm_ds_npop(context, n, pairs);
+            vm_ds_ntake(context, n, pairs);
             hash_fill(anon_scalar_deref_hash_reference(&hr), pairs, n);
             for (size_t i = 0; i < n; i++)  anon_scalar_destroy(&pairs[i]);
             free(pairs);
         }
         else {
             debug("calloc failed\n");
-            return 0;
+            return NULL;
         }
     }
     else {
@@ -1380,7 +1446,7 @@ int inst_HRFILL(struct vm_context_t *context) {
     anon_scalar_destroy(&count);
     anon_scalar_destroy(&hr);
 
-    return 1;
+    return op + 1;
 }
 
 
@@ -1392,22 +1458,22 @@ If it does not, pushes back the value 0.
 
 =cut
  */
-int inst_HRKEYEX(struct vm_context_t *context) {
+const op_t *inst_HRKEYEX(vm_context_t *context, const op_t *op) {
     scalar_t hr = {0}, k = {0}, b = {0};
     
-    vm_ds_pop(context, &hr);
-    vm_ds_pop(context, &k);
+    vm_ds_take(context, &hr);
+    vm_ds_take(context, &k);
     
-    assert((hr.m_flags & SCALAR_TYPE_MASK) == SCALAR_HASHREF);
+    assert(anon_scalar_type(&hr) == SCALAR_HASHREF);
     anon_scalar_set_int_value(&b, hash_key_exists(anon_scalar_deref_hash_reference(&hr), &k));
     
-    vm_ds_push(context, &b);
+    vm_ds_give(context, &b);
     
     anon_scalar_destroy(&b);
     anon_scalar_destroy(&k);
     anon_scalar_destroy(&hr);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1417,19 +1483,19 @@ Pops a hash reference and a key from the data stack.  Deletes the key from the h
 
 =cut
  */
-int inst_HRKEYDEL(struct vm_context_t *context) {
+const op_t *inst_HRKEYDEL(vm_context_t *context, const op_t *op) {
     scalar_t hr = {0}, k = {0};
     
-    vm_ds_pop(context, &hr);
-    vm_ds_pop(context, &k);
+    vm_ds_take(context, &hr);
+    vm_ds_take(context, &k);
     
-    assert((hr.m_flags & SCALAR_TYPE_MASK) == SCALAR_HASHREF);
+    assert(anon_scalar_type(&hr) == SCALAR_HASHREF);
     hash_key_delete(anon_scalar_deref_hash_reference(&hr), &k);
     
     anon_scalar_destroy(&hr);
     anon_scalar_destroy(&k);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1444,20 +1510,20 @@ read anything.
 
 =cut
  */
-int inst_CRTRYRD(struct vm_context_t *context) {
+const op_t *inst_CRTRYRD(vm_context_t *context, const op_t *op) {
     scalar_t cr = {0}, a = {0};
     
-    vm_ds_pop(context, &cr);
+    vm_ds_take(context, &cr);
     
-    assert((cr.m_flags & SCALAR_TYPE_MASK) == SCALAR_CHANREF);
+    assert(anon_scalar_type(&cr) == SCALAR_CHANREF);
     channel_tryread(anon_scalar_deref_channel_reference(&cr), &a);
     
-    vm_ds_push(context, &a);
+    vm_ds_give(context, &a);
     
     anon_scalar_destroy(&a);
     anon_scalar_destroy(&cr);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1468,19 +1534,19 @@ If there is no value ready to be read, blocks the calling thread until one becom
 
 =cut
  */
-int inst_CRREAD(struct vm_context_t *context) {
+const op_t *inst_CRREAD(vm_context_t *context, const op_t *op) {
     scalar_t ref = {0}, a = {0};
     
-    vm_ds_pop(context, &ref);
+    vm_ds_take(context, &ref);
     
-    assert((ref.m_flags & SCALAR_TYPE_MASK) == SCALAR_CHANREF);
+    assert(anon_scalar_type(&ref) == SCALAR_CHANREF);
     channel_read(anon_scalar_deref_channel_reference(&ref), &a);
     
-    vm_ds_push(context, &a);
+    vm_ds_give(context, &a);
     
     anon_scalar_destroy(&a);
     anon_scalar_destroy(&ref);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1490,19 +1556,19 @@ Pops a channel reference and a value from the data stack, and writes the value t
 
 =cut
  */
-int inst_CRWRITE(struct vm_context_t *context) {
+const op_t *inst_CRWRITE(vm_context_t *context, const op_t *op) {
     scalar_t a = {0}, ref = {0};
     
-    vm_ds_pop(context, &ref);
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &ref);
+    vm_ds_take(context, &a);
     
-    assert((ref.m_flags & SCALAR_TYPE_MASK) == SCALAR_CHANREF);
+    assert(anon_scalar_type(&ref) == SCALAR_CHANREF);
     channel_write(anon_scalar_deref_channel_reference(&ref), &a);
     
     anon_scalar_destroy(&ref);
     anon_scalar_destroy(&a);
     
-    return 1;
+    return op + 1;
 }
 
 
@@ -1512,22 +1578,24 @@ int inst_CRWRITE(struct vm_context_t *context) {
 Pops a function reference from the data stack.  Pushes the location of the following instruction to the return stack, 
 starts a new symbol table scope, then transfers execution control to the destination reference by the function reference.
 
+As with CALL, an FRCALL immediately followed by RETURN is a tail call.
+
 =cut
  */
-int inst_FRCALL(struct vm_context_t *context) {
+const op_t *inst_FRCALL(vm_context_t *context, const op_t *op) {
     scalar_t fr = {0};
-    vm_ds_pop(context, &fr);
-    function_handle_t jump_dest = anon_scalar_deref_function_reference(&fr);
+    vm_ds_take(context, &fr);
+    const op_t *jump_dest = program_op(context->m_program, anon_scalar_deref_function_reference(&fr));
     anon_scalar_destroy(&fr);
 
-    vm_state_t ret_state = {0};
-    vm_state_init(&ret_state, context->m_counter + 1, context->m_flags, context->m_symboltable);
-    vm_rs_push(context, &ret_state);
-    vm_state_destroy(&ret_state);
-    
-    vm_start_scope(context);
+    if (jump_dest == NULL) {
+        debug("function reference does not refer to an instruction\n");
+        return op + 1;
+    }
+
+    _bytecode_call(context, op, jump_dest);
     
-    return jump_dest - context->m_counter;
+    return jump_dest;
 }
 
 /*
@@ -1540,23 +1608,28 @@ Pops n and n parameters from the caller's stack and pushes them in the same orde
 
 =cut
  */
-int inst_FRCORO(struct vm_context_t *context) {
-    function_handle_t jump_dest;
+const op_t *inst_FRCORO(vm_context_t *context, const op_t *op) {
+    const op_t *jump_dest;
     scalar_t *params = NULL;
     uintptr_t num_params = 0;
     
     scalar_t fr = {0};
-    vm_ds_pop(context, &fr);
-    assert((fr.m_flags & SCALAR_TYPE_MASK) == SCALAR_FUNCREF);
-    jump_dest = anon_scalar_deref_function_reference(&fr);
+    vm_ds_take(context, &fr);
+    assert(anon_scalar_type(&fr) == SCALAR_FUNCREF);
+    jump_dest = program_op(context->m_program, anon_scalar_deref_function_reference(&fr));
     anon_scalar_destroy(&fr);
+
+    if (jump_dest == NULL) {
+        debug("function reference does not refer to an instruction\n");
+        return op + 1;
+    }
     
     scalar_t n = {0};
-    vm_ds_pop(context, &n);    
+    vm_ds_take(context, &n);    
     if (anon_scalar_get_int_value(&n) > 0) {
         num_params = anon_scalar_get_int_value(&n);
         if (NULL != (params = calloc(num_params, sizeof(*params)))) {
-            vm_ds_npop(context, num_params, params);
+            vm_ds_ntake(context, num_params, params);
         }
         else {
             debug("couldn't allocate space for %"PRIuPTR" parameters to coro\n", num_params);
@@ -1567,13 +1640,10 @@ int inst_FRCORO(struct vm_context_t *context) {
     
     vm_context_t *child_context;
     if (NULL != (child_context = calloc(1, sizeof(*child_context)))) {
-        vm_context_init(child_context, context->m_bytecode, context->m_bytecode_length, jump_dest);
+        vm_context_init(child_context, context->m_program, jump_dest);
 
         if (params != NULL) {
-            vm_ds_npush(child_context, num_params, params);
-            for (uintptr_t i = 0; i < num_params; i++) {
-                anon_scalar_destroy(&params[i]);
-            }
+            vm_ds_ngive(child_context, num_params, params);
             free(params);
             params = NULL;
         }
@@ -1594,7 +1664,7 @@ int inst_FRCORO(struct vm_context_t *context) {
         FIXME("what to do here?\n");
     }
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1605,15 +1675,12 @@ bytecode following it.
 
 =cut
 */
-int inst_BYTE(vm_context_t *context) {
-    const uint8_t byte = *(const uint8_t *) NEXT_BYTE(context);
-    
+const op_t *inst_BYTE(vm_context_t *context, const op_t *op) {
     scalar_t a = {0};
-    anon_scalar_set_int_value(&a, byte);
-    vm_ds_push(context, &a);
-    anon_scalar_destroy(&a);
+    anon_scalar_set_int_value(&a, op->m_operand.as_int);
+    vm_ds_give(context, &a);
     
-    return 1 + sizeof(byte);
+    return op + 1;
 }
 
 
@@ -1625,15 +1692,12 @@ bytecode following the integer value.
 
 =cut
 */
-int inst_INT(vm_context_t *context) {
-    const intptr_t lit = *(const intptr_t *) NEXT_BYTE(context);
-    
+const op_t *inst_INT(vm_context_t *context, const op_t *op) {
     scalar_t a = {0};
-    anon_scalar_set_int_value(&a, lit);
-    vm_ds_push(context, &a);
-    anon_scalar_destroy(&a);
+    anon_scalar_set_int_value(&a, op->m_operand.as_int);
+    vm_ds_give(context, &a);
     
-    return 1 + sizeof(intptr_t);
+    return op + 1;
 }
 
 /*
@@ -1643,9 +1707,10 @@ Pops two values from the data stack, and pushes back their integer sum.
  
 =cut
  */
-int inst_ADD(vm_context_t *context) {
+const op_t *inst_ADD(vm_context_t *context, const op_t *op) {
+    BYTECODE_QUICKEN(op, BYTECODE_DS_IS_INT(context, 0) && BYTECODE_DS_IS_INT(context, 1), i_ADD_INT_INT);
     BYTECODE_NUMERIC_OP(int, +);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1655,9 +1720,10 @@ Pops two values from the data stack, and pushes back their integer difference.
 
 =cut
  */
-int inst_SUBT(vm_context_t *context) {
+const op_t *inst_SUBT(vm_context_t *context, const op_t *op) {
+    BYTECODE_QUICKEN(op, BYTECODE_DS_IS_INT(context, 0) && BYTECODE_DS_IS_INT(context, 1), i_SUBT_INT_INT);
     BYTECODE_NUMERIC_OP(int, -);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1667,9 +1733,10 @@ Pops two values from the data stack, and pushes back their integer product.
 
 =cut
  */
-int inst_MULT(vm_context_t *context) {
+const op_t *inst_MULT(vm_context_t *context, const op_t *op) {
+    BYTECODE_QUICKEN(op, BYTECODE_DS_IS_INT(context, 0) && BYTECODE_DS_IS_INT(context, 1), i_MULT_INT_INT);
     BYTECODE_NUMERIC_OP(int, *);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1679,9 +1746,9 @@ Pops two values from the data stack, and pushes back their integer quotient.
 
 =cut
  */
-int inst_DIV(vm_context_t *context) {
+const op_t *inst_DIV(vm_context_t *context, const op_t *op) {
     BYTECODE_NUMERIC_OP(int, /);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1691,9 +1758,9 @@ Pops two values from the data stack, and pushes back their integer remainder.
  
 =cut
  */
-int inst_MOD(vm_context_t *context) {
+const op_t *inst_MOD(vm_context_t *context, const op_t *op) {
     BYTECODE_NUMERIC_OP(int, %);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1703,14 +1770,15 @@ Pops a value, and pushes back 1 if the value is less than zero, or 0 otherwise.
 
 =cut
  */
-int inst_LT0(struct vm_context_t *context) {
+const op_t *inst_LT0(vm_context_t *context, const op_t *op) {
+    BYTECODE_QUICKEN(op, BYTECODE_DS_IS_INT(context, 0), i_LT0_INT);
+
     scalar_t a = {0}, b = {0};
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &a);
     anon_scalar_set_int_value(&b, (anon_scalar_get_int_value(&a) < 0));
-    vm_ds_push(context, &b);
-    anon_scalar_destroy(&b);
+    vm_ds_give(context, &b);
     anon_scalar_destroy(&a);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1720,14 +1788,15 @@ Pops a value, and pushes back 1 if the value is greater than zero, or 0 otherwis
 
 =cut
  */
-int inst_GT0(struct vm_context_t *context) {
+const op_t *inst_GT0(vm_context_t *context, const op_t *op) {
+    BYTECODE_QUICKEN(op, BYTECODE_DS_IS_INT(context, 0), i_GT0_INT);
+
     scalar_t a = {0}, b = {0};
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &a);
     anon_scalar_set_int_value(&b, (anon_scalar_get_int_value(&a) > 0));
-    vm_ds_push(context, &b);
-    anon_scalar_destroy(&b);
+    vm_ds_give(context, &b);
     anon_scalar_destroy(&a);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1737,14 +1806,15 @@ Pops a value, and pushes back the same value incremented by 1.
 
 =cut
  */
-int inst_INCR(struct vm_context_t *context) {
+const op_t *inst_INCR(vm_context_t *context, const op_t *op) {
+    BYTECODE_QUICKEN(op, BYTECODE_DS_IS_INT(context, 0), i_INCR_INT);
+
     scalar_t a = {0}, b = {0};
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &a);
     anon_scalar_set_int_value(&b, anon_scalar_get_int_value(&a) + 1);
-    vm_ds_push(context, &b);
-    anon_scalar_destroy(&b);
+    vm_ds_give(context, &b);
     anon_scalar_destroy(&a);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1754,14 +1824,15 @@ Pops a value, and pushes back the same value decremented by 1.
 
 =cut
  */
-int inst_DECR(struct vm_context_t *context) {
+const op_t *inst_DECR(vm_context_t *context, const op_t *op) {
+    BYTECODE_QUICKEN(op, BYTECODE_DS_IS_INT(context, 0), i_DECR_INT);
+
     scalar_t a = {0}, b = {0};
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &a);
     anon_scalar_set_int_value(&b, anon_scalar_get_int_value(&a) - 1);
-    vm_ds_push(context, &b);
-    anon_scalar_destroy(&b);
+    vm_ds_give(context, &b);
     anon_scalar_destroy(&a);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1779,27 +1850,14 @@ The length is encoded as a single unsigned byte, so the maximum length of the st
 
 =cut
 */
-int inst_STR(struct vm_context_t *context) {
-    const uint8_t len = *(uint8_t *) (&context->m_bytecode[context->m_counter + 1]);
-    const char *str = (const char *) (&context->m_bytecode[context->m_counter + 1 + sizeof(len)]);
-    
+const op_t *inst_STR(vm_context_t *context, const op_t *op) {
     scalar_t s = {0};
     
-    if (len > 0) {
-        string_t *buf = string_alloc(len, str);
-        anon_scalar_set_string_value(&s, buf);
-        string_free(buf);
-    }
-    else {
-        string_t *buf = string_alloc(0, NULL);
-        anon_scalar_set_string_value(&s, buf);
-        string_free(buf);
-    }
+    anon_scalar_set_string_value(&s, op->m_operand.as_string);
 
-    vm_ds_push(context, &s);
-    anon_scalar_destroy(&s);
+    vm_ds_give(context, &s);
     
-    return 1 + sizeof(len) + len;
+    return op + 1;
 }
 
 
@@ -1817,27 +1875,14 @@ bytecode.
 The length is encoded as an unsigned four byte value, so the maximum length of the string is a big as your mom.
 =cut
  */
-int inst_STRING(struct vm_context_t *context) {
-    const uint32_t len = *(uint32_t *) (&context->m_bytecode[context->m_counter + 1]);
-    const char *str = (const char *) (&context->m_bytecode[context->m_counter + 1 + sizeof(len)]);
-    
+const op_t *inst_STRING(vm_context_t *context, const op_t *op) {
     scalar_t s = {0};
     
-    if (len > 0) {
-        string_t *buf = string_alloc(len, str);
-        anon_scalar_set_string_value(&s, buf);
-        string_free(buf);
-    }
-    else {
-        string_t *buf = string_alloc(0, NULL);
-        anon_scalar_set_string_value(&s, buf);
-        string_free(buf);
-    }
+    anon_scalar_set_string_value(&s, op->m_operand.as_string);
 
-    vm_ds_push(context, &s);
-    anon_scalar_destroy(&s);
+    vm_ds_give(context, &s);
     
-    return 1 + sizeof(len) + len;
+    return op + 1;
 }
 
 /*
@@ -1847,18 +1892,18 @@ Pops a string from the stack, and pushes back its length.
 
 =cut
 */
-int inst_LEN(struct vm_context_t *context) {
+const op_t *inst_LEN(vm_context_t *context, const op_t *op) {
     scalar_t s = {0};
-    string_t *str;
+    size_t length;
     
-    vm_ds_pop(context, &s);
-    anon_scalar_get_string_value(&s, &str);
-    anon_scalar_set_int_value(&s, string_length(str));
-    vm_ds_push(context, &s);
+    vm_ds_take(context, &s);
+    length = anon_scalar_get_string_length(&s);
+    anon_scalar_set_int_value(&s, length);
+    vm_ds_give(context, &s);
     
     anon_scalar_destroy(&s);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1868,27 +1913,27 @@ Pops a string from the stack, and pushes back a scalar for each character within
 
 =cut
 */
-int inst_XPLOD(struct vm_context_t *context) {
+const op_t *inst_XPLOD(vm_context_t *context, const op_t *op) {
     scalar_t s = {0}, *characters = NULL, count = {0};
     string_t *str = NULL;
+    const char *bytes;
+    size_t n;
     
-    vm_ds_pop(context, &s);
+    vm_ds_take(context, &s);
     
-    anon_scalar_get_string_value(&s, &str);
-    size_t n = string_length(str);
+    if (NULL == (bytes = anon_scalar_get_string_bytes(&s, &n))) {
+        anon_scalar_get_string_value(&s, &str);
+        bytes = string_cstr(str);
+        n = string_length(str);
+    }
     
     if (n > 0) {
         if (NULL != (characters = calloc(n, sizeof(*characters)))) {
-            string_t *buf = string_alloc(1, NULL);
+            // n.b. single characters are short strings, so this doesn't allocate
             for (size_t i = 0; i < n; i++) {
-                string_assign(&buf, 1, &str->m_bytes[i]);
-                anon_scalar_set_string_value(&characters[i], buf);
-
+                anon_scalar_set_string_bytes(&characters[i], 1, &bytes[i]);
             }
-            string_free(buf);
-            vm_ds_npush(context, n, characters);
-
-            for (size_t i = 0; i < n; i++)  anon_scalar_destroy(&characters[i]);
+            vm_ds_ngive(context, n, characters);
             free(characters);
         }
         else {
@@ -1901,12 +1946,12 @@ int inst_XPLOD(struct vm_context_t *context) {
     
     anon_scalar_set_int_value(&count, n);
     
-    vm_ds_push(context, &count);
+    vm_ds_give(context, &count);
     
     anon_scalar_destroy(&count);
     anon_scalar_destroy(&s);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1914,49 +1959,227 @@ int inst_XPLOD(struct vm_context_t *context) {
 
 Pops a count and count strings from the data stack, and pushes back their concatenation.
 
+Long results are ropes, which share the strings they're made of instead of copying them, and are only flattened into a
+single string when something needs to look inside them.  Adding more onto the end of one with CAT or SRAPPEND doesn't
+copy what's already there.
+
 =cut
 */
-int inst_CAT(struct vm_context_t *context) {
+const op_t *inst_CAT(vm_context_t *context, const op_t *op) {
     scalar_t count = {0}, s = {0};
     
-    vm_ds_pop(context, &count);
+    vm_ds_take(context, &count);
     size_t n = anon_scalar_get_int_value(&count);
     
     if (n > 0) {
-        string_t **strings;
-        if (NULL != (strings = calloc(n, sizeof(*strings)))) {
-            size_t len = 0;
-            
-            scalar_t tmp = {0};
-            for (size_t i = 0; i < n; i++) {
-                vm_ds_pop(context, &tmp);
-                anon_scalar_get_string_value(&tmp, &strings[i]);
-                len += string_length(strings[i]);
-            }
-            anon_scalar_destroy(&tmp);
-            
-            string_t *result = string_alloc(len, NULL);
-            
+        scalar_t *items;
+        if (NULL != (items = calloc(n, sizeof(*items)))) {
             for (size_t i = 0; i < n; i++) {
-                string_append(&result, string_length(strings[i]), string_cstr(strings[i]));
-                string_free(strings[i]);
+                vm_ds_take(context, &items[i]);
             }
-            free(strings);
-            
-            anon_scalar_set_string_value(&s, result);
-            string_free(result);
+            anon_scalar_concatenate(&s, n, items);
+            free(items);
         }
         else {
             debug("calloc failed\n");
         }
     }
     
-    vm_ds_push(context, &s);
+    vm_ds_give(context, &s);
     
     anon_scalar_destroy(&s);
     anon_scalar_destroy(&count);
     
-    return 1;
+    return op + 1;
+}
+
+/*
+=item INDEX ( s needle start -- position )
+
+Pops a start position, a needle and a string from the data stack.  Pushes back the position of the first occurrence
+of the needle within the string at or after the start position, or undefined if there isn't one (or the start
+position is outside the string).  Positions are counted in bytes from zero.
+
+=cut
+*/
+const op_t *inst_INDEX(vm_context_t *context, const op_t *op) {
+    scalar_t s = {0}, needle = {0}, start = {0}, position = {0};
+    
+    vm_ds_take(context, &start);
+    vm_ds_take(context, &needle);
+    vm_ds_take(context, &s);
+    
+    char buffer[SCALAR_FORMAT_BUFFER_SIZE], needle_buffer[SCALAR_FORMAT_BUFFER_SIZE];
+    size_t length, needle_length;
+    const char *bytes = anon_scalar_format(&s, buffer, &length);
+    const char *needle_bytes = anon_scalar_format(&needle, needle_buffer, &needle_length);
+    const intptr_t from = anon_scalar_get_int_value(&start);
+    
+    if (from >= 0 && (size_t) from <= length) {
+        const char *found = search_bytes(bytes + from, length - from, needle_bytes, needle_length);
+        if (found)  anon_scalar_set_int_value(&position, found - bytes);
+    }
+    
+    vm_ds_give(context, &position);
+    
+    anon_scalar_destroy(&position);
+    anon_scalar_destroy(&start);
+    anon_scalar_destroy(&needle);
+    anon_scalar_destroy(&s);
+    
+    return op + 1;
+}
+
+/*
+=item SPLIT ( s delimiter -- [fields] count )
+
+Pops a delimiter and a string from the data stack, and pushes back the fields of the string separated by the
+delimiter, and the count.  The fields are pushed in the same order as XPLOD pushes characters, so the first field ends
+up just below the count.
+
+A string delimiter separates fields wherever it occurs, and adjacent delimiters have an empty field between them.  An
+empty string delimiter splits the string into characters.  Otherwise the delimiter is a byte value, as for CHOMP, and
+DELIMITER_WHITESPACE separates fields by runs of whitespace, ignoring any at the start or end of the string.  An empty
+string has no fields.
+
+The fields share the string's bytes where they can, so splitting a long line doesn't copy it.
+
+=cut
+*/
+const op_t *inst_SPLIT(vm_context_t *context, const op_t *op) {
+    scalar_t s = {0}, delimiter = {0}, count = {0}, *fields = NULL;
+    size_t n = 0, allocated = 0;
+    
+    vm_ds_take(context, &delimiter);
+    vm_ds_take(context, &s);
+    
+    char buffer[SCALAR_FORMAT_BUFFER_SIZE], delimiter_buffer[SCALAR_FORMAT_BUFFER_SIZE];
+    size_t length, delimiter_length, pos = 0;
+    const char *bytes = anon_scalar_format(&s, buffer, &length);
+    
+    if (anon_scalar_type(&delimiter) != SCALAR_STRING
+        && anon_scalar_get_int_value(&delimiter) == DELIMITER_WHITESPACE) {
+        search_class_t whitespace;
+        search_class_init(&whitespace, SEARCH_WHITESPACE, strlen(SEARCH_WHITESPACE));
+        
+        const char *start;
+        while (NULL != (start = search_class_first_not(&whitespace, bytes + pos, length - pos))) {
+            const char *end = search_class_first(&whitespace, start, bytes + length - start);
+            if (end == NULL)  end = bytes + length;
+            if (0 != _bytecode_split_field(&fields, &n, &allocated, &s, start - bytes, end - start))  break;
+            pos = end - bytes;
+        }
+    }
+    else if (length > 0) {
+        const char *delimiter_bytes;
+        char c;
+        
+        if (anon_scalar_type(&delimiter) == SCALAR_STRING) {
+            delimiter_bytes = anon_scalar_format(&delimiter, delimiter_buffer, &delimiter_length);
+        }
+        else {
+            c = (char) anon_scalar_get_int_value(&delimiter);
+            delimiter_bytes = &c;
+            delimiter_length = 1;
+        }
+        
+        for (;;) {
+            const char *found = (delimiter_length > 0
+                ? search_bytes(bytes + pos, length - pos, delimiter_bytes, delimiter_length)
+                : (pos + 1 < length ? bytes + pos + 1 : NULL));
+            const size_t end = (found ? (size_t) (found - bytes) : length);
+            if (0 != _bytecode_split_field(&fields, &n, &allocated, &s, pos, end - pos))  break;
+            if (found == NULL)  break;
+            pos = end + delimiter_length;
+        }
+    }
+    
+    if (n > 0)  vm_ds_ngive(context, n, fields);
+    free(fields);
+    
+    anon_scalar_set_int_value(&count, n);
+    
+    vm_ds_give(context, &count);
+    
+    anon_scalar_destroy(&count);
+    anon_scalar_destroy(&delimiter);
+    anon_scalar_destroy(&s);
+    
+    return op + 1;
+}
+
+/*
+=item SCAN ( s class start -- position )
+
+=item SPAN ( s class start -- position )
+
+Pop a start position, a class and a string from the data stack.  The class is a string containing a set of bytes.
+SCAN pushes back the position of the first byte at or after the start position that is in the class, and SPAN the
+position of the first one that isn't, or undefined if there isn't one (or the start position is outside the string).
+
+Together these step through a string a token at a time: SPAN skips the separators before a token, and SCAN finds its
+end.
+
+=cut
+*/
+const op_t *inst_SCAN(vm_context_t *context, const op_t *op) {
+    scalar_t s = {0}, class = {0}, start = {0}, position = {0};
+    
+    vm_ds_take(context, &start);
+    vm_ds_take(context, &class);
+    vm_ds_take(context, &s);
+    
+    char buffer[SCALAR_FORMAT_BUFFER_SIZE], class_buffer[SCALAR_FORMAT_BUFFER_SIZE];
+    size_t length, class_length;
+    const char *bytes = anon_scalar_format(&s, buffer, &length);
+    const char *class_bytes = anon_scalar_format(&class, class_buffer, &class_length);
+    const intptr_t from = anon_scalar_get_int_value(&start);
+    
+    if (from >= 0 && (size_t) from <= length) {
+        search_class_t set;
+        search_class_init(&set, class_bytes, class_length);
+        const char *found = search_class_first(&set, bytes + from, length - from);
+        if (found)  anon_scalar_set_int_value(&position, found - bytes);
+    }
+    
+    vm_ds_give(context, &position);
+    
+    anon_scalar_destroy(&position);
+    anon_scalar_destroy(&start);
+    anon_scalar_destroy(&class);
+    anon_scalar_destroy(&s);
+    
+    return op + 1;
+}
+
+const op_t *inst_SPAN(vm_context_t *context, const op_t *op) {
+    scalar_t s = {0}, class = {0}, start = {0}, position = {0};
+    
+    vm_ds_take(context, &start);
+    vm_ds_take(context, &class);
+    vm_ds_take(context, &s);
+    
+    char buffer[SCALAR_FORMAT_BUFFER_SIZE], class_buffer[SCALAR_FORMAT_BUFFER_SIZE];
+    size_t length, class_length;
+    const char *bytes = anon_scalar_format(&s, buffer, &length);
+    const char *class_bytes = anon_scalar_format(&class, class_buffer, &class_length);
+    const intptr_t from = anon_scalar_get_int_value(&start);
+    
+    if (from >= 0 && (size_t) from <= length) {
+        search_class_t set;
+        search_class_init(&set, class_bytes, class_length);
+        const char *found = search_class_first_not(&set, bytes + from, length - from);
+        if (found)  anon_scalar_set_int_value(&position, found - bytes);
+    }
+    
+    vm_ds_give(context, &position);
+    
+    anon_scalar_destroy(&position);
+    anon_scalar_destroy(&start);
+    anon_scalar_destroy(&class);
+    anon_scalar_destroy(&s);
+    
+    return op + 1;
 }
 
 /*
@@ -1966,15 +2189,12 @@ Reads a floating point literal from the following bytecode and pushes it onto th
  
 =cut
  */
-int inst_FLOAT(struct vm_context_t *context) {
-    const floatptr_t lit = *(const floatptr_t *) (&context->m_bytecode[context->m_counter + 1]);
-    
+const op_t *inst_FLOAT(vm_context_t *context, const op_t *op) {
     scalar_t a = {0};
-    anon_scalar_set_float_value(&a, lit);
-    vm_ds_push(context, &a);
-    anon_scalar_destroy(&a);
+    anon_scalar_set_float_value(&a, op->m_operand.as_float);
+    vm_ds_give(context, &a);
     
-    return 1 + sizeof(lit);
+    return op + 1;
 }
 
 /*
@@ -1984,9 +2204,9 @@ Pops two floating point values from the data stack and pushes back their sum
 
 =cut
  */
-int inst_ADDF(struct vm_context_t *context) {
+const op_t *inst_ADDF(vm_context_t *context, const op_t *op) {
     BYTECODE_NUMERIC_OP(float, +);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -1996,9 +2216,9 @@ Pops two floating point values from the data stack and pushes back their differe
 
 =cut
  */
-int inst_SUBTF(struct vm_context_t *context) {
+const op_t *inst_SUBTF(vm_context_t *context, const op_t *op) {
     BYTECODE_NUMERIC_OP(float, -);
-    return 1;    
+    return op + 1;    
 }
 
 /*
@@ -2008,9 +2228,9 @@ Pops two floating point values from the data stack and pushes back their product
 
 =cut
  */
-int inst_MULTF(struct vm_context_t *context) {
+const op_t *inst_MULTF(vm_context_t *context, const op_t *op) {
     BYTECODE_NUMERIC_OP(float, *);
-    return 1;    
+    return op + 1;    
 }
 
 /*
@@ -2020,9 +2240,9 @@ Pops two floating point values from the data stack and pushes back their quotien
 
 =cut
  */
-int inst_DIVF(struct vm_context_t *context) {
+const op_t *inst_DIVF(vm_context_t *context, const op_t *op) {
     BYTECODE_NUMERIC_OP(float, /);
-    return 1;    
+    return op + 1;    
 }
 
 /*
@@ -2032,19 +2252,19 @@ Pops two floating point values from the data stack and pushes back their remaind
 
 =cut
  */
-int inst_MODF(struct vm_context_t *context) {
+const op_t *inst_MODF(vm_context_t *context, const op_t *op) {
     scalar_t a = {0}, b = {0}, c = {0};
     
-    vm_ds_pop(context, &b);
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &b);
+    vm_ds_take(context, &a);
     anon_scalar_set_float_value(&c, fmod(anon_scalar_get_float_value(&a), anon_scalar_get_float_value(&b)));
-    vm_ds_push(context, &c);
+    vm_ds_give(context, &c);
     
     anon_scalar_destroy(&c);
     anon_scalar_destroy(&b);
     anon_scalar_destroy(&a);
     
-    return 1;    
+    return op + 1;    
 }
 
 /*
@@ -2054,14 +2274,13 @@ Pops a floating point value and pushes back 1 if it is less than zero, or 0 othe
 
 =cut
  */
-int inst_LT0F(struct vm_context_t *context) {
+const op_t *inst_LT0F(vm_context_t *context, const op_t *op) {
     scalar_t a = {0}, b = {0};
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &a);
     anon_scalar_set_int_value(&b, (anon_scalar_get_float_value(&a) < 0));
-    vm_ds_push(context, &b);
-    anon_scalar_destroy(&b);
+    vm_ds_give(context, &b);
     anon_scalar_destroy(&a);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -2071,14 +2290,13 @@ Pops a floating point value and pushes back 1 if it is greater than zero, or 0 o
 
 =cut
  */
-int inst_GT0F(struct vm_context_t *context) {
+const op_t *inst_GT0F(vm_context_t *context, const op_t *op) {
     scalar_t a = {0}, b = {0};
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &a);
     anon_scalar_set_int_value(&b, (anon_scalar_get_float_value(&a) > 0));
-    vm_ds_push(context, &b);
-    anon_scalar_destroy(&b);
+    vm_ds_give(context, &b);
     anon_scalar_destroy(&a);
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -2088,15 +2306,12 @@ Reads a function reference literal from the following bytecode and pushes it ont
 
 =cut
  */
-int inst_FUNLIT(struct vm_context_t *context) {
-    const function_handle_t lit = *(const function_handle_t *) (&context->m_bytecode[context->m_counter + 1]);
-    
+const op_t *inst_FUNLIT(vm_context_t *context, const op_t *op) {
     scalar_t a = {0};
-    anon_scalar_set_function_reference(&a, lit);
-    vm_ds_push(context, &a);
-    anon_scalar_destroy(&a);
+    anon_scalar_set_function_reference(&a, op->m_operand.as_function);
+    vm_ds_give(context, &a);
     
-    return 1 + sizeof(lit);
+    return op + 1;
 }
 
 /*
@@ -2109,15 +2324,15 @@ FIXME write something about flags and path format here.
 
 =cut
 */
-int inst_OPEN(struct vm_context_t *context) {
-    const flags8_t flags = *(const flags8_t *) (&context->m_bytecode[context->m_counter + 1]);
+const op_t *inst_OPEN(vm_context_t *context, const op_t *op) {
+    const flags8_t flags = BYTECODE_OP_FLAGS(op);
     
     scalar_t stream = {0}, path = {0};
     
-    vm_ds_pop(context, &stream);
-    assert((stream.m_flags & SCALAR_TYPE_MASK) == SCALAR_STRMREF);
+    vm_ds_take(context, &stream);
+    assert(anon_scalar_type(&stream) == SCALAR_STRMREF);
     
-    vm_ds_pop(context, &path);
+    vm_ds_take(context, &path);
     string_t *s; 
     anon_scalar_get_string_value(&path, &s);
     
@@ -2128,14 +2343,14 @@ int inst_OPEN(struct vm_context_t *context) {
         debug("failed to open stream\n");
     }
 
-    assert((stream.m_flags & SCALAR_TYPE_MASK) == SCALAR_STRMREF);
-    vm_ds_push(context, &stream);
+    assert(anon_scalar_type(&stream) == SCALAR_STRMREF);
+    vm_ds_give(context, &stream);
     
     anon_scalar_destroy(&stream);
     anon_scalar_destroy(&path);
     string_free(s);
     
-    return 1 + sizeof(flags);
+    return op + 1;
 }
 
 /*
@@ -2145,17 +2360,17 @@ Pops a stream reference from the stack and closes the underlying stream.
 
 =cut
 */
-int inst_CLOSE(struct vm_context_t *context) {
+const op_t *inst_CLOSE(vm_context_t *context, const op_t *op) {
     scalar_t stream = {0};
     
-    vm_ds_pop(context, &stream);
-    assert((stream.m_flags & SCALAR_TYPE_MASK) == SCALAR_STRMREF);
+    vm_ds_take(context, &stream);
+    assert(anon_scalar_type(&stream) == SCALAR_STRMREF);
     
     stream_close(anon_scalar_deref_stream_reference(&stream));
     
     anon_scalar_destroy(&stream);
 
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -2165,22 +2380,28 @@ Pops a stream reference and a scalar value from from the stack, and prints the v
 
 =cut
  */
-int inst_OUT(struct vm_context_t *context) {
+const op_t *inst_OUT(vm_context_t *context, const op_t *op) {
     scalar_t value = {0}, stream = {0};
     
-    vm_ds_pop(context, &stream);
-    assert((stream.m_flags & SCALAR_TYPE_MASK) == SCALAR_STRMREF);
+    vm_ds_take(context, &stream);
+    assert(anon_scalar_type(&stream) == SCALAR_STRMREF);
     
-    vm_ds_pop(context, &value);
-    string_t *str;
-    anon_scalar_get_string_value(&value, &str);
-    stream_write(anon_scalar_deref_stream_reference(&stream), str);
-    string_free(str);
+    vm_ds_take(context, &value);
+    const rope_t *rope = anon_scalar_get_rope(&value);
+    if (rope != NULL) {
+        stream_write_rope(anon_scalar_deref_stream_reference(&stream), rope);
+    }
+    else {
+        char buffer[SCALAR_FORMAT_BUFFER_SIZE];
+        size_t length;
+        const char *bytes = anon_scalar_format(&value, buffer, &length);
+        stream_write_bytes(anon_scalar_deref_stream_reference(&stream), bytes, length);
+    }
     
     anon_scalar_destroy(&value);
     anon_scalar_destroy(&stream);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -2191,26 +2412,45 @@ the delimiter to the stream.
 
 =cut
  */
-int inst_OUTL(struct vm_context_t *context) {
+const op_t *inst_OUTL(vm_context_t *context, const op_t *op) {
     scalar_t string = {0}, delimiter = {0}, stream = {0};
     
-    vm_ds_pop(context, &stream);
-    assert((stream.m_flags & SCALAR_TYPE_MASK) == SCALAR_STRMREF);
+    vm_ds_take(context, &stream);
+    assert(anon_scalar_type(&stream) == SCALAR_STRMREF);
     
-    vm_ds_pop(context, &delimiter);
-    vm_ds_pop(context, &string);
+    vm_ds_take(context, &delimiter);
+    vm_ds_take(context, &string);
     
-    string_t *str;
-    anon_scalar_get_string_value(&string, &str);
-    string_appendc(&str, anon_scalar_get_int_value(&delimiter));
-    stream_write(anon_scalar_deref_stream_reference(&stream), str);
-    string_free(str);
+    if (anon_scalar_get_rope(&string) != NULL) {
+        // n.b. the rope is ours now, so unless it's shared this adds the delimiter in place
+        const char d = (char) anon_scalar_get_int_value(&delimiter);
+        anon_scalar_append_bytes(&string, 1, &d);
+        stream_write_rope(anon_scalar_deref_stream_reference(&stream), anon_scalar_get_rope(&string));
+    }
+    else {
+        char buffer[SCALAR_FORMAT_BUFFER_SIZE];
+        size_t length;
+        const char *bytes = anon_scalar_format(&string, buffer, &length);
+        if (length < sizeof(buffer)) {
+            // short enough to add the delimiter without allocating
+            if (bytes != buffer)  memcpy(buffer, bytes, length);
+            buffer[length++] = (char) anon_scalar_get_int_value(&delimiter);
+            stream_write_bytes(anon_scalar_deref_stream_reference(&stream), buffer, length);
+        }
+        else {
+            string_t *str;
+            anon_scalar_get_string_value(&string, &str);
+            string_appendc(&str, anon_scalar_get_int_value(&delimiter));
+            stream_write(anon_scalar_deref_stream_reference(&stream), str);
+            string_free(str);
+        }
+    }
     
     anon_scalar_destroy(&string);
     anon_scalar_destroy(&delimiter);
     anon_scalar_destroy(&stream);
 
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -2221,13 +2461,13 @@ the value read.
 
 =cut
  */
-int inst_IN(struct vm_context_t *context) {
+const op_t *inst_IN(vm_context_t *context, const op_t *op) {
     scalar_t len = {0}, stream = {0}, value = {0};
     
-    vm_ds_pop(context, &stream);
-    assert((stream.m_flags & SCALAR_TYPE_MASK) == SCALAR_STRMREF);
+    vm_ds_take(context, &stream);
+    assert(anon_scalar_type(&stream) == SCALAR_STRMREF);
     
-    vm_ds_pop(context, &len);
+    vm_ds_take(context, &len);
     size_t n = anon_scalar_get_int_value(&len);
     
     if (n > 0) {
@@ -2236,13 +2476,13 @@ int inst_IN(struct vm_context_t *context) {
         string_free(str);
     }
     
-    vm_ds_push(context, &value);
+    vm_ds_give(context, &value);
 
     anon_scalar_destroy(&value);
     anon_scalar_destroy(&len);
     anon_scalar_destroy(&stream);
 
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -2253,13 +2493,13 @@ the delimiter, and pushes back the value read.
 
 =cut
 */
-int inst_INL(struct vm_context_t *context) {
+const op_t *inst_INL(vm_context_t *context, const op_t *op) {
     scalar_t delimiter = {0}, stream = {0}, value = {0};
     
-    vm_ds_pop(context, &stream);
-    assert((stream.m_flags & SCALAR_TYPE_MASK) == SCALAR_STRMREF);
+    vm_ds_take(context, &stream);
+    assert(anon_scalar_type(&stream) == SCALAR_STRMREF);
     
-    vm_ds_pop(context, &delimiter);
+    vm_ds_take(context, &delimiter);
 
     string_t *str = stream_read_delim(anon_scalar_deref_stream_reference(&stream), anon_scalar_get_int_value(&delimiter));
     
@@ -2268,13 +2508,13 @@ int inst_INL(struct vm_context_t *context) {
         string_free(str);
     }
     
-    vm_ds_push(context, &value);
+    vm_ds_give(context, &value);
     
     anon_scalar_destroy(&value);
     anon_scalar_destroy(&delimiter);
     anon_scalar_destroy(&stream);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -2285,29 +2525,28 @@ Pops a delimiter byte and a scalar from the stack, and pushes back the scalar mi
 =cut
 */
 
-int inst_CHOMP(struct vm_context_t *context) {
+const op_t *inst_CHOMP(vm_context_t *context, const op_t *op) {
     scalar_t s = {0}, delimiter = {0};
     
-    vm_ds_pop(context, &delimiter);
-    vm_ds_pop(context, &s);
+    vm_ds_take(context, &delimiter);
+    vm_ds_take(context, &s);
     
-    if ((s.m_flags & SCALAR_TYPE_MASK) == SCALAR_STRING) {
-        string_chomp(s.m_value.as_string, anon_scalar_get_int_value(&delimiter));
-    }
-    else {
-        string_t *str;
-        anon_scalar_get_string_value(&s, &str);
-        string_chomp(str, anon_scalar_get_int_value(&delimiter));
-        anon_scalar_set_string_value(&s, str);
-        string_free(str);
+    // n.b. the result is a substring of the original, so this doesn't copy it
+    char buffer[SCALAR_FORMAT_BUFFER_SIZE];
+    size_t length;
+    const char *bytes = anon_scalar_format(&s, buffer, &length);
+    const intptr_t d = anon_scalar_get_int_value(&delimiter);
+    if (length > 0 && (bytes[length - 1] == d || (d == DELIMITER_WHITESPACE && isspace((unsigned char) bytes[length - 1])))) {
+        --length;
     }
+    anon_scalar_set_substring(&s, &s, 0, length);
     
-    vm_ds_push(context, &s);
+    vm_ds_give(context, &s);
     
     anon_scalar_destroy(&s);
     anon_scalar_destroy(&delimiter);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -2317,11 +2556,10 @@ Pushes an undefined value to the data stack
 
 =cut
  */
-int inst_UNDEF(struct vm_context_t *context) {
+const op_t *inst_UNDEF(vm_context_t *context, const op_t *op) {
     scalar_t a = {0};
-    vm_ds_push(context, &a);
-    anon_scalar_destroy(&a);
-    return 1;
+    vm_ds_give(context, &a);
+    return op + 1;
 }
 
 /*
@@ -2331,13 +2569,12 @@ Pushes a reference to the stdin stream to the data stack.
 
 =cut
 */
-int inst_STDIN(struct vm_context_t *context) {
+const op_t *inst_STDIN(vm_context_t *context, const op_t *op) {
     scalar_t stream = {0};
     
     anon_scalar_set_stream_reference(&stream, stream_stdin_handle());
-    vm_ds_push(context, &stream);
-    anon_scalar_destroy(&stream);
-    return 1;
+    vm_ds_give(context, &stream);
+    return op + 1;
 }
 
 /*
@@ -2347,13 +2584,12 @@ Pushes a reference to the stdout stream to the data stack.
 
 =cut
 */
-int inst_STDOUT(struct vm_context_t *context) {
+const op_t *inst_STDOUT(vm_context_t *context, const op_t *op) {
     scalar_t stream = {0};
     
     anon_scalar_set_stream_reference(&stream, stream_stdout_handle());
-    vm_ds_push(context, &stream);
-    anon_scalar_destroy(&stream);
-    return 1;
+    vm_ds_give(context, &stream);
+    return op + 1;
 }
 
 /*
@@ -2363,13 +2599,12 @@ Pushes a reference to the stderr stream to the data stack.
 
 =cut
 */
-int inst_STDERR(struct vm_context_t *context) {
+const op_t *inst_STDERR(vm_context_t *context, const op_t *op) {
     scalar_t stream = {0};
     
     anon_scalar_set_stream_reference(&stream, stream_stderr_handle());
-    vm_ds_push(context, &stream);
-    anon_scalar_destroy(&stream);
-    return 1;
+    vm_ds_give(context, &stream);
+    return op + 1;
 }
 
 /*
@@ -2379,23 +2614,21 @@ Pops an integer value from the data stack.  Pushes back a string containing the
 
 =cut
 */
-int inst_CHR(struct vm_context_t *context) {
+const op_t *inst_CHR(vm_context_t *context, const op_t *op) {
     scalar_t i = {0}, a = {0};
-    string_t *str;
+    char c;
     
-    vm_ds_pop(context, &i);
+    vm_ds_take(context, &i);
 
-    str = string_alloc(1, NULL);
-    str->m_bytes[0] = (char) anon_scalar_get_int_value(&i);
-    anon_scalar_set_string_value(&a, str);
-    string_free(str);
+    c = (char) anon_scalar_get_int_value(&i);
+    anon_scalar_set_string_bytes(&a, 1, &c);
     
-    vm_ds_push(context, &a);
+    vm_ds_give(context, &a);
     
     anon_scalar_destroy(&a);
     anon_scalar_destroy(&i);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -2406,22 +2639,28 @@ or undefined if the string is empty.
 
 =cut
 */
-int inst_ORD(struct vm_context_t *context) {
+const op_t *inst_ORD(vm_context_t *context, const op_t *op) {
     scalar_t i = {0}, a = {0};
     string_t *str = NULL;
+    const char *bytes;
+    size_t length;
     
-    vm_ds_pop(context, &a);
+    vm_ds_take(context, &a);
     
-    anon_scalar_get_string_value(&a, &str);
-    if (string_length(str) > 0)  anon_scalar_set_int_value(&i, str->m_bytes[0]);
+    if (NULL == (bytes = anon_scalar_get_string_bytes(&a, &length))) {
+        anon_scalar_get_string_value(&a, &str);
+        bytes = string_cstr(str);
+        length = string_length(str);
+    }
+    if (length > 0)  anon_scalar_set_int_value(&i, bytes[0]);
     string_free(str);
     
-    vm_ds_push(context, &i);
+    vm_ds_give(context, &i);
     
     anon_scalar_destroy(&i);
     anon_scalar_destroy(&a);
     
-    return 1;
+    return op + 1;
 }
 
 /*
@@ -2431,33 +2670,25 @@ Reverses a list of count items on the stack.
 
 =cut
 */
-int inst_REV(vm_context_t *context) {
-    scalar_t count = {0}, *items = NULL;
+const op_t *inst_REV(vm_context_t *context, const op_t *op) {
+    scalar_t count = {0};
     
-    vm_ds_pop(context, &count);
+    vm_ds_take(context, &count);
     size_t n = anon_scalar_get_int_value(&count);
 
-    if (n > 0) {
-        if (NULL != (items = calloc(n, sizeof(*items)))) {
-            vm_ds_npop(context, n, items);
-            
-            for (size_t i = 0; i < n; i++) {
-                vm_ds_push(context, &items[i]);
-                anon_scalar_destroy(&items[i]);
-            }
-            
-            free(items);
-        }
-        else {
-            debug("calloc failed\n");
-            anon_scalar_set_int_value(&count, 0);
+    if (n > 1) {
+        scalar_t *items = vm_ds_peek(context, n - 1);
+
+        for (size_t i = 0; i < n / 2; i++) {
+            scalar_t tmp;
+            memcpy(&tmp, &items[i], sizeof(tmp));
+            memcpy(&items[i], &items[n - 1 - i], sizeof(tmp));
+            memcpy(&items[n - 1 - i], &tmp, sizeof(tmp));
         }
     }
     
-    vm_ds_push(context, &count);
-    
-    anon_scalar_destroy(&count);
-    return 1;
+    vm_ds_give(context, &count);
+    return op + 1;
 }
 
 /*
@@ -2473,22 +2704,559 @@ handler for the signal, respectively.
 
 =cut
 */
-int inst_SIG(vm_context_t *context) {
+const op_t *inst_SIG(vm_context_t *context, const op_t *op) {
     scalar_t sig = {0}, fr = {0};
     
-    vm_ds_pop(context, &fr);
-    assert((fr.m_flags & SCALAR_TYPE_MASK) == SCALAR_FUNCREF);
+    vm_ds_take(context, &fr);
+    assert(anon_scalar_type(&fr) == SCALAR_FUNCREF);
     
-    vm_ds_pop(context, &sig);
+    vm_ds_take(context, &sig);
     
     vm_set_signal_handler(anon_scalar_get_int_value(&sig), anon_scalar_deref_function_reference(&fr));
     
     anon_scalar_destroy(&sig);
     anon_scalar_destroy(&fr);
 
+    return op + 1;
+}
+
+/*
+=back
+
+=head1 QUICKENED INSTRUCTIONS
+
+Some generic instructions check the types of their operands as they execute, and if they find the types they're
+specialised for, rewrite their op in place into a quickened form that skips type dispatch entirely and operates
+directly on the values on the data stack.  Subsequent executions of that op then run the quickened form.
+
+Each quickened form guards its operand types on every execution.  If the guard fails, it rewrites the op back to its
+generic form, marks it OP_FLAG_NO_QUICKEN so that it won't be quickened again, and executes the generic form.  So a
+quickened op always behaves exactly as its generic form would, and polymorphic ops settle on the generic form.
+
+Quickened instructions exist only in the ops of a loaded program.  They have no assembler mnemonic, and the program
+loader rejects them in bytecode.
+
+=over
+
+=item ADD_INT_INT ( a b -- a+b )
+
+=item SUBT_INT_INT ( a b -- a-b )
+
+=item MULT_INT_INT ( a b -- a*b )
+
+Quickened forms of ADD, SUBT and MULT for two integer operands.
+
+=cut
+ */
+const op_t *inst_ADD_INT_INT(vm_context_t *context, const op_t *op) {
+    BYTECODE_INT_INT_OP(i_ADD, +);
+    return op + 1;
+}
+
+const op_t *inst_SUBT_INT_INT(vm_context_t *context, const op_t *op) {
+    BYTECODE_INT_INT_OP(i_SUBT, -);
+    return op + 1;
+}
+
+const op_t *inst_MULT_INT_INT(vm_context_t *context, const op_t *op) {
+    BYTECODE_INT_INT_OP(i_MULT, *);
+    return op + 1;
+}
+
+/*
+=item LT0_INT ( a -- b )
+
+=item GT0_INT ( a -- b )
+
+Quickened forms of LT0 and GT0 for an integer operand.
+
+=cut
+ */
+const op_t *inst_LT0_INT(vm_context_t *context, const op_t *op) {
+    BYTECODE_INT_GUARD(1, i_LT0);
+    anon_scalar_put_int(&BYTECODE_DS_ITEM(context, 0), anon_scalar_int(&BYTECODE_DS_ITEM(context, 0)) < 0);
+    return op + 1;
+}
+
+const op_t *inst_GT0_INT(vm_context_t *context, const op_t *op) {
+    BYTECODE_INT_GUARD(1, i_GT0);
+    anon_scalar_put_int(&BYTECODE_DS_ITEM(context, 0), anon_scalar_int(&BYTECODE_DS_ITEM(context, 0)) > 0);
+    return op + 1;
+}
+
+/*
+=item INCR_INT ( a -- b )
+
+=item DECR_INT ( a -- b )
+
+Quickened forms of INCR and DECR for an integer operand.
+
+=cut
+ */
+const op_t *inst_INCR_INT(vm_context_t *context, const op_t *op) {
+    BYTECODE_INT_GUARD(1, i_INCR);
+    anon_scalar_put_int(&BYTECODE_DS_ITEM(context, 0), anon_scalar_int(&BYTECODE_DS_ITEM(context, 0)) + 1);
+    return op + 1;
+}
+
+const op_t *inst_DECR_INT(vm_context_t *context, const op_t *op) {
+    BYTECODE_INT_GUARD(1, i_DECR);
+    anon_scalar_put_int(&BYTECODE_DS_ITEM(context, 0), anon_scalar_int(&BYTECODE_DS_ITEM(context, 0)) - 1);
+    return op + 1;
+}
+
+/*
+=item JMP0_INT ( a -- )
+
+Quickened form of JMP0 for an integer operand.
+
+=cut
+ */
+const op_t *inst_JMP0_INT(vm_context_t *context, const op_t *op) {
+    BYTECODE_INT_GUARD(1, i_JMP0);
+
+    const intptr_t a = anon_scalar_int(&BYTECODE_DS_ITEM(context, 0));
+    anon_scalar_init(&BYTECODE_DS_ITEM(context, 0));
+    --BYTECODE_DS_COUNT(context);
+
+    return (a == 0 ? op->m_target : op + 1);
+}
+
+/*
+=back
+
+=head1 DISPATCH
+
+=over
+
+=item bytecode_execute()
+
+Executes ops from the context's current position until one of them terminates the context, which END does by
+returning no next op.  Each handler otherwise returns the next op to execute: op + 1 to fall through, or a pre-resolved
+target for jumps and calls.
+
+By default (with gcc or clang) this is a direct-threaded loop using computed goto: each op records the address of its
+body within the loop (see bytecode_handler()), and every body ends with its own indirect jump to the next op's body,
+rather than all instructions sharing a single jump at the top of a switch.  The handlers are in this file so the
+compiler can inline them into the loop.  Building with -DBYTECODE_SWITCH_DISPATCH (make DISPATCH=switch) selects the
+portable switch-based loop instead.
+
+The current position is only written back to the context when a signal handler needs to be called.
+
+The threaded loop also caches up to two integers from the top of the data stack in local variables (tos0 being the
+top, then tos1), which the compiler can keep in registers.  The instructions in BYTECODE_TOS_LIST have bodies in the
+loop that work on the cached values directly: the literal pushes, DUP, DROP and SWAP, the quickened integer forms, and
+the instructions that don't touch the data stack at all.  They only fill the cache from the data stack when they need
+more operands than are cached, and only spill to it when a push would overflow the cache.  Every other instruction
+spills the whole cache before running its handler, as does a pending signal, so the data stack is always complete
+whenever anything other than the loop looks at it.  Only integers are cached, so spilled values need no cloning and
+dropped ones no destroying: a cached body that finds anything else on the stack spills and falls back to the handler.
+Building with -DBYTECODE_NO_TOS_CACHE (make TOS_CACHE=no) disables this.
+
+Returns 0 when the context ended normally.  The switch-based loop also returns -1 if it encounters an invalid
+instruction, which the program loader should already have rejected.
+
+As a special case, calling this with a NULL context just prepares the table used by bytecode_handler().
+
+=cut
+ */
+#ifdef BYTECODE_THREADED_DISPATCH
+static const void *const *_bytecode_dispatch_table = NULL;
+#endif
+
+int bytecode_execute(vm_context_t *context) {
+#ifdef BYTECODE_THREADED_DISPATCH
+    #define BYTECODE_LABEL(name)    &&do_##name,
+    static const void *const dispatch_table[] = { INSTRUCTION_LIST(BYTECODE_LABEL) };
+    #undef BYTECODE_LABEL
+
+#ifdef BYTECODE_TOS_CACHE
+    #define BYTECODE_TOS_LIST(X)                                                    \
+        X(JMP) X(CALL) X(RETURN) X(DROP) X(SWAP) X(DUP) X(BYTE) X(INT)              \
+        X(ADD_INT_INT) X(SUBT_INT_INT) X(MULT_INT_INT) X(LT0_INT) X(GT0_INT)        \
+        X(INCR_INT) X(DECR_INT) X(JMP0_INT)
+
+    if (context == NULL) {
+        static const void *tos_dispatch_table[i__MAX];
+        memcpy(tos_dispatch_table, dispatch_table, sizeof(tos_dispatch_table));
+
+        #define BYTECODE_TOS_LABEL(name)    tos_dispatch_table[i_##name] = &&tos_##name;
+        BYTECODE_TOS_LIST(BYTECODE_TOS_LABEL)
+        #undef BYTECODE_TOS_LABEL
+
+        _bytecode_dispatch_table = tos_dispatch_table;
+        return 0;
+    }
+
+    const op_t *op = context->m_counter;
+    assert(op != NULL);
+
+    size_t tos_count = 0;
+    intptr_t tos0 = 0, tos1 = 0;
+
+    #define BYTECODE_TOS_SPILL() do {                                               \
+        if (tos_count > 0) {                                                        \
+            _bytecode_tos_spill(context, tos_count, tos0, tos1);                    \
+            tos_count = 0;                                                          \
+        }                                                                           \
+    } while (0)
+
+    #define BYTECODE_TOS_PUSH(value) do {                                           \
+        if (tos_count == 2)  _bytecode_tos_spill(context, 1, tos1, 0);              \
+        else  ++tos_count;                                                          \
+        tos1 = tos0;                                                                \
+        tos0 = (value);                                                             \
+    } while (0)
+
+    #define BYTECODE_TOS_DROP() do {                                                \
+        tos0 = tos1;                                                                \
+        --tos_count;                                                                \
+    } while (0)
+
+    #define BYTECODE_TOS_DISPATCH() do {                                            \
+        if (atomic_load_explicit(&context->m_signal_pending, memory_order_relaxed)) {\
+            BYTECODE_TOS_SPILL();                                                   \
+            context->m_counter = op;                                                \
+            vm_poll_signals(context);                                               \
+            op = context->m_counter;                                                \
+        }                                                                           \
+        goto *BYTECODE_OP_HANDLER(op);                                              \
+    } while (0)
+
+    #define BYTECODE_TOS_FILL(count, fallback) do {                                 \
+        while (tos_count < (count)) {                                               \
+            if (!BYTECODE_DS_IS_INT(context, 0)) {                                  \
+                BYTECODE_TOS_SPILL();                                               \
+                op = (fallback);                                                    \
+                BYTECODE_TOS_DISPATCH();                                            \
+            }                                                                       \
+            const intptr_t value = anon_scalar_int(&BYTECODE_DS_ITEM(context, 0));  \
+            anon_scalar_init(&BYTECODE_DS_ITEM(context, 0));                        \
+            --BYTECODE_DS_COUNT(context);                                           \
+            if (tos_count++ == 0)  tos0 = value;                                    \
+            else  tos1 = value;                                                     \
+        }                                                                           \
+    } while (0)
+
+    #define BYTECODE_TOS_INT_INT(generic, oper) do {                                \
+        BYTECODE_TOS_FILL(2, _bytecode_deoptimise(context, op, (generic)));         \
+        tos1 = tos1 oper tos0;                                                      \
+        BYTECODE_TOS_DROP();                                                        \
+    } while (0)
+
+    #define BYTECODE_BODY(name)                                                     \
+    do_##name:                                                                      \
+        BYTECODE_TOS_SPILL();                                                       \
+        if (NULL == (op = inst_##name(context, op)))  return 0;                     \
+        BYTECODE_TOS_DISPATCH();
+
+    goto *BYTECODE_OP_HANDLER(op);
+    INSTRUCTION_LIST(BYTECODE_BODY)
+
+    #undef BYTECODE_BODY
+
+    // these don't touch the data stack, so the cache stays as it is
+    tos_JMP:
+        op = inst_JMP(context, op);
+        BYTECODE_TOS_DISPATCH();
+
+    tos_CALL:
+        op = inst_CALL(context, op);
+        BYTECODE_TOS_DISPATCH();
+
+    tos_RETURN:
+        op = inst_RETURN(context, op);
+        BYTECODE_TOS_DISPATCH();
+
+    tos_DROP:
+        if (tos_count > 0) {
+            BYTECODE_TOS_DROP();
+            ++op;
+        }
+        else {
+            op = inst_DROP(context, op);
+        }
+        BYTECODE_TOS_DISPATCH();
+
+    tos_SWAP: {
+        BYTECODE_TOS_FILL(2, inst_SWAP(context, op));
+        const intptr_t a = tos1;
+        tos1 = tos0;
+        tos0 = a;
+        ++op;
+        BYTECODE_TOS_DISPATCH();
+    }
+
+    tos_DUP:
+        BYTECODE_TOS_FILL(1, inst_DUP(context, op));
+        BYTECODE_TOS_PUSH(tos0);
+        ++op;
+        BYTECODE_TOS_DISPATCH();
+
+    tos_BYTE:
+    tos_INT:
+        BYTECODE_TOS_PUSH(op->m_operand.as_int);
+        ++op;
+        BYTECODE_TOS_DISPATCH();
+
+    tos_ADD_INT_INT:
+        BYTECODE_TOS_INT_INT(i_ADD, +);
+        ++op;
+        BYTECODE_TOS_DISPATCH();
+
+    tos_SUBT_INT_INT:
+        BYTECODE_TOS_INT_INT(i_SUBT, -);
+        ++op;
+        BYTECODE_TOS_DISPATCH();
+
+    tos_MULT_INT_INT:
+        BYTECODE_TOS_INT_INT(i_MULT, *);
+        ++op;
+        BYTECODE_TOS_DISPATCH();
+
+    tos_LT0_INT:
+        BYTECODE_TOS_FILL(1, _bytecode_deoptimise(context, op, i_LT0));
+        tos0 = (tos0 < 0);
+        ++op;
+        BYTECODE_TOS_DISPATCH();
+
+    tos_GT0_INT:
+        BYTECODE_TOS_FILL(1, _bytecode_deoptimise(context, op, i_GT0));
+        tos0 = (tos0 > 0);
+        ++op;
+        BYTECODE_TOS_DISPATCH();
+
+    tos_INCR_INT:
+        BYTECODE_TOS_FILL(1, _bytecode_deoptimise(context, op, i_INCR));
+        ++tos0;
+        ++op;
+        BYTECODE_TOS_DISPATCH();
+
+    tos_DECR_INT:
+        BYTECODE_TOS_FILL(1, _bytecode_deoptimise(context, op, i_DECR));
+        --tos0;
+        ++op;
+        BYTECODE_TOS_DISPATCH();
+
+    tos_JMP0_INT: {
+        BYTECODE_TOS_FILL(1, _bytecode_deoptimise(context, op, i_JMP0));
+        const intptr_t a = tos0;
+        BYTECODE_TOS_DROP();
+        op = (a == 0 ? op->m_target : op + 1);
+        BYTECODE_TOS_DISPATCH();
+    }
+
+    #undef BYTECODE_TOS_INT_INT
+    #undef BYTECODE_TOS_FILL
+    #undef BYTECODE_TOS_DISPATCH
+    #undef BYTECODE_TOS_DROP
+    #undef BYTECODE_TOS_PUSH
+    #undef BYTECODE_TOS_SPILL
+    #undef BYTECODE_TOS_LIST
+#else
+    if (context == NULL) {
+        _bytecode_dispatch_table = dispatch_table;
+        return 0;
+    }
+
+    const op_t *op = context->m_counter;
+    assert(op != NULL);
+
+    #define BYTECODE_BODY(name)                                                     \
+    do_##name:                                                                      \
+        if (NULL == (op = inst_##name(context, op)))  return 0;                     \
+        BYTECODE_SIGNAL_CHECK(context, op);                                         \
+        goto *BYTECODE_OP_HANDLER(op);
+
+    goto *BYTECODE_OP_HANDLER(op);
+    INSTRUCTION_LIST(BYTECODE_BODY)
+
+    #undef BYTECODE_BODY
+#endif
+#else
+    #define BYTECODE_CASE(name)                                                     \
+        case i_##name:                                                              \
+            op = inst_##name(context, op);                                          \
+            break;
+
+    if (context == NULL)  return 0;
+
+    const op_t *op = context->m_counter;
+    assert(op != NULL);
+
+    for (;;) {
+        switch (BYTECODE_OP_INSTRUCTION(op)) {
+            INSTRUCTION_LIST(BYTECODE_CASE)
+            default:
+                debug("invalid instruction %i\n", BYTECODE_OP_INSTRUCTION(op));
+                return -1;
+        }
+
+        if (op == NULL)  return 0;
+        BYTECODE_SIGNAL_CHECK(context, op);
+    }
+
+    #undef BYTECODE_CASE
+#endif
+}
+
+/*
+=item bytecode_handler()
+
+Returns the address of the given instruction's body in the threaded interpreter loop, for the program loader to store
+in each op.  Returns NULL when the switch-based loop is in use, which dispatches on the op's instruction instead.
+
+=cut
+ */
+const void *bytecode_handler(instruction_t instruction) {
+    assert(instruction < i__MAX);
+#ifdef BYTECODE_THREADED_DISPATCH
+    if (_bytecode_dispatch_table == NULL)  bytecode_execute(NULL);
+    return _bytecode_dispatch_table[instruction];
+#else
+    return NULL;
+#endif
+}
+
+/*
+=back
+
+=head1 PRIVATE INTERFACE
+
+=over
+
+=item _bytecode_call()
+
+Sets up the frame for a CALL or FRCALL to target: pushes the return state to the return stack, and starts a new scope.
+
+Tail calls (flagged by the program loader) skip the return state: the caller would return as soon as the callee did,
+so the callee can return straight to the caller's caller using the caller's return state, which also ends every scope
+back to the caller's caller's.  Recursion in tail position therefore runs in constant return stack.
+
+Symbols are dynamically scoped, so the callee's scope is normally still started inside the caller's.  But if the
+caller's scope is a frame holding nothing the callee could look up (see _bytecode_frame_unseen()), the caller's scope
+is ended first, just as its RETURN would have ended it, so that the callee's frame reuses its memory in the frame
+arena.  Recursion in tail position that only uses its own locals therefore runs in constant memory too.
+
+=cut
+ */
+static void _bytecode_call(vm_context_t *context, const op_t *op, const op_t *target) {
+    if (BYTECODE_OP_FLAGS(op) & OP_FLAG_TAIL_CALL) {
+        if (_bytecode_frame_unseen(context->m_symboltable, target))  vm_end_scope(context);
+    }
+    else {
+        vm_state_t ret_state = {0};
+        vm_state_init(&ret_state, op + 1, context->m_flags, context->m_symboltable);
+        vm_rs_push(context, &ret_state);
+        vm_state_destroy(&ret_state);
+    }
+
+    vm_start_scope(context, target);
+}
+
+/*
+=item _bytecode_frame_unseen()
+
+Returns non-zero if scope is a frame, and the function starting at target can't see any of its symbols: either it's
+empty, or the program loader found that the function and its callees never look up any of them.  The outermost scope
+isn't a frame, so it's never ended this way.
+
+=cut
+ */
+static int _bytecode_frame_unseen(const symboltable_t *scope, const op_t *target) {
+    if (!(scope->m_flags & SYMBOLTABLE_FLAG_FRAME))  return 0;
+    if (scope->m_symbol_count == 0)  return 1;
+
+    const frame_layout_t *layout = target->m_frame_layout;
+    if (layout == NULL || scope->m_symbols != NULL)  return 0;
+
+    for (size_t i = 0; i < scope->m_slot_count; i++) {
+        if (scope->m_slots[i].m_flags != 0 && frame_layout_sees(layout, scope->m_slots[i].m_identifier))  return 0;
+    }
+
     return 1;
 }
 
+#ifdef BYTECODE_TOS_CACHE
+/*
+=item _bytecode_tos_spill()
+
+Pushes count integers cached by the threaded interpreter loop onto the data stack, such that the first ends up on top.
+
+=cut
+ */
+static void _bytecode_tos_spill(vm_context_t *context, size_t count, intptr_t tos0, intptr_t tos1) {
+    assert(count > 0 && count <= 2);
+
+    scalar_t items[2] = {{0}};
+    anon_scalar_put_int(&items[0], tos0);
+    anon_scalar_put_int(&items[1], tos1);
+    vm_ds_ngive(context, count, items);
+}
+#endif
+
+/*
+=item _bytecode_rewrite()
+
+Rewrites an op in place to execute a different instruction with the same operands.
+
+Ops are shared by every context executing the program, so another thread may be dispatching the same op while it's
+being rewritten.  The fields are stored atomically so that it reads either the old or the new instruction.  Relaxed
+ordering is enough: each loop only reads one of m_handler or m_instruction, and both the generic and quickened forms
+of an instruction are correct wherever they run.
+
+=cut
+ */
+static void _bytecode_rewrite(const op_t *op, instruction_t instruction) {
+    op_t *mutable_op = (op_t *) op;
+
+    atomic_store_explicit(&mutable_op->m_handler, bytecode_handler(instruction), memory_order_relaxed);
+    atomic_store_explicit(&mutable_op->m_instruction, instruction, memory_order_relaxed);
+}
+
+/*
+=item _bytecode_deoptimise()
+
+Called by a quickened op whose type guard has failed.  Permanently restores the op's generic instruction, then executes
+it.
+
+=cut
+ */
+static const op_t *_bytecode_deoptimise(vm_context_t *context, const op_t *op, instruction_t generic) {
+    debug("deoptimising '%s' to '%s'\n", instruction_names[BYTECODE_OP_INSTRUCTION(op)], instruction_names[generic]);
+
+    atomic_fetch_or_explicit(&((op_t *) op)->m_flags, OP_FLAG_NO_QUICKEN, memory_order_relaxed);
+    _bytecode_rewrite(op, generic);
+
+    return instruction_table[generic](context, op);
+}
+
+/*
+=item _bytecode_split_field()
+
+Appends a field to the array SPLIT is collecting, growing the array as needed.  The field is a substring of s, so it
+shares s's bytes where it can.  Returns 0 on success, or non-zero if the array couldn't be grown.
+
+=cut
+ */
+static int _bytecode_split_field(scalar_t **fields, size_t *n, size_t *allocated, const scalar_t *s, size_t offset,
+                                 size_t length) {
+    if (*n == *allocated) {
+        const size_t new_allocated = (*allocated > 0 ? *allocated * 2 : 16);
+        scalar_t *tmp = realloc(*fields, new_allocated * sizeof(**fields));
+        if (tmp == NULL) {
+            debug("realloc failed\n");
+            return -1;
+        }
+        memset(&tmp[*allocated], 0, (new_allocated - *allocated) * sizeof(*tmp));
+        *fields = tmp;
+        *allocated = new_allocated;
+    }
+    
+    anon_scalar_set_substring(&(*fields)[(*n)++], s, offset, length);
+    return 0;
+}
+
 /*
 =back
 
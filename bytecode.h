@@ -109,7 +109,26 @@ typedef enum instruction_t {
     i_ORD,
     i_REV,
     i_SIG,
+    i_SRAPPEND,
+    i_SRTAKE,
+    i_INDEX,
+    i_SPLIT,
+    i_SCAN,
+    i_SPAN,
 /*-- INSTRUCTIONS END --*/
+
+    /* specialised forms that generic instructions rewrite themselves into at run time; never valid in bytecode */
+    i__QUICK_MIN,
+/*-- QUICKENED INSTRUCTIONS START --*/
+    i_ADD_INT_INT = i__QUICK_MIN,
+    i_SUBT_INT_INT,
+    i_MULT_INT_INT,
+    i_LT0_INT,
+    i_GT0_INT,
+    i_INCR_INT,
+    i_DECR_INT,
+    i_JMP0_INT,
+/*-- QUICKENED INSTRUCTIONS END --*/
     
 //    iTUCK,
 //    iPICK,
@@ -213,4 +232,8 @@ typedef enum instruction_t {
     i__MAX,
 } instruction_t;
 
+struct vm_context_t;
+int bytecode_execute(struct vm_context_t *);
+const void *bytecode_handler(instruction_t);
+
 #endif
@@ -52,7 +52,13 @@ static inline int _channel_unlock(channel_handle_t);
 
 =item channel_pool_destroy()
 
-Setup and teardown functions for the channel pool
+=item channel_pool_flush()
+
+=item channel_pool_stats()
+
+Setup and teardown functions for the channel pool.  channel_pool_flush() gives the calling thread's cached free
+channels back to the pool, and must be called by each thread before it finishes.  channel_pool_stats() fills in stats
+with the pool's allocation counts, as POOL_MAGAZINE_STATS() does.
 
 =cut
  */
@@ -64,6 +70,14 @@ int channel_pool_destroy(void) {
     return POOL_DESTROY(channel_t);
 }
 
+int channel_pool_flush(void) {
+    return POOL_FLUSH(channel_t);
+}
+
+int channel_pool_stats(pool_magazine_stats_t *stats) {
+    return POOL_MAGAZINE_STATS(channel_t, stats);
+}
+
 /*
 =item channel_allocate()
 
@@ -32,10 +32,12 @@ typedef struct channel_t {
 int _channel_init(channel_t *);
 int _channel_destroy(channel_t *);
 
-POOL_HEADER_CONTENTS(channel_t, channel_handle_t, PTHREAD_MUTEX_ERRORCHECK, _channel_init, _channel_destroy);
+POOL_HEADER_CONTENTS(channel_t, channel_handle_t, PTHREAD_MUTEX_ERRORCHECK, POOL_LOCK_MUTEX, _channel_init, _channel_destroy);
 
 int channel_pool_init(void);
 int channel_pool_destroy(void);
+int channel_pool_flush(void);
+int channel_pool_stats(pool_magazine_stats_t *);
 
 channel_handle_t channel_allocate(void);
 channel_handle_t channel_allocate_many(size_t);
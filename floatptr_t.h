@@ -0,0 +1,4 @@
+#ifndef FLOATPTR_T
+#define FLOATPTR_T
+typedef double floatptr_t;
+#endif
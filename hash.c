@@ -17,6 +17,11 @@ This means, for example, that when used as keys, the integer 1 and the string "1
 
 This also means that it's generally not useful to use a reference type as a hash key.
 
+A key is hashed straight from its string representation (see C<anon_scalar_format()>), before the hash is locked, so
+looking a key up doesn't allocate anything.  Only a key that's added to the hash gets a string_t of its own.  Each item
+also keeps its key's hash code, and the items in a bucket are ordered by hash code and then by key, so searching a
+bucket mostly compares integers rather than strings.
+
 =head1 PUBLIC INTERFACE
 
 =over
@@ -36,16 +41,28 @@ This also means that it's generally not useful to use a reference type as a hash
 
 #define HASH(handle)    POOL_OBJECT(hash_t, handle)
 
+#define HASH_SLICE_BATCH    (16)
+
+/* a key's string representation and hash code, worked out before the hash is locked */
+typedef struct hash_key_t {
+    const char *m_bytes;
+    size_t m_length;
+    uint32_t m_hash;
+    char m_buffer[SCALAR_FORMAT_BUFFER_SIZE];
+} hash_key_t;
+
+static void _hash_key_init(hash_key_t *, const scalar_t *);
+
 static int _hash_bucket_init(hash_bucket_t *);
 static int _hash_bucket_destroy(hash_bucket_t *);
-static int _hash_item_init(hash_item_t *, const string_t *);
+static int _hash_item_init(hash_item_t *, const hash_key_t *);
 static int _hash_item_destroy(hash_item_t *);
 
 static size_t _hash_size_unlocked(hash_t *);
-static scalar_handle_t _hash_key_item_unlocked(hash_t *, const string_t *);
-static int _hash_key_delete_unlocked(hash_t *, const string_t *);
-static int _hash_key_exists_unlocked(hash_t *, const string_t *);
-static inline uint32_t _hash_key(const string_t *);
+static scalar_handle_t _hash_key_item_unlocked(hash_t *, const hash_key_t *);
+static int _hash_key_delete_unlocked(hash_t *, const hash_key_t *);
+static int _hash_key_exists_unlocked(hash_t *, const hash_key_t *);
+static inline int _hash_item_cmp(const hash_item_t *, const hash_key_t *);
 
 POOL_SOURCE_CONTENTS(hash_t);
 
@@ -54,7 +71,13 @@ POOL_SOURCE_CONTENTS(hash_t);
 
 =item hash_pool_destroy()
 
-Setup and teardown functions for the hash pool
+=item hash_pool_flush()
+
+=item hash_pool_stats()
+
+Setup and teardown functions for the hash pool.  hash_pool_flush() gives the calling thread's cached free hashes back
+to the pool, and must be called by each thread before it finishes.  hash_pool_stats() fills in stats with the pool's
+allocation counts, as POOL_MAGAZINE_STATS() does.
 
 =cut
  */
@@ -66,6 +89,14 @@ int hash_pool_destroy(void) {
     return POOL_DESTROY(hash_t);
 }
 
+int hash_pool_flush(void) {
+    return POOL_FLUSH(hash_t);
+}
+
+int hash_pool_stats(pool_magazine_stats_t *stats) {
+    return POOL_MAGAZINE_STATS(hash_t, stats);
+}
+
 /*
 =item hash_allocate()
 
@@ -132,11 +163,11 @@ scalar_handle_t hash_key_item(hash_handle_t handle, const struct scalar_t *key)
     assert(POOL_HANDLE_VALID(hash_t, handle));
     assert(key != NULL);
     
+    hash_key_t hkey;
+    _hash_key_init(&hkey, key);
+
     if (0 == POOL_LOCK(hash_t, handle)) {
-        string_t *skey;
-        anon_scalar_get_string_value(key, &skey);
-        scalar_handle_t item = _hash_key_item_unlocked(&HASH(handle), skey);
-        string_free(skey);
+        scalar_handle_t item = _hash_key_item_unlocked(&HASH(handle), &hkey);
         POOL_UNLOCK(hash_t, handle);
         return item;
     }
@@ -152,28 +183,35 @@ Takes an array of n scalar elements, each containing a key.  Replaces each eleme
 the item in the hash with that key.  Keys that don't currently exist in the hash are automatically created
 and their value set to undefined.
 
+The keys are hashed HASH_SLICE_BATCH at a time before the hash is locked for each batch.
+
 =cut
 */
 int hash_slice(hash_handle_t handle, struct scalar_t *elements, size_t count) {
     assert(POOL_HANDLE_VALID(hash_t, handle));
     
-    if (0 == POOL_LOCK(hash_t, handle)) {
-        for (size_t i = 0; i < count; i++) {
-            string_t *key;
-            anon_scalar_get_string_value(&elements[i], &key);
-            scalar_handle_t scalar_handle = _hash_key_item_unlocked(&HASH(handle), key);
-            anon_scalar_set_scalar_reference(&elements[i], scalar_handle);
-            scalar_release(scalar_handle);
-            string_free(key);
+    for (size_t start = 0; start < count; start += HASH_SLICE_BATCH) {
+        const size_t n = MIN(count - start, HASH_SLICE_BATCH);
+        hash_key_t keys[HASH_SLICE_BATCH];
+        for (size_t i = 0; i < n; i++)  _hash_key_init(&keys[i], &elements[start + i]);
+
+        if (0 == POOL_LOCK(hash_t, handle)) {
+            // n.b. a key's bytes may belong to its element, so they're done with before the element is replaced
+            for (size_t i = 0; i < n; i++) {
+                scalar_handle_t scalar_handle = _hash_key_item_unlocked(&HASH(handle), &keys[i]);
+                anon_scalar_set_scalar_reference(&elements[start + i], scalar_handle);
+                scalar_release(scalar_handle);
+            }
+
+            POOL_UNLOCK(hash_t, handle);
+        }
+        else {
+            debug("failed to lock hash handle %"PRIuPTR"\n", handle);
+            return -1;
         }
-    
-        POOL_UNLOCK(hash_t, handle);
-        return 0;
-    }
-    else {
-        debug("failed to lock hash handle %"PRIuPTR"\n", handle);
-        return -1;
     }
+
+    return 0;
 }
 
 /*
@@ -353,12 +391,11 @@ int hash_fill(hash_handle_t handle, const struct scalar_t *pairs, size_t count)
         _hash_init(&HASH(handle));
         
         for (size_t i = 0; i < count; ) {
-            string_t *key;
-            anon_scalar_get_string_value(&pairs[i++], &key);
-            scalar_handle_t value_handle = _hash_key_item_unlocked(&HASH(handle), key);
+            hash_key_t key;
+            _hash_key_init(&key, &pairs[i++]);
+            scalar_handle_t value_handle = _hash_key_item_unlocked(&HASH(handle), &key);
             scalar_set_value(value_handle, &pairs[i++]);
             scalar_release(value_handle);
-            string_free(key);
         }
     
         POOL_UNLOCK(hash_t, handle);
@@ -381,12 +418,12 @@ int hash_key_delete(hash_handle_t handle, const struct scalar_t *key) {
     assert(POOL_HANDLE_VALID(hash_t, handle));
     assert(key != NULL);
     
+    hash_key_t hkey;
+    _hash_key_init(&hkey, key);
+
     int status;
     if (0 == POOL_LOCK(hash_t, handle)) {
-        string_t *skey;
-        anon_scalar_get_string_value(key, &skey);
-        status = _hash_key_delete_unlocked(&HASH(handle), skey);
-        string_free(skey);
+        status = _hash_key_delete_unlocked(&HASH(handle), &hkey);
         POOL_UNLOCK(hash_t, handle);
     }
     else {
@@ -406,12 +443,12 @@ int hash_key_exists(hash_handle_t handle, const struct scalar_t *key) {
     assert(POOL_HANDLE_VALID(hash_t, handle));
     assert(key != NULL);
     
+    hash_key_t hkey;
+    _hash_key_init(&hkey, key);
+
     int status = 0;
     if (0 == POOL_LOCK(hash_t, handle)) {
-        string_t *skey;
-        anon_scalar_get_string_value(key, &skey);
-        status = _hash_key_exists_unlocked(&HASH(handle), skey);
-        string_free(skey);
+        status = _hash_key_exists_unlocked(&HASH(handle), &hkey);
         POOL_UNLOCK(hash_t, handle);
     }
     return status;
@@ -429,6 +466,22 @@ int hash_key_exists(hash_handle_t handle, const struct scalar_t *key) {
  */
 
 
+/*
+=item _hash_key_init()
+
+Works out a key's string representation and its hash code, without allocating anything.  The bytes may belong to the
+key scalar itself, so the hash_key_t is only valid until the key is next modified or destroyed.
+
+=cut
+ */
+static void _hash_key_init(hash_key_t *self, const scalar_t *key) {
+    assert(self != NULL);
+    assert(key != NULL);
+
+    self->m_bytes = anon_scalar_format(key, self->m_buffer, &self->m_length);
+    self->m_hash = string_hash_bytes(self->m_bytes, self->m_length);
+}
+
 /*
 =item _hash_init()
 
@@ -497,11 +550,12 @@ Setup and teardown functions for hash_item_t objects
 
 =cut
  */
-static int _hash_item_init(hash_item_t *self, const string_t *key) {
+static int _hash_item_init(hash_item_t *self, const hash_key_t *key) {
     assert(self != NULL);
     assert(key != NULL);
     
-    self->m_key = string_dup(key);
+    if (NULL == (self->m_key = string_alloc(key->m_length, key->m_bytes)))  return -1;
+    self->m_hash = key->m_hash;
     self->m_value = scalar_allocate(0); FIXME("handle flags\n");
     self->m_next_item = NULL;
     return 0;
@@ -542,36 +596,37 @@ is automatically created.
 The caller must release the handle returned using C<scalar_release()> when they are done with it.
 =cut
  */
-static scalar_handle_t _hash_key_item_unlocked(hash_t *self, const string_t *key) {
+static scalar_handle_t _hash_key_item_unlocked(hash_t *self, const hash_key_t *key) {
     assert(self != NULL);
     assert(key != NULL);
     
-    hash_bucket_t *bucket = &self->m_buckets[_hash_key(key) % HASH_BUCKETS];
+    hash_bucket_t *bucket = &self->m_buckets[key->m_hash % HASH_BUCKETS];
 
     scalar_handle_t handle = 0;    
 
     if (bucket->m_first_item == NULL) {
         hash_item_t *new_item = calloc(1, sizeof(*new_item));
-        if (new_item != NULL) {
-            _hash_item_init(new_item, key);
+        if (new_item != NULL && 0 == _hash_item_init(new_item, key)) {
             bucket->m_first_item = new_item;
             bucket->m_count = 1;
             handle = scalar_reference(new_item->m_value);
         }
+        else {
+            free(new_item);
+        }
     }
     else {
         hash_item_t *item = bucket->m_first_item;
         hash_item_t *prev = NULL;
         while (item != NULL) {
-            int cmp = string_cmp(item->m_key, key);
+            int cmp = _hash_item_cmp(item, key);
             if (cmp == 0) {         // found it
                 handle = scalar_reference(item->m_value);
                 break;
             }
             else if (cmp > 0) {     // have gone past where it should have been: auto-vivify it
                 hash_item_t *new_item = calloc(1, sizeof(*new_item));
-                if (new_item != NULL) {
-                    _hash_item_init(new_item, key);
+                if (new_item != NULL && 0 == _hash_item_init(new_item, key)) {
                     new_item->m_next_item = item;
                     if (prev != NULL) {
                         prev->m_next_item = new_item;
@@ -582,6 +637,9 @@ static scalar_handle_t _hash_key_item_unlocked(hash_t *self, const string_t *key
                     ++bucket->m_count;
                     handle = scalar_reference(new_item->m_value);
                 }
+                else {
+                    free(new_item);
+                }
                 break;
             }
             else {                  // keep looking
@@ -592,12 +650,14 @@ static scalar_handle_t _hash_key_item_unlocked(hash_t *self, const string_t *key
         if (item == NULL) {
             // got to the end of the bucket without finding it: auto-vivify it
             hash_item_t *new_item = calloc(1, sizeof(*new_item));
-            if (new_item != NULL) {
-                _hash_item_init(new_item, key);
+            if (new_item != NULL && 0 == _hash_item_init(new_item, key)) {
                 prev->m_next_item = new_item;
                 ++bucket->m_count;
                 handle = scalar_reference(new_item->m_value);
             }
+            else {
+                free(new_item);
+            }
         }
     }
     
@@ -613,11 +673,11 @@ Returns 0 on success, non-zero on failure.
 
 =cut
  */
-static int _hash_key_delete_unlocked(hash_t *self, const string_t *key) {
+static int _hash_key_delete_unlocked(hash_t *self, const hash_key_t *key) {
     assert(self != NULL);
     assert(key != NULL);
     
-    hash_bucket_t *bucket = &self->m_buckets[_hash_key(key) % HASH_BUCKETS];
+    hash_bucket_t *bucket = &self->m_buckets[key->m_hash % HASH_BUCKETS];
     if (bucket->m_count == 0)  return 0;
     
     hash_item_t *item = bucket->m_first_item;
@@ -625,7 +685,7 @@ static int _hash_key_delete_unlocked(hash_t *self, const string_t *key) {
     
     int status = 0;
     while (item != NULL) {
-        int cmp = string_cmp(item->m_key, key);
+        int cmp = _hash_item_cmp(item, key);
         if (cmp == 0) {     // found it
             if (prev != NULL) {
                 prev->m_next_item = item->m_next_item;
@@ -658,18 +718,18 @@ Returns 1 if the key exists, or 0 if it does not.
 
 =cut
  */
-static int _hash_key_exists_unlocked(hash_t *self, const string_t *key) {
+static int _hash_key_exists_unlocked(hash_t *self, const hash_key_t *key) {
     assert(self != NULL);
     assert(key != NULL);
     
-    hash_bucket_t *bucket = &self->m_buckets[_hash_key(key) % HASH_BUCKETS];
+    hash_bucket_t *bucket = &self->m_buckets[key->m_hash % HASH_BUCKETS];
     if (bucket->m_count == 0)  return 0;
     
     hash_item_t *item = bucket->m_first_item;
     
     int found = 0;
     while (item != NULL) {
-        int cmp = string_cmp(item->m_key, key);
+        int cmp = _hash_item_cmp(item, key);
         if (cmp == 0) {
             found = 1;
             break;
@@ -685,28 +745,20 @@ static int _hash_key_exists_unlocked(hash_t *self, const string_t *key) {
 }
 
 /*
-=item _hash_key()
+=item _hash_item_cmp()
 
-Hashes a string key into a uint32_t.
+Compares an item's key with a key, in the order items are kept in within a bucket: by hash code, and then by key for
+items whose hash codes are the same.  Returns less than, equal to, or greater than zero, like C<string_cmp()>.
 
 =cut
- * http://www.burtleburtle.net/bob/hash/doobs.html
- * one at a time hash: it's good enough for perl
  */
-static inline uint32_t _hash_key(const string_t *key) {
-    const uint8_t *p = (const uint8_t *) string_cstr(key);
-    const size_t len = string_length(key);
-
-    uint32_t hash = 0;    
-    for (size_t i = 0; i < len; ++i) {
-        hash += p[i];
-        hash += (hash << 10);
-        hash ^= (hash >> 6);
-    }
-    hash += (hash << 3);
-    hash ^= (hash >> 11);
-    hash += (hash << 15);
-    return hash;
+static inline int _hash_item_cmp(const hash_item_t *item, const hash_key_t *key) {
+    if (item->m_hash != key->m_hash)  return (item->m_hash < key->m_hash ? -1 : 1);
+
+    const size_t length = string_length(item->m_key);
+    int cmp = memcmp(string_cstr(item->m_key), key->m_bytes, MIN(length, key->m_length));
+    if (cmp == 0 && length != key->m_length)  cmp = (length > key->m_length ? 1 : -1);
+    return cmp;
 }
 
 /*
@@ -23,6 +23,7 @@
 
 typedef struct hash_item_t {
     string_t *m_key;
+    uint32_t m_hash;
     scalar_handle_t m_value;
     struct hash_item_t *m_next_item;
 } hash_item_t;
@@ -39,12 +40,14 @@ typedef struct hash_t {
 int _hash_init(hash_t *);
 int _hash_destroy(hash_t *);
 
-POOL_HEADER_CONTENTS(hash_t, hash_handle_t, PTHREAD_MUTEX_ERRORCHECK, _hash_init, _hash_destroy);
+POOL_HEADER_CONTENTS(hash_t, hash_handle_t, PTHREAD_MUTEX_ERRORCHECK, POOL_LOCK_MUTEX, _hash_init, _hash_destroy);
 
 struct scalar_t;
 
 int hash_pool_init(void);
 int hash_pool_destroy(void);
+int hash_pool_flush(void);
+int hash_pool_stats(pool_magazine_stats_t *);
 
 hash_handle_t hash_allocate(void);
 hash_handle_t hash_allocate_many(size_t);
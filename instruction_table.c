@@ -0,0 +1,332 @@
+#include "instruction_table.h"
+#include "vmtypes.h"
+const instruction_func instruction_table[] = {
+	&inst_END,
+	&inst_NOOP,
+	&inst_CALL,
+	&inst_CORO,
+	&inst_RETURN,
+	&inst_DROP,
+	&inst_SWAP,
+	&inst_DUP,
+	&inst_OVER,
+	&inst_ROT,
+	&inst_TOR,
+	&inst_AND,
+	&inst_OR,
+	&inst_XOR,
+	&inst_NOT,
+	&inst_JMP,
+	&inst_JMP0,
+	&inst_JMPU,
+	&inst_SCALAR,
+	&inst_ARRAY,
+	&inst_HASH,
+	&inst_CHANNEL,
+	&inst_STREAM,
+	&inst_SYMDEF,
+	&inst_SYMFIND,
+	&inst_SYMCLONE,
+	&inst_SYMUNDEF,
+	&inst_SRLOCK,
+	&inst_SRUNLOCK,
+	&inst_SRREAD,
+	&inst_SRWRITE,
+	&inst_ARLEN,
+	&inst_ARINDEX,
+	&inst_ARSLICE,
+	&inst_ARLIST,
+	&inst_ARFILL,
+	&inst_ARPUSH,
+	&inst_ARUNSHFT,
+	&inst_ARPOP,
+	&inst_ARSHFT,
+	&inst_HRLEN,
+	&inst_HRINDEX,
+	&inst_HRSLICE,
+	&inst_HRLISTK,
+	&inst_HRLISTV,
+	&inst_HRLISTP,
+	&inst_HRFILL,
+	&inst_HRKEYEX,
+	&inst_HRKEYDEL,
+	&inst_CRTRYRD,
+	&inst_CRREAD,
+	&inst_CRWRITE,
+	&inst_FRCALL,
+	&inst_FRCORO,
+	&inst_BYTE,
+	&inst_INT,
+	&inst_ADD,
+	&inst_SUBT,
+	&inst_MULT,
+	&inst_DIV,
+	&inst_MOD,
+	&inst_LT0,
+	&inst_GT0,
+	&inst_INCR,
+	&inst_DECR,
+	&inst_STR,
+	&inst_STRING,
+	&inst_LEN,
+	&inst_XPLOD,
+	&inst_CAT,
+	&inst_FLOAT,
+	&inst_ADDF,
+	&inst_SUBTF,
+	&inst_MULTF,
+	&inst_DIVF,
+	&inst_MODF,
+	&inst_LT0F,
+	&inst_GT0F,
+	&inst_FUNLIT,
+	&inst_OPEN,
+	&inst_CLOSE,
+	&inst_OUT,
+	&inst_OUTL,
+	&inst_IN,
+	&inst_INL,
+	&inst_CHOMP,
+	&inst_UNDEF,
+	&inst_STDIN,
+	&inst_STDOUT,
+	&inst_STDERR,
+	&inst_CHR,
+	&inst_ORD,
+	&inst_REV,
+	&inst_SIG,
+	&inst_SRAPPEND,
+	&inst_SRTAKE,
+	&inst_INDEX,
+	&inst_SPLIT,
+	&inst_SCAN,
+	&inst_SPAN,
+	&inst_ADD_INT_INT,
+	&inst_SUBT_INT_INT,
+	&inst_MULT_INT_INT,
+	&inst_LT0_INT,
+	&inst_GT0_INT,
+	&inst_INCR_INT,
+	&inst_DECR_INT,
+	&inst_JMP0_INT,
+};
+const char *instruction_names[] = {
+	"end",
+	"noop",
+	"call",
+	"coro",
+	"return",
+	"drop",
+	"swap",
+	"dup",
+	"over",
+	"rot",
+	"tor",
+	"and",
+	"or",
+	"xor",
+	"not",
+	"jmp",
+	"jmp0",
+	"jmpu",
+	"scalar",
+	"array",
+	"hash",
+	"channel",
+	"stream",
+	"symdef",
+	"symfind",
+	"symclone",
+	"symundef",
+	"srlock",
+	"srunlock",
+	"srread",
+	"srwrite",
+	"arlen",
+	"arindex",
+	"arslice",
+	"arlist",
+	"arfill",
+	"arpush",
+	"arunshft",
+	"arpop",
+	"arshft",
+	"hrlen",
+	"hrindex",
+	"hrslice",
+	"hrlistk",
+	"hrlistv",
+	"hrlistp",
+	"hrfill",
+	"hrkeyex",
+	"hrkeydel",
+	"crtryrd",
+	"crread",
+	"crwrite",
+	"frcall",
+	"frcoro",
+	"byte",
+	"int",
+	"add",
+	"subt",
+	"mult",
+	"div",
+	"mod",
+	"lt0",
+	"gt0",
+	"incr",
+	"decr",
+	"str",
+	"string",
+	"len",
+	"xplod",
+	"cat",
+	"float",
+	"addf",
+	"subtf",
+	"multf",
+	"divf",
+	"modf",
+	"lt0f",
+	"gt0f",
+	"funlit",
+	"open",
+	"close",
+	"out",
+	"outl",
+	"in",
+	"inl",
+	"chomp",
+	"undef",
+	"stdin",
+	"stdout",
+	"stderr",
+	"chr",
+	"ord",
+	"rev",
+	"sig",
+	"srappend",
+	"srtake",
+	"index",
+	"split",
+	"scan",
+	"span",
+	"add_int_int",
+	"subt_int_int",
+	"mult_int_int",
+	"lt0_int",
+	"gt0_int",
+	"incr_int",
+	"decr_int",
+	"jmp0_int",
+};
+const unsigned instruction_sizes[] = {
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + sizeof(function_handle_t),
+	sizeof(uint8_t) + sizeof(function_handle_t),
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + sizeof(intptr_t),
+	sizeof(uint8_t) + sizeof(intptr_t),
+	sizeof(uint8_t) + sizeof(intptr_t),
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + sizeof(flags32_t) + sizeof(identifier_t),
+	sizeof(uint8_t) + sizeof(identifier_t),
+	sizeof(uint8_t) + sizeof(identifier_t),
+	sizeof(uint8_t) + sizeof(identifier_t),
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + sizeof(uint8_t),
+	sizeof(uint8_t) + sizeof(intptr_t),
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + sizeof(uint8_t),
+	sizeof(uint8_t) + sizeof(uint32_t),
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + sizeof(floatptr_t),
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + sizeof(function_handle_t),
+	sizeof(uint8_t) + sizeof(flags8_t),
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+	sizeof(uint8_t) + 0,
+};
@@ -0,0 +1,230 @@
+#ifndef INSTRUCTION_TABLE_H
+#define INSTRUCTION_TABLE_H
+struct vm_context_t;
+struct op_t;
+typedef const struct op_t *(*instruction_func)(struct vm_context_t *, const struct op_t *);
+extern const instruction_func instruction_table[];
+extern const char *instruction_names[];
+extern const unsigned instruction_sizes[];
+
+const struct op_t *inst_END(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_NOOP(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_CALL(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_CORO(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_RETURN(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_DROP(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SWAP(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_DUP(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_OVER(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ROT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_TOR(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_AND(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_OR(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_XOR(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_NOT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_JMP(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_JMP0(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_JMPU(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SCALAR(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ARRAY(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_HASH(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_CHANNEL(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_STREAM(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SYMDEF(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SYMFIND(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SYMCLONE(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SYMUNDEF(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SRLOCK(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SRUNLOCK(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SRREAD(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SRWRITE(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ARLEN(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ARINDEX(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ARSLICE(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ARLIST(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ARFILL(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ARPUSH(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ARUNSHFT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ARPOP(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ARSHFT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_HRLEN(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_HRINDEX(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_HRSLICE(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_HRLISTK(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_HRLISTV(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_HRLISTP(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_HRFILL(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_HRKEYEX(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_HRKEYDEL(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_CRTRYRD(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_CRREAD(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_CRWRITE(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_FRCALL(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_FRCORO(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_BYTE(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_INT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ADD(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SUBT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_MULT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_DIV(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_MOD(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_LT0(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_GT0(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_INCR(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_DECR(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_STR(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_STRING(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_LEN(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_XPLOD(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_CAT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_FLOAT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ADDF(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SUBTF(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_MULTF(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_DIVF(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_MODF(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_LT0F(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_GT0F(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_FUNLIT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_OPEN(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_CLOSE(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_OUT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_OUTL(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_IN(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_INL(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_CHOMP(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_UNDEF(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_STDIN(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_STDOUT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_STDERR(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_CHR(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ORD(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_REV(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SIG(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SRAPPEND(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SRTAKE(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_INDEX(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SPLIT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SCAN(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SPAN(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_ADD_INT_INT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_SUBT_INT_INT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_MULT_INT_INT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_LT0_INT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_GT0_INT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_INCR_INT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_DECR_INT(struct vm_context_t *, const struct op_t *);
+const struct op_t *inst_JMP0_INT(struct vm_context_t *, const struct op_t *);
+
+#define INSTRUCTION_LIST(X) \
+	X(END) \
+	X(NOOP) \
+	X(CALL) \
+	X(CORO) \
+	X(RETURN) \
+	X(DROP) \
+	X(SWAP) \
+	X(DUP) \
+	X(OVER) \
+	X(ROT) \
+	X(TOR) \
+	X(AND) \
+	X(OR) \
+	X(XOR) \
+	X(NOT) \
+	X(JMP) \
+	X(JMP0) \
+	X(JMPU) \
+	X(SCALAR) \
+	X(ARRAY) \
+	X(HASH) \
+	X(CHANNEL) \
+	X(STREAM) \
+	X(SYMDEF) \
+	X(SYMFIND) \
+	X(SYMCLONE) \
+	X(SYMUNDEF) \
+	X(SRLOCK) \
+	X(SRUNLOCK) \
+	X(SRREAD) \
+	X(SRWRITE) \
+	X(ARLEN) \
+	X(ARINDEX) \
+	X(ARSLICE) \
+	X(ARLIST) \
+	X(ARFILL) \
+	X(ARPUSH) \
+	X(ARUNSHFT) \
+	X(ARPOP) \
+	X(ARSHFT) \
+	X(HRLEN) \
+	X(HRINDEX) \
+	X(HRSLICE) \
+	X(HRLISTK) \
+	X(HRLISTV) \
+	X(HRLISTP) \
+	X(HRFILL) \
+	X(HRKEYEX) \
+	X(HRKEYDEL) \
+	X(CRTRYRD) \
+	X(CRREAD) \
+	X(CRWRITE) \
+	X(FRCALL) \
+	X(FRCORO) \
+	X(BYTE) \
+	X(INT) \
+	X(ADD) \
+	X(SUBT) \
+	X(MULT) \
+	X(DIV) \
+	X(MOD) \
+	X(LT0) \
+	X(GT0) \
+	X(INCR) \
+	X(DECR) \
+	X(STR) \
+	X(STRING) \
+	X(LEN) \
+	X(XPLOD) \
+	X(CAT) \
+	X(FLOAT) \
+	X(ADDF) \
+	X(SUBTF) \
+	X(MULTF) \
+	X(DIVF) \
+	X(MODF) \
+	X(LT0F) \
+	X(GT0F) \
+	X(FUNLIT) \
+	X(OPEN) \
+	X(CLOSE) \
+	X(OUT) \
+	X(OUTL) \
+	X(IN) \
+	X(INL) \
+	X(CHOMP) \
+	X(UNDEF) \
+	X(STDIN) \
+	X(STDOUT) \
+	X(STDERR) \
+	X(CHR) \
+	X(ORD) \
+	X(REV) \
+	X(SIG) \
+	X(SRAPPEND) \
+	X(SRTAKE) \
+	X(INDEX) \
+	X(SPLIT) \
+	X(SCAN) \
+	X(SPAN) \
+	X(ADD_INT_INT) \
+	X(SUBT_INT_INT) \
+	X(MULT_INT_INT) \
+	X(LT0_INT) \
+	X(GT0_INT) \
+	X(INCR_INT) \
+	X(DECR_INT) \
+	X(JMP0_INT) \
+	/* end of list */
+
+#endif
@@ -18,11 +18,12 @@
 #include "assembler.h"
 #include "vm.h"
 
-static const char *options = "acho:x";
+static const char *options = "acho:vx";
 
 static int  opt_is_assembly    = 0;
 static int  opt_compile_only   = 0;
 static int  opt_is_bytecode    = 0;
+static int  opt_pool_stats     = 0;
 static char *output_file_name  = NULL;
 static char *program_file_name = NULL;
 static assembler_output_t *program = NULL; // FIXME("make program a useful type\n");
@@ -50,6 +51,9 @@ int main(int argc, char *const argv[]) {
             case 'o':
                 output_file_name = strdup(optarg);
                 break;
+            case 'v':
+                opt_pool_stats = 1;
+                break;
             case 'x':
                 opt_is_assembly = 0;
                 opt_is_bytecode = 1;
@@ -97,7 +101,8 @@ int main(int argc, char *const argv[]) {
             status = write_bytecode_file(output_file_name, program);  // writes to stdout if filename is NULL
         }
         else {
-            status = vm_main(program->m_bytecode, program->m_bytecode_length, program->m_bytecode_start);
+            status = vm_main(program->m_bytecode, program->m_bytecode_length, program->m_bytecode_start,
+                             opt_pool_stats ? VM_MAIN_FLAG_POOL_STATS : 0);
         }
         
         free(program);
@@ -132,6 +137,9 @@ Options:
 
     -o      Specifies the output filename to be used by the -c option.
 
+    -v      Print allocation statistics for each object pool to stderr
+            when the program finishes.
+
     -x      Treat programfile as compiled bytecode input (as produced by the
             -c option).
 ***/
@@ -154,6 +162,9 @@ Options:
 "\n"
 "    -o      Specifies the output filename to be used by the -c option.\n"
 "\n"
+"    -v      Print allocation statistics for each object pool to stderr\n"
+"            when the program finishes.\n"
+"\n"
 "    -x      Treat programfile as compiled bytecode input (as produced by the\n"
 "            -c option).\n"
     ;
@@ -17,8 +17,8 @@ my @instructions;
 
 my $process_flag = 0;
 while (<>) {
-    $process_flag = 1, next if m{^\s*/\*-- INSTRUCTIONS START --\*/\s*$};
-    $process_flag = 0, next if m{^\s*/\*-- INSTRUCTIONS END --\*/\s*$};
+    $process_flag = 1, next if m{^\s*/\*-- (?:QUICKENED )?INSTRUCTIONS START --\*/\s*$};
+    $process_flag = 0, next if m{^\s*/\*-- (?:QUICKENED )?INSTRUCTIONS END --\*/\s*$};
     next if not $process_flag;
 
     chomp;
@@ -37,7 +37,8 @@ open my $header, '>', "$output.h" or die "$output.h: $!";
 #ifndef INSTRUCTION_TABLE_H
 #define INSTRUCTION_TABLE_H
 struct vm_context_t;
-typedef int(*instruction_func)(struct vm_context_t *);
+struct op_t;
+typedef const struct op_t *(*instruction_func)(struct vm_context_t *, const struct op_t *);
 extern const instruction_func instruction_table[];
 extern const char *instruction_names[];
 extern const unsigned instruction_sizes[];
@@ -45,9 +46,16 @@ extern const unsigned instruction_sizes[];
 PREAMBLE
 
     for $instruction (@instructions) {
-        print $header "int inst_$instruction->{instruction}(struct vm_context_t *);\n"
+        print $header "const struct op_t *inst_$instruction->{instruction}(struct vm_context_t *, const struct op_t *);\n"
     }
 
+    # X-macro over every instruction, in opcode order, for building dispatch tables
+    print $header "\n#define INSTRUCTION_LIST(X) \\\n";
+    for $instruction (@instructions) {
+        print $header "\tX($instruction->{instruction}) \\\n";
+    }
+    print $header "\t/* end of list */\n";
+
     print $header <<'POSTAMBLE';
 
 #endif
@@ -0,0 +1,372 @@
+/*
+ *  numeric.c
+ *  dang
+ *
+=head1 NAME
+
+numeric
+
+=head1 INTRODUCTION
+
+Conversions between numbers and their decimal representations, which write into a caller-provided buffer rather than
+allocating.
+
+Integers are formatted two digits at a time from a lookup table.  Floats are formatted with the fewest significant
+digits that parse back to exactly the same value, so nothing is lost in a round trip through a string.  Most floats
+that turn up in practice have a short exact decimal form, which is found with plain floating point arithmetic; the
+rest fall back to the C library.
+
+Parsing handles plain decimal input itself, and leaves anything unusual (hexadecimal, octal, infinities, NaNs, and
+values that can't be converted exactly without extended precision) to strtol() and strtod(), so the results are the
+same as theirs.
+
+=head1 PUBLIC INTERFACE
+
+=over
+
+=cut
+ */
+
+#include <assert.h>
+#include <ctype.h>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "numeric.h"
+
+/* doubles represent every integer up to here exactly */
+#define NUMERIC_EXACT_INT_LIMIT     (UINT64_C(1) << 53)
+/* and every power of ten up to here */
+#define NUMERIC_EXACT_POWER_LIMIT   (22)
+
+static const char _numeric_digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const double _numeric_powers_of_ten[NUMERIC_EXACT_POWER_LIMIT + 1] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static char *_numeric_format_digits(char *, uint64_t);
+static int _numeric_shortest_fast(double, uint64_t *, int *);
+static void _numeric_shortest_slow(double, uint64_t *, int *);
+static size_t _numeric_place_digits(char *, uint64_t, int);
+
+/*
+=item numeric_format_int()
+
+=item numeric_format_float()
+
+Write the decimal representation of a number to a buffer of at least NUMERIC_BUFFER_SIZE bytes, followed by a '\0'.
+Return the number of bytes written, not counting the '\0'.
+
+Floats are written in plain decimal notation where that's reasonably short, and as C<d.ddde+XX> where it isn't.
+Integral floats have no fractional part, so 2.0 is written as "2".
+
+=cut
+ */
+size_t numeric_format_int(char *buffer, intptr_t value) {
+    assert(buffer != NULL);
+
+    char tmp[NUMERIC_BUFFER_SIZE];
+    char *end = tmp + sizeof(tmp);
+    char *start = _numeric_format_digits(end, value < 0 ? -(uint64_t) value : (uint64_t) value);
+    if (value < 0)  *--start = '-';
+
+    const size_t length = end - start;
+    memcpy(buffer, start, length);
+    buffer[length] = '\0';
+    return length;
+}
+
+size_t numeric_format_float(char *buffer, floatptr_t value) {
+    assert(buffer != NULL);
+
+    double v = value;
+    char *p = buffer;
+
+    if (isnan(v)) {
+        memcpy(buffer, "nan", sizeof("nan"));
+        return sizeof("nan") - 1;
+    }
+    if (signbit(v)) {
+        *p++ = '-';
+        v = -v;
+    }
+    if (isinf(v)) {
+        memcpy(p, "inf", sizeof("inf"));
+        return p - buffer + sizeof("inf") - 1;
+    }
+    if (v == 0) {
+        memcpy(p, "0", sizeof("0"));
+        return p - buffer + sizeof("0") - 1;
+    }
+
+    uint64_t digits;
+    int exponent;
+    if (! _numeric_shortest_fast(v, &digits, &exponent))  _numeric_shortest_slow(v, &digits, &exponent);
+
+    while (digits % 10 == 0) {
+        digits /= 10;
+        ++exponent;
+    }
+
+    return p - buffer + _numeric_place_digits(p, digits, exponent);
+}
+
+/*
+=item numeric_parse_int()
+
+=item numeric_parse_float()
+
+Parse a number from the start of a '\0'-terminated string, exactly as C<strtol(s, NULL, 0)> and C<strtod(s, NULL)>
+would.
+
+=cut
+ */
+intptr_t numeric_parse_int(const char *s) {
+    assert(s != NULL);
+
+    const char *p = s;
+    while (isspace((unsigned char) *p))  ++p;
+
+    int negative = 0;
+    if (*p == '-' || *p == '+')  negative = (*p++ == '-');
+
+    // leave hexadecimal, octal, zero and non-numbers to strtol
+    if (*p < '1' || *p > '9')  return strtol(s, NULL, 0);
+
+    uint64_t value = 0;
+    for (; *p >= '0' && *p <= '9'; ++p) {
+        const unsigned digit = *p - '0';
+        if (value > (UINT64_MAX - digit) / 10)  return strtol(s, NULL, 0);
+        value = value * 10 + digit;
+    }
+
+    if (negative) {
+        if (value > (uint64_t) INTPTR_MAX + 1)  return strtol(s, NULL, 0);
+        return value == 0 ? 0 : -(intptr_t) (value - 1) - 1;
+    }
+    else {
+        if (value > (uint64_t) INTPTR_MAX)  return strtol(s, NULL, 0);
+        return (intptr_t) value;
+    }
+}
+
+floatptr_t numeric_parse_float(const char *s) {
+    assert(s != NULL);
+
+    const char *p = s;
+    while (isspace((unsigned char) *p))  ++p;
+
+    int negative = 0;
+    if (*p == '-' || *p == '+')  negative = (*p++ == '-');
+
+    // leave hexadecimal, infinities, NaNs and non-numbers to strtod
+    if (! (isdigit((unsigned char) p[0]) || (p[0] == '.' && isdigit((unsigned char) p[1]))))  return strtod(s, NULL);
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))  return strtod(s, NULL);
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+
+    for (; isdigit((unsigned char) *p); ++p) {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa > NUMERIC_EXACT_INT_LIMIT)  return strtod(s, NULL);
+    }
+    if (*p == '.') {
+        for (++p; isdigit((unsigned char) *p); ++p) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa > NUMERIC_EXACT_INT_LIMIT)  return strtod(s, NULL);
+            --exponent;
+        }
+    }
+    if (*p == 'e' || *p == 'E') {
+        const char *e = p + 1;
+        int exponent_negative = 0;
+        if (*e == '-' || *e == '+')  exponent_negative = (*e++ == '-');
+
+        // an 'e' with no digits after it isn't part of the number
+        if (isdigit((unsigned char) *e)) {
+            int x = 0;
+            for (; isdigit((unsigned char) *e); ++e) {
+                x = x * 10 + (*e - '0');
+                if (x > 2 * NUMERIC_EXACT_POWER_LIMIT)  return strtod(s, NULL);
+            }
+            exponent += exponent_negative ? -x : x;
+        }
+    }
+
+    // both the mantissa and the power of ten are exact, so a single multiply or divide rounds correctly
+    double value = (double) mantissa;
+    if (exponent < 0) {
+        if (exponent < -NUMERIC_EXACT_POWER_LIMIT)  return strtod(s, NULL);
+        value /= _numeric_powers_of_ten[-exponent];
+    }
+    else if (exponent > 0) {
+        if (exponent > NUMERIC_EXACT_POWER_LIMIT)  return strtod(s, NULL);
+        value *= _numeric_powers_of_ten[exponent];
+    }
+
+    return negative ? -value : value;
+}
+
+/*
+=back
+
+=head1 PRIVATE INTERFACE
+
+=over
+
+=item _numeric_format_digits()
+
+Writes the decimal digits of value backwards from end, and returns a pointer to the first of them.
+
+=cut
+ */
+static char *_numeric_format_digits(char *end, uint64_t value) {
+    while (value >= 100) {
+        const unsigned pair = (value % 100) * 2;
+        value /= 100;
+        *--end = _numeric_digit_pairs[pair + 1];
+        *--end = _numeric_digit_pairs[pair];
+    }
+    if (value >= 10) {
+        const unsigned pair = value * 2;
+        *--end = _numeric_digit_pairs[pair + 1];
+        *--end = _numeric_digit_pairs[pair];
+    }
+    else {
+        *--end = '0' + value;
+    }
+    return end;
+}
+
+/*
+=item _numeric_shortest_fast()
+
+=item _numeric_shortest_slow()
+
+Find digits and exponent such that digits * 10^exponent is the shortest decimal that parses back to the positive,
+finite value v.  The fast version tries each number of decimal places in turn, and accepts the first candidate that
+converts back to v exactly.  This only works while the digits and the power of ten are both exact as doubles; if it
+fails, it returns zero and the slow version, which uses snprintf() and strtod(), has to be used instead.
+
+=cut
+ */
+static int _numeric_shortest_fast(double v, uint64_t *digits, int *exponent) {
+    for (int places = 0; places <= NUMERIC_EXACT_POWER_LIMIT; places++) {
+        const double scaled = v * _numeric_powers_of_ten[places];
+        if (scaled >= (double) NUMERIC_EXACT_INT_LIMIT)  return 0;
+
+        const double candidate = nearbyint(scaled);
+        if (candidate != 0 && (floatptr_t) (candidate / _numeric_powers_of_ten[places]) == (floatptr_t) v) {
+            *digits = (uint64_t) candidate;
+            *exponent = -places;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void _numeric_shortest_slow(double v, uint64_t *digits, int *exponent) {
+    char tmp[NUMERIC_BUFFER_SIZE];
+
+    // n.b. if fewer than 15 significant digits would do, rounding to 15 gives the same digits followed by zeroes,
+    // except where there are fewer than 15 digits of precision to begin with
+    const int first = (sizeof(floatptr_t) < sizeof(double) || v < DBL_MIN ? 0 : 14);
+    for (int precision = first; precision < 17; precision++) {
+        snprintf(tmp, sizeof(tmp), "%.*e", precision, v);
+        if ((floatptr_t) strtod(tmp, NULL) == (floatptr_t) v)  break;
+    }
+
+    // tmp is now "d.ddde+XX"
+    const char *p = tmp;
+    uint64_t d = 0;
+    int places = 0;
+    for (; *p != 'e'; ++p) {
+        if (*p == '.') {
+            places = -1;
+        }
+        else {
+            d = d * 10 + (*p - '0');
+            if (places < 0)  --places;
+        }
+    }
+    *digits = d;
+    *exponent = atoi(p + 1) + (places < 0 ? places + 1 : 0);
+}
+
+/*
+=item _numeric_place_digits()
+
+Writes digits * 10^exponent to buffer, followed by a '\0', and returns the number of bytes written not counting the
+'\0'.  digits must not be zero or end in a zero.
+
+=cut
+ */
+static size_t _numeric_place_digits(char *buffer, uint64_t digits, int exponent) {
+    char tmp[NUMERIC_BUFFER_SIZE];
+    char *end = tmp + sizeof(tmp);
+    const char *start = _numeric_format_digits(end, digits);
+    const int count = end - start;
+    const int point = count + exponent;    // how many of the digits come before the decimal point
+    char *p = buffer;
+
+    if (point > 0 && point <= 21) {
+        if (exponent >= 0) {
+            memcpy(p, start, count);
+            p += count;
+            memset(p, '0', exponent);
+            p += exponent;
+        }
+        else {
+            memcpy(p, start, point);
+            p += point;
+            *p++ = '.';
+            memcpy(p, start + point, count - point);
+            p += count - point;
+        }
+    }
+    else if (point <= 0 && point > -6) {
+        *p++ = '0';
+        *p++ = '.';
+        memset(p, '0', -point);
+        p += -point;
+        memcpy(p, start, count);
+        p += count;
+    }
+    else {
+        *p++ = start[0];
+        if (count > 1) {
+            *p++ = '.';
+            memcpy(p, start + 1, count - 1);
+            p += count - 1;
+        }
+        *p++ = 'e';
+        *p++ = (point - 1 < 0 ? '-' : '+');
+        const int x = abs(point - 1);
+        if (x < 10)  *p++ = '0';
+        p += numeric_format_int(p, x);
+    }
+
+    *p = '\0';
+    return p - buffer;
+}
+
+/*
+=back
+
+=cut
+ */
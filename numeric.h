@@ -0,0 +1,24 @@
+/*
+ *  numeric.h
+ *  dang
+ *
+ */
+
+#ifndef NUMERIC_H
+#define NUMERIC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "floatptr_t.h"
+
+/* big enough for anything numeric_format_int() or numeric_format_float() writes, including the terminating '\0' */
+#define NUMERIC_BUFFER_SIZE     (32)
+
+size_t numeric_format_int(char *, intptr_t);
+size_t numeric_format_float(char *, floatptr_t);
+
+intptr_t numeric_parse_int(const char *);
+floatptr_t numeric_parse_float(const char *);
+
+#endif
@@ -11,7 +11,30 @@ pool
 
 =head1 INTRODUCTION
 
-...
+A pool holds every object of one type, and hands out handles to them.  Objects live in fixed-size chunks, which are
+found through a directory with room for POOL_DIRECTORY_SIZE of them.  The pool grows a chunk at a time, and chunks
+are never moved or freed until the pool is destroyed, so a handle can be turned into its object with two loads (the
+directory entry, then the object) and without taking any lock, even while another thread is growing the pool.
+
+A directory entry is written once, with the free list mutex held, before any handle in its chunk is handed out, so
+anyone holding a handle is guaranteed to see it.  That's why the entries don't need to be atomic.
+
+Objects allocated without POOL_OBJECT_FLAG_SHARED come from chunks that belong to the allocating thread, and so to the
+vm_context_t it's running, since each context has a thread of its own.  The thread keeps its own free list for them, so
+they're allocated and released without any locking, and never share a chunk (or a cache line) with another thread's
+objects.  A thread only claims a new chunk when both its own free list and the pool's are empty, though: until then
+it reuses the pool's free objects through its magazine, so a program that keeps starting short-lived threads doesn't
+grow the pool by a chunk for each of them.  POOL_HANDLE_OWNER() says which thread, if any, a handle's chunk belongs to.  Any thread can still use any
+handle: one released by a thread that doesn't own it goes back to the pool through that thread's magazine instead.
+When a thread finishes, POOL_FLUSH() gives all its free objects back to the pool at once, and its chunks become
+ordinary ones.  Objects in them that are still referenced elsewhere aren't affected.
+
+Reference counts are atomic, so POOL_REFERENCE() and POOL_RELEASE() never lock the object, even when it's shared.
+Whichever release takes the count to zero is the only one left holding the object, so it can destroy it without a
+lock too.
+
+Each shared object normally gets a mutex of its own, allocated along with it.  A pool can instead lock its shared
+objects with a lock word kept in each object's wrapper, so that sharing an object allocates nothing.  See pool_lock_t.
 
 =cut
  */
@@ -20,23 +43,43 @@ pool
 #define POOL_H
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <errno.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <sched.h>
+#endif
 
 #include "debug.h"
 
 #define POOL_TYPE(type)                         struct type##_POOL
 #define POOL_WRAPPER_TYPE(type)                 struct POOLED_##type
+#define POOL_MAGAZINE_TYPE(type)                struct type##_POOL_MAGAZINE
+#define POOL_LOCAL_TYPE(type)                   struct type##_POOL_LOCAL
 
 #define POOL_OBJECT_STATE_INUSE                 UINTPTR_MAX
+#define POOL_OBJECT_STATE_CACHED                (UINTPTR_MAX - 1)
 #define POOL_OBJECT_FLAG_SHARED                 0x01u
 
 #define POOL_SINGLETON(type)                    g_##type##_POOL
-#define POOL_OBJECT(type, handle)               POOL_SINGLETON(type).m_items[(handle) - 1].m_object
-#define POOL_WRAPPER(type, handle)              POOL_SINGLETON(type).m_items[(handle) - 1]
+#define POOL_MAGAZINE(type)                     g_##type##_POOL_MAGAZINE
+#define POOL_LOCAL(type)                        g_##type##_POOL_LOCAL
+#define POOL_OBJECT(type, handle)               POOL_WRAPPER(type, handle).m_object
+#define POOL_WRAPPER(type, handle)              (*type##_POOL_WRAPPER(handle))
 
 #define POOL_HANDLE_IN_USE(type, handle)        (POOL_WRAPPER(type, handle).m_next_free == POOL_OBJECT_STATE_INUSE)
-#define POOL_HANDLE_VALID(type, handle)         ((handle) > 0 && (handle) <= POOL_SINGLETON(type).m_allocated_count)
+#define POOL_HANDLE_CACHED(type, handle)        (POOL_WRAPPER(type, handle).m_next_free == POOL_OBJECT_STATE_CACHED)
+#define POOL_HANDLE_VALID(type, handle)         ((handle) > 0 && (handle) <= POOL_ALLOCATED_COUNT(type))
+#define POOL_HANDLE_OWNER(type, handle)         atomic_load_explicit(                           \
+    &POOL_SINGLETON(type).m_chunk_owners[((handle) - 1) / type##_POOL_CHUNK_SIZE], memory_order_relaxed)
+
+#define POOL_ALLOCATED_COUNT(type)      \
+    atomic_load_explicit(&POOL_SINGLETON(type).m_allocated_count, memory_order_acquire)
 
 #define POOL_INIT(type)                         type##_POOL_INIT()
 #define POOL_DESTROY(type)                      type##_POOL_DESTROY()
@@ -46,6 +89,8 @@ pool
 #define POOL_RELEASE(type, handle)              type##_POOL_RELEASE(handle)
 #define POOL_LOCK(type, handle)                 type##_POOL_LOCK(handle)
 #define POOL_UNLOCK(type, handle)               type##_POOL_UNLOCK(handle)
+#define POOL_FLUSH(type)                        type##_POOL_FLUSH()
+#define POOL_MAGAZINE_STATS(type, stats)        type##_POOL_MAGAZINE_STATS(stats)
 
 #define POOL_basic_init(p, a)   (0)
 #define POOL_basic_destroy(p)   (0)
@@ -64,7 +109,8 @@ pool
 =item POOL_INITIAL_SIZE
 
 Define this to a suitable value before including pool.h in your header file.  If you don't,
-it defaults to 16.
+it defaults to 16.  It's also the number of objects in each chunk, so the pool grows by this
+many at a time.  Powers of two make handle lookups cheapest.
 
 =cut
 */
@@ -72,6 +118,174 @@ it defaults to 16.
 #define POOL_INITIAL_SIZE (16)
 #endif
 
+/*
+=item POOL_DIRECTORY_SIZE
+
+The most chunks a pool can have, so a pool can hold at most POOL_DIRECTORY_SIZE * POOL_INITIAL_SIZE
+objects.  The directory is a fixed part of the pool, so that growing the pool never moves it.
+
+=cut
+*/
+#ifndef POOL_DIRECTORY_SIZE
+#define POOL_DIRECTORY_SIZE (65536)
+#endif
+
+/*
+=item POOL_MAGAZINE_SIZE
+
+The most free objects each thread keeps to itself.  Allocating takes a free object from the
+calling thread's magazine, and releasing puts one back, without locking anything.  The pool's
+free list is only locked to refill an empty magazine, or to drain a full one, half a magazine
+at a time.  Unshared objects come from the thread's own chunks instead, so the magazine only
+holds shared objects, and objects released by a thread that doesn't own their chunk.
+
+Call POOL_FLUSH() from each thread before it finishes, to give its free objects back to the
+pool.
+
+=cut
+*/
+#ifndef POOL_MAGAZINE_SIZE
+#define POOL_MAGAZINE_SIZE (64)
+#endif
+
+/*
+=item pool_lock_t
+
+=item POOL_LOCK_MUTEX
+
+=item POOL_LOCK_INLINE
+
+A pool whose POOL_HEADER_CONTENTS() is given POOL_LOCK_MUTEX allocates a mutex of mutex_type for
+each shared object.  One given POOL_LOCK_INLINE locks each shared object with a pool_lock_t
+instead, kept in the object's wrapper where the mutex pointer would otherwise be, so sharing an
+object allocates nothing and costs no memory.
+
+A pool_lock_t is always recursive, whatever the mutex_type.  Its word holds POOL_LOCK_SHARED for
+as long as the object is shared, the holding thread's owner token while it's locked, and
+POOL_LOCK_CONTENDED while other threads might be waiting for it.  Only a contended unlock makes
+a system call, to wake a waiter: waiting threads sleep on a futex on Linux, and just yield
+elsewhere.  m_depth is only ever touched by the thread holding the lock.
+
+There's no condition variable to go with a pool_lock_t, so channels, which wait on their mutex,
+can't use one.
+
+=cut
+*/
+#define POOL_LOCK_MUTEX         (0)
+#define POOL_LOCK_INLINE        (1)
+
+#define POOL_LOCK_SHARED        (UINT32_C(1) << 31)
+#define POOL_LOCK_CONTENDED     (UINT32_C(1) << 30)
+#define POOL_LOCK_OWNER_MASK    (POOL_LOCK_CONTENDED - 1)
+
+typedef struct pool_lock_t {
+    _Atomic uint32_t m_word;
+    uint32_t m_depth;
+} pool_lock_t;
+
+static inline void _pool_lock_wait(pool_lock_t *lock, uint32_t word) {
+#ifdef __linux__
+    syscall(SYS_futex, (uint32_t *) &lock->m_word, FUTEX_WAIT_PRIVATE, word, NULL, NULL, 0);
+#else
+    (void) lock;
+    (void) word;
+    sched_yield();
+#endif
+}
+
+static inline void _pool_lock_wake(pool_lock_t *lock) {
+#ifdef __linux__
+    syscall(SYS_futex, (uint32_t *) &lock->m_word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+    (void) lock;
+#endif
+}
+
+/*
+=item pool_lock_acquire()
+
+=item pool_lock_release()
+
+Lock and unlock a pool_lock_t on behalf of owner, which must be non-zero and fit in
+POOL_LOCK_OWNER_MASK.  Both do nothing if the object isn't shared.  Return 0 on success, or
+EPERM if owner doesn't hold the lock it's releasing.
+
+=cut
+*/
+static inline int pool_lock_acquire(pool_lock_t *lock, uint32_t owner) {
+    uint32_t word = atomic_load_explicit(&lock->m_word, memory_order_relaxed);
+    if (0 == (word & POOL_LOCK_SHARED))  return 0;
+
+    /* nobody else can have put our token there, so we already hold it */
+    if ((word & POOL_LOCK_OWNER_MASK) == owner) {
+        ++lock->m_depth;
+        return 0;
+    }
+
+    word = POOL_LOCK_SHARED;
+    if (atomic_compare_exchange_strong_explicit(&lock->m_word, &word, POOL_LOCK_SHARED | owner,
+                                                memory_order_acquire, memory_order_relaxed)) {
+        lock->m_depth = 1;
+        return 0;
+    }
+
+    for (;;) {
+        if (0 == (word & POOL_LOCK_OWNER_MASK)) {
+            /* we can't tell whether anyone else is still waiting, so keep it marked contended */
+            if (atomic_compare_exchange_weak_explicit(&lock->m_word, &word,
+                                                      word | POOL_LOCK_CONTENDED | owner,
+                                                      memory_order_acquire, memory_order_relaxed)) {
+                lock->m_depth = 1;
+                return 0;
+            }
+        }
+        else if ((word & POOL_LOCK_CONTENDED)
+                 || atomic_compare_exchange_weak_explicit(&lock->m_word, &word,
+                                                          word | POOL_LOCK_CONTENDED,
+                                                          memory_order_relaxed, memory_order_relaxed)) {
+            _pool_lock_wait(lock, word | POOL_LOCK_CONTENDED);
+            word = atomic_load_explicit(&lock->m_word, memory_order_relaxed);
+        }
+    }
+}
+
+static inline int pool_lock_release(pool_lock_t *lock, uint32_t owner) {
+    uint32_t word = atomic_load_explicit(&lock->m_word, memory_order_relaxed);
+    if (0 == (word & POOL_LOCK_SHARED))  return 0;
+    if ((word & POOL_LOCK_OWNER_MASK) != owner)  return EPERM;
+
+    if (--lock->m_depth > 0)  return 0;
+
+    word = atomic_exchange_explicit(&lock->m_word, POOL_LOCK_SHARED, memory_order_release);
+    if (word & POOL_LOCK_CONTENDED)  _pool_lock_wake(lock);
+    return 0;
+}
+
+/*
+=item pool_magazine_stats_t
+
+=item POOL_MAGAZINE_STATS()
+
+Counts of allocations and releases, and of the refills and drains that moved objects between
+the free list and threads' magazines, for tuning POOL_MAGAZINE_SIZE.  Also counts the chunks
+threads have claimed for their unshared objects, and the free objects they gave back when they
+finished.  A thread's allocations and releases are added to the totals whenever its magazine
+next refills or drains, so the totals can lag behind a little.  POOL_MAGAZINE_STATS() copies
+the totals into a pool_magazine_stats_t, and returns 0 on success.
+
+=cut
+*/
+typedef struct pool_magazine_stats_t {
+    size_t m_allocations;
+    size_t m_releases;
+    size_t m_refills;
+    size_t m_refilled;
+    size_t m_drains;
+    size_t m_drained;
+    size_t m_claims;
+    size_t m_returned;
+} pool_magazine_stats_t;
+
 /*
 =item POOL_HEADER_CONTENTS()
 
@@ -79,34 +293,76 @@ Call this from your header file
 
 =cut
  */
-#define POOL_HEADER_CONTENTS(type, handle_type, mutex_type, init, destroy)                      \
+#define POOL_HEADER_CONTENTS(type, handle_type, mutex_type, lock_kind, init, destroy)           \
 POOL_TYPE(type) {                                                                               \
-    size_t                  m_allocated_count;                                                  \
+    atomic_size_t           m_allocated_count;                                                  \
     size_t                  m_count;                                                            \
     size_t                  m_free_count;                                                       \
-    POOL_WRAPPER_TYPE(type) *m_items;                                                           \
+    POOL_WRAPPER_TYPE(type) *m_chunks[POOL_DIRECTORY_SIZE];                                     \
+    _Atomic uint32_t        m_chunk_owners[POOL_DIRECTORY_SIZE];                                \
+    _Atomic uint32_t        m_owner_count;                                                      \
     handle_type             m_free_list_head;                                                   \
     pthread_mutex_t         m_free_list_mutex;                                                  \
     pthread_mutexattr_t     m_shared_mutex_attr;                                                \
+    pool_magazine_stats_t   m_magazine_stats;                                                   \
+};                                                                                              \
+                                                                                                \
+POOL_MAGAZINE_TYPE(type) {                                                                      \
+    size_t                  m_count;                                                            \
+    size_t                  m_allocations;                                                      \
+    size_t                  m_releases;                                                         \
+    handle_type             m_handles[POOL_MAGAZINE_SIZE];                                      \
+};                                                                                              \
+                                                                                                \
+POOL_LOCAL_TYPE(type) {                                                                         \
+    uint32_t                m_owner;                                                            \
+    size_t                  m_count;                                                            \
+    handle_type             m_head;                                                             \
+    handle_type             m_tail;                                                             \
 };                                                                                              \
                                                                                                 \
 POOL_WRAPPER_TYPE(type) {                                                                       \
     type    m_object;                                                                           \
-    size_t  m_references;                                                                       \
-    pthread_mutex_t *m_mutex;                                                                   \
+    atomic_size_t m_references;                                                                 \
+    union {                                                                                     \
+        pthread_mutex_t *m_mutex;                                                               \
+        pool_lock_t m_lock;                                                                     \
+    };                                                                                          \
     handle_type   m_next_free;                                                                  \
 };                                                                                              \
                                                                                                 \
-extern POOL_TYPE(type) POOL_SINGLETON(type);                                                    \
+enum { type##_POOL_CHUNK_SIZE = POOL_INITIAL_SIZE, type##_POOL_INLINE_LOCK = (lock_kind) };     \
                                                                                                 \
-static inline void _##type##_POOL_ADD_TO_FREE_LIST(handle_type);                                \
+extern POOL_TYPE(type) POOL_SINGLETON(type);                                                    \
+extern _Thread_local POOL_MAGAZINE_TYPE(type) POOL_MAGAZINE(type);                              \
+extern _Thread_local POOL_LOCAL_TYPE(type) POOL_LOCAL(type);                                    \
+                                                                                                \
+static inline int _##type##_POOL_REFILL(int);                                                   \
+static inline int _##type##_POOL_DRAIN(size_t);                                                 \
+static inline void _##type##_POOL_ADD_STATS_UNLOCKED(POOL_MAGAZINE_TYPE(type) *);               \
+static inline handle_type _##type##_POOL_ALLOCATE_LOCAL(void);                                  \
+static inline void _##type##_POOL_FREE(handle_type);                                            \
+static inline int _##type##_POOL_DISOWN(void);                                                  \
+static inline uint32_t _##type##_POOL_OWNER(void);                                              \
+static inline int _##type##_POOL_SHARE(handle_type);                                            \
+static inline void _##type##_POOL_UNSHARE(handle_type);                                         \
 static inline handle_type _##type##_POOL_FIND_FREE_SEQUENCE_UNLOCKED(size_t);                   \
+static inline handle_type _##type##_POOL_GROW_UNLOCKED(size_t);                                 \
+                                                                                                \
+static inline POOL_WRAPPER_TYPE(type) *type##_POOL_WRAPPER(handle_type handle) {                \
+    const size_t index = handle - 1;                                                            \
+    POOL_WRAPPER_TYPE(type) *chunk = POOL_SINGLETON(type).m_chunks[index / type##_POOL_CHUNK_SIZE];\
+    return &chunk[index % type##_POOL_CHUNK_SIZE];                                              \
+}                                                                                               \
                                                                                                 \
 static inline int type##_POOL_LOCK(handle_type handle) {                                        \
     assert(POOL_HANDLE_VALID(type, handle));                                                    \
     assert(POOL_WRAPPER(type, handle).m_next_free == POOL_OBJECT_STATE_INUSE);                   \
                                                                                                 \
-    if (POOL_WRAPPER(type, handle).m_mutex != NULL) {                                           \
+    if (type##_POOL_INLINE_LOCK) {                                                              \
+        return pool_lock_acquire(&POOL_WRAPPER(type, handle).m_lock, _##type##_POOL_OWNER());   \
+    }                                                                                           \
+    else if (POOL_WRAPPER(type, handle).m_mutex != NULL) {                                      \
         return pthread_mutex_lock(POOL_WRAPPER(type, handle).m_mutex);                          \
     }                                                                                           \
     else {                                                                                      \
@@ -118,7 +374,10 @@ static inline int type##_POOL_UNLOCK(handle_type handle) {
     assert(POOL_HANDLE_VALID(type, handle));                                                    \
     assert(POOL_WRAPPER(type, handle).m_next_free == POOL_OBJECT_STATE_INUSE);                   \
                                                                                                 \
-    if (POOL_WRAPPER(type, handle).m_mutex != NULL) {                                           \
+    if (type##_POOL_INLINE_LOCK) {                                                              \
+        return pool_lock_release(&POOL_WRAPPER(type, handle).m_lock, _##type##_POOL_OWNER());   \
+    }                                                                                           \
+    else if (POOL_WRAPPER(type, handle).m_mutex != NULL) {                                      \
         return pthread_mutex_unlock(POOL_WRAPPER(type, handle).m_mutex);                        \
     }                                                                                           \
     else {                                                                                      \
@@ -127,32 +386,31 @@ static inline int type##_POOL_UNLOCK(handle_type handle) {
 }                                                                                               \
                                                                                                 \
 static inline int type##_POOL_INIT(void) {                                                      \
-    if (    NULL != (POOL_SINGLETON(type).m_items =                                             \
-                calloc(POOL_INITIAL_SIZE, sizeof(POOL_WRAPPER_TYPE(type))))) {                  \
-        POOL_SINGLETON(type).m_allocated_count = POOL_INITIAL_SIZE;                             \
-        POOL_SINGLETON(type).m_count = 0;                                                       \
-        if (0 == pthread_mutex_init(&POOL_SINGLETON(type).m_free_list_mutex, NULL)) {           \
-            if (0 == pthread_mutex_lock(&POOL_SINGLETON(type).m_free_list_mutex)) {             \
-                POOL_SINGLETON(type).m_free_list_head = 1;                                      \
-                for (handle_type i = 1; i < POOL_SINGLETON(type).m_allocated_count; i++) {      \
-                    POOL_WRAPPER(type, i).m_next_free = i + 1;                                  \
-                }                                                                               \
-                POOL_WRAPPER(type, POOL_SINGLETON(type).m_allocated_count).m_next_free = 0;     \
-                POOL_SINGLETON(type).m_free_count = POOL_INITIAL_SIZE;                          \
-                pthread_mutexattr_init(&POOL_SINGLETON(type).m_shared_mutex_attr);              \
-                pthread_mutexattr_settype(&POOL_SINGLETON(type).m_shared_mutex_attr,            \
-                    mutex_type);                                                                \
+    atomic_init(&POOL_SINGLETON(type).m_allocated_count, 0);                                    \
+    POOL_SINGLETON(type).m_count = 0;                                                           \
+    POOL_SINGLETON(type).m_magazine_stats = (pool_magazine_stats_t) {0};                        \
+    if (0 == pthread_mutex_init(&POOL_SINGLETON(type).m_free_list_mutex, NULL)) {               \
+        if (0 == pthread_mutex_lock(&POOL_SINGLETON(type).m_free_list_mutex)) {                 \
+            if (0 == _##type##_POOL_GROW_UNLOCKED(POOL_INITIAL_SIZE)) {                         \
                 pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                  \
-                return 0;                                                                       \
-            }                                                                                   \
-            else {                                                                              \
                 pthread_mutex_destroy(&POOL_SINGLETON(type).m_free_list_mutex);                 \
-                free(POOL_SINGLETON(type).m_items);                                             \
                 return -1;                                                                      \
             }                                                                                   \
+            const size_t allocated_count = POOL_ALLOCATED_COUNT(type);                          \
+            POOL_SINGLETON(type).m_free_list_head = 1;                                          \
+            for (handle_type i = 1; i < allocated_count; i++) {                                 \
+                POOL_WRAPPER(type, i).m_next_free = i + 1;                                      \
+            }                                                                                   \
+            POOL_WRAPPER(type, allocated_count).m_next_free = 0;                                \
+            POOL_SINGLETON(type).m_free_count = allocated_count;                                \
+            pthread_mutexattr_init(&POOL_SINGLETON(type).m_shared_mutex_attr);                  \
+            pthread_mutexattr_settype(&POOL_SINGLETON(type).m_shared_mutex_attr,                \
+                mutex_type);                                                                    \
+            pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                      \
+            return 0;                                                                           \
         }                                                                                       \
         else {                                                                                  \
-            free(POOL_SINGLETON(type).m_items);                                                 \
+            pthread_mutex_destroy(&POOL_SINGLETON(type).m_free_list_mutex);                     \
             return -1;                                                                          \
         }                                                                                       \
     }                                                                                           \
@@ -163,25 +421,41 @@ static inline int type##_POOL_INIT(void) {
                                                                                                 \
 static inline int type##_POOL_DESTROY(void) {                                                   \
     if (0 == pthread_mutex_lock(&POOL_SINGLETON(type).m_free_list_mutex)) {                     \
-        for (handle_type i = 1; i <= POOL_SINGLETON(type).m_allocated_count; i++) {             \
+        const size_t allocated_count = POOL_ALLOCATED_COUNT(type);                              \
+        const pool_magazine_stats_t *stats = &POOL_SINGLETON(type).m_magazine_stats;            \
+                                                                                                \
+        /* the calling thread's magazine and free list are freed along with their chunks */     \
+        _##type##_POOL_ADD_STATS_UNLOCKED(&POOL_MAGAZINE(type));                                \
+        POOL_MAGAZINE(type).m_count = 0;                                                        \
+        POOL_LOCAL(type) = (POOL_LOCAL_TYPE(type)) {0};                                         \
+        debug("%s pool: %zu allocations, %zu releases, "                                        \
+              "%zu refills (%zu objects), %zu drains (%zu objects), "                           \
+              "%zu chunks claimed (%zu objects returned)\n", #type,                             \
+              stats->m_allocations, stats->m_releases,                                          \
+              stats->m_refills, stats->m_refilled, stats->m_drains, stats->m_drained,           \
+              stats->m_claims, stats->m_returned);                                              \
+        (void) stats;                                                                           \
+        for (handle_type i = 1; i <= allocated_count; i++) {                                    \
             if (POOL_HANDLE_IN_USE(type, i)) {                                                  \
                 if (0 == POOL_LOCK(type, i)) {                                                  \
                     destroy(&POOL_OBJECT(type, i));                                             \
-                    if (POOL_WRAPPER(type, i).m_mutex != NULL) {                                \
-                        pthread_mutex_t *tmp = POOL_WRAPPER(type, i).m_mutex;                   \
-                        POOL_WRAPPER(type, i).m_mutex = NULL;                                   \
-                        pthread_mutex_unlock(tmp);                                              \
-                        pthread_mutex_destroy(tmp);                                             \
-                        free(tmp);                                                              \
-                    }                                                                           \
+                    POOL_UNLOCK(type, i);                                                       \
+                    _##type##_POOL_UNSHARE(i);                                                  \
                 }                                                                               \
                 else {                                                                          \
                     debug("failed to lock %s handle %"PRIuPTR"\n", #type, i);                   \
                 }                                                                               \
             }                                                                                   \
         }                                                                                       \
-        free(POOL_SINGLETON(type).m_items);                                                     \
-        POOL_SINGLETON(type).m_allocated_count = 0;                                             \
+        atomic_store_explicit(&POOL_SINGLETON(type).m_allocated_count, 0, memory_order_release);\
+        _Atomic uint32_t *owners = POOL_SINGLETON(type).m_chunk_owners;                         \
+        for (size_t i = 0; i < allocated_count / type##_POOL_CHUNK_SIZE; i++) {                 \
+            free(POOL_SINGLETON(type).m_chunks[i]);                                             \
+            POOL_SINGLETON(type).m_chunks[i] = NULL;                                            \
+            atomic_store_explicit(&owners[i], 0, memory_order_relaxed);                         \
+        }                                                                                       \
+        atomic_store_explicit(&POOL_SINGLETON(type).m_owner_count, 0, memory_order_relaxed);    \
+        POOL_SINGLETON(type).m_free_list_head = 0;                                              \
         POOL_SINGLETON(type).m_free_count = 0;                                                  \
         POOL_SINGLETON(type).m_count = 0;                                                       \
         pthread_mutexattr_destroy(&POOL_SINGLETON(type).m_shared_mutex_attr);                   \
@@ -195,149 +469,104 @@ static inline int type##_POOL_DESTROY(void) {
 }                                                                                               \
                                                                                                 \
 static inline handle_type type##_POOL_ALLOCATE(flags8_t flags) {                                \
-    if (0 == pthread_mutex_lock(&POOL_SINGLETON(type).m_free_list_mutex)) {                     \
-        handle_type handle;                                                                     \
-                                                                                                \
-        if (POOL_SINGLETON(type).m_free_count > 0) {                                            \
-            assert(POOL_SINGLETON(type).m_free_list_head != 0);                                 \
-            handle = POOL_SINGLETON(type).m_free_list_head;                                     \
-            POOL_SINGLETON(type).m_free_list_head =                                             \
-                POOL_WRAPPER(type, handle).m_next_free;                                         \
-            POOL_SINGLETON(type).m_free_count--;                                                \
-                                                                                                \
-            pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                      \
-        }                                                                                       \
-        else {                                                                                  \
-            handle = POOL_SINGLETON(type).m_allocated_count + 1;                                \
-                                                                                                \
-            size_t new_size = 2 * POOL_SINGLETON(type).m_allocated_count;                       \
-            POOL_WRAPPER_TYPE(type) *tmp =                                                      \
-                calloc(new_size, sizeof(POOL_WRAPPER_TYPE(type)));                              \
-            if (tmp == NULL)  {                                                                 \
-                pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                  \
-                return 0;                                                                       \
-            }                                                                                   \
-            memcpy( tmp,                                                                        \
-                    POOL_SINGLETON(type).m_items,                                               \
-                    POOL_SINGLETON(type).m_allocated_count * sizeof(*tmp));                     \
-            free(POOL_SINGLETON(type).m_items);                                                 \
-            POOL_SINGLETON(type).m_items = tmp;                                                 \
-            POOL_SINGLETON(type).m_allocated_count = new_size;                                  \
-                                                                                                \
-            POOL_SINGLETON(type).m_free_list_head = handle + 1;                                 \
-            for (   handle_type i = POOL_SINGLETON(type).m_free_list_head;                      \
-                    i < new_size;                                                               \
-                    i++) {                                                                      \
-                POOL_WRAPPER(type, i).m_next_free = i + 1;                                      \
-            }                                                                                   \
-            POOL_WRAPPER(type, POOL_SINGLETON(type).m_allocated_count).m_next_free = 0;         \
-            POOL_SINGLETON(type).m_free_count = POOL_SINGLETON(type).m_allocated_count - handle;\
+    POOL_MAGAZINE_TYPE(type) *magazine = &POOL_MAGAZINE(type);                                  \
+    handle_type handle;                                                                         \
                                                                                                 \
-            pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                      \
-        }                                                                                       \
+    if (flags & POOL_OBJECT_FLAG_SHARED) {                                                      \
+        if (magazine->m_count == 0 && 0 != _##type##_POOL_REFILL(1))  return 0;                 \
+        handle = magazine->m_handles[--magazine->m_count];                                      \
+        assert(POOL_HANDLE_CACHED(type, handle));                                               \
+    }                                                                                           \
+    else {                                                                                      \
+        if (0 == (handle = _##type##_POOL_ALLOCATE_LOCAL()))  return 0;                         \
+    }                                                                                           \
                                                                                                 \
-        assert(POOL_WRAPPER(type, handle).m_references == 0);                                   \
-        POOL_WRAPPER(type, handle).m_references = 1;                                            \
-        init(&POOL_OBJECT(type, handle));                                                       \
-                                                                                                \
-        if (flags & POOL_OBJECT_FLAG_SHARED) {                                                  \
-            POOL_WRAPPER(type, handle).m_mutex = calloc(1, sizeof(pthread_mutex_t));            \
-            assert(POOL_WRAPPER(type, handle).m_mutex != NULL);                                 \
-            if (0 != pthread_mutex_init(POOL_WRAPPER(type, handle).m_mutex,                     \
-                                        &POOL_SINGLETON(type).m_shared_mutex_attr)) {           \
-                debug("pthread_mutex_init failed. "                                             \
-                      "Converting %s handle %"PRIuPTR" to unshared\n", #type, handle);          \
-                free(POOL_WRAPPER(type, handle).m_mutex);                                       \
-                POOL_WRAPPER(type, handle).m_mutex = NULL;                                      \
-            }                                                                                   \
-        }                                                                                       \
+    ++magazine->m_allocations;                                                                  \
+    POOL_WRAPPER(type, handle).m_next_free = POOL_OBJECT_STATE_INUSE;                           \
                                                                                                 \
-        POOL_WRAPPER(type, handle).m_next_free = POOL_OBJECT_STATE_INUSE;                        \
-        POOL_SINGLETON(type).m_count++;                                                         \
+    atomic_size_t *references = &POOL_WRAPPER(type, handle).m_references;                       \
+    assert(atomic_load_explicit(references, memory_order_relaxed) == 0);                        \
+    atomic_store_explicit(references, 1, memory_order_relaxed);                                 \
+    init(&POOL_OBJECT(type, handle));                                                           \
                                                                                                 \
-        return handle;                                                                          \
-    }                                                                                           \
-    else {                                                                                      \
-        debug("couldn't lock free list mutex\n");                                               \
-        return 0;                                                                               \
+    if ((flags & POOL_OBJECT_FLAG_SHARED) && 0 != _##type##_POOL_SHARE(handle)) {               \
+        debug("couldn't set up a mutex. "                                                       \
+              "Converting %s handle %"PRIuPTR" to unshared\n", #type, handle);                  \
     }                                                                                           \
+                                                                                                \
+    return handle;                                                                              \
 }                                                                                               \
                                                                                                 \
 static inline handle_type type##_POOL_ALLOCATE_MANY(size_t many, flags8_t flags) {              \
     assert(many > 0);                                                                           \
+    if (many == 1)  return type##_POOL_ALLOCATE(flags);                                         \
+                                                                                                \
     if (0 == pthread_mutex_lock(&POOL_SINGLETON(type).m_free_list_mutex)) {                     \
         handle_type alloc_start = _##type##_POOL_FIND_FREE_SEQUENCE_UNLOCKED(many);             \
                                                                                                 \
         if (alloc_start != 0) {                                                                 \
             /* found a sufficiently long sequence of free items - remove them from free list */ \
-            handle_type prev = alloc_start - 1;                                                 \
-            while (prev > 0 && POOL_HANDLE_IN_USE(type, prev))  --prev;                         \
-                                                                                                \
-            if (prev == 0) {                                                                    \
-                POOL_SINGLETON(type).m_free_list_head =                                         \
-                    POOL_WRAPPER(type, alloc_start + many - 1).m_next_free;                     \
-            }                                                                                   \
-            else {                                                                              \
-                POOL_WRAPPER(type, prev).m_next_free =                                          \
-                    POOL_WRAPPER(type, alloc_start + many - 1).m_next_free;                     \
+            handle_type prev = 0, i = POOL_SINGLETON(type).m_free_list_head;                    \
+            size_t removed = 0;                                                                 \
+            while (i != 0 && removed < many) {                                                  \
+                handle_type next = POOL_WRAPPER(type, i).m_next_free;                           \
+                if (i >= alloc_start && i < alloc_start + many) {                               \
+                    if (prev == 0) {                                                            \
+                        POOL_SINGLETON(type).m_free_list_head = next;                           \
+                    }                                                                           \
+                    else {                                                                      \
+                        POOL_WRAPPER(type, prev).m_next_free = next;                            \
+                    }                                                                           \
+                    ++removed;                                                                  \
+                }                                                                               \
+                else {                                                                          \
+                    prev = i;                                                                   \
+                }                                                                               \
+                i = next;                                                                       \
             }                                                                                   \
+            assert(removed == many);                                                            \
+            POOL_SINGLETON(type).m_free_count -= many;                                          \
         }                                                                                       \
         else {                                                                                  \
-            /* didn't find enough sequential free items - grow the list */                      \
-            alloc_start = POOL_SINGLETON(type).m_allocated_count + 1;                           \
-                                                                                                \
-            size_t new_size = POOL_SINGLETON(type).m_allocated_count;                           \
-            while (new_size < POOL_SINGLETON(type).m_allocated_count + many) {                  \
-                new_size += POOL_SINGLETON(type).m_allocated_count;                             \
-            }                                                                                   \
-                                                                                                \
-            POOL_WRAPPER_TYPE(type) *tmp = calloc(new_size, sizeof(*tmp));                      \
-            if (tmp == NULL) {                                                                  \
+            /* didn't find enough sequential free items - grow the pool */                      \
+            alloc_start = _##type##_POOL_GROW_UNLOCKED(many);                                   \
+            if (alloc_start == 0) {                                                             \
                 pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                  \
                 return 0;                                                                       \
             }                                                                                   \
-            memcpy( tmp,                                                                        \
-                   POOL_SINGLETON(type).m_items,                                                \
-                   POOL_SINGLETON(type).m_allocated_count * sizeof(*tmp));                      \
-            free(POOL_SINGLETON(type).m_items);                                                 \
-            POOL_SINGLETON(type).m_items = tmp;                                                 \
-            POOL_SINGLETON(type).m_allocated_count = new_size;                                  \
-                                                                                                \
-            /* find and attach the end of the free list */                                      \
-            if (POOL_SINGLETON(type).m_free_list_head == 0) {                                   \
-                POOL_SINGLETON(type).m_free_list_head = alloc_start + many;                     \
-            }                                                                                   \
-            else {                                                                              \
-                handle_type i = POOL_SINGLETON(type).m_free_list_head;                          \
-                while (POOL_WRAPPER(type, i).m_next_free != 0) {                                \
-                    i = POOL_WRAPPER(type, i).m_next_free;                                      \
+                                                                                                \
+            const size_t new_size = POOL_ALLOCATED_COUNT(type);                                 \
+            if (alloc_start + many <= new_size) {                                               \
+                /* put the leftover new items on the front of the free list */                  \
+                for (handle_type i = alloc_start + many; i < new_size; i++) {                   \
+                    POOL_WRAPPER(type, i).m_next_free = i + 1;                                  \
                 }                                                                               \
-                POOL_WRAPPER(type, i).m_next_free = alloc_start + many;                         \
+                POOL_WRAPPER(type, new_size).m_next_free = POOL_SINGLETON(type).m_free_list_head;\
+                POOL_SINGLETON(type).m_free_list_head = alloc_start + many;                     \
+                POOL_SINGLETON(type).m_free_count += new_size - (alloc_start + many) + 1;       \
             }                                                                                   \
+        }                                                                                       \
                                                                                                 \
-            /* add the leftover new items to the end of the free list */                        \
-            for (handle_type i = alloc_start + many; i < new_size; i++) {                       \
-                POOL_WRAPPER(type, i).m_next_free = i + 1;                                      \
-            }                                                                                   \
-            POOL_WRAPPER(type, new_size).m_next_free = 0;                                       \
-            POOL_SINGLETON(type).m_free_count = new_size - (alloc_start + many);                \
+        /* claim them before letting go of the free list */                                     \
+        for (handle_type i = alloc_start; i < alloc_start + many; i++) {                        \
+            POOL_WRAPPER(type, i).m_next_free = POOL_OBJECT_STATE_INUSE;                         \
         }                                                                                       \
+        POOL_SINGLETON(type).m_count += many;                                                   \
+        POOL_SINGLETON(type).m_magazine_stats.m_allocations += many;                            \
         pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                          \
                                                                                                 \
         /* initialise the new items */                                                          \
         for (handle_type i = alloc_start; i < alloc_start + many; i++) {                        \
-            assert(POOL_WRAPPER(type, i).m_references == 0);                                    \
+            atomic_size_t *references = &POOL_WRAPPER(type, i).m_references;                    \
+            assert(atomic_load_explicit(references, memory_order_relaxed) == 0);                \
                                                                                                 \
-            if (flags & POOL_OBJECT_FLAG_SHARED) {                                              \
-                POOL_WRAPPER(type, i).m_mutex = calloc(1, sizeof(pthread_mutex_t));             \
-                assert(POOL_WRAPPER(type, i).m_mutex != NULL);                                  \
-                pthread_mutex_init(POOL_WRAPPER(type, i).m_mutex,                               \
-                    &POOL_SINGLETON(type).m_shared_mutex_attr);                                 \
+            if ((flags & POOL_OBJECT_FLAG_SHARED) && 0 != _##type##_POOL_SHARE(i)) {            \
+                debug("couldn't set up a mutex. "                                               \
+                      "Converting %s handle %"PRIuPTR" to unshared\n", #type, i);               \
             }                                                                                   \
                                                                                                 \
-            POOL_WRAPPER(type, i).m_next_free = POOL_OBJECT_STATE_INUSE;                         \
             if (0 == POOL_LOCK(type, i)) {                                                      \
-                POOL_WRAPPER(type, i).m_references = 1;                                         \
+                atomic_store_explicit(references, 1, memory_order_relaxed);                     \
                 init(&POOL_OBJECT(type, i));                                                    \
                 POOL_UNLOCK(type, i);                                                           \
             }                                                                                   \
@@ -347,57 +576,53 @@ static inline handle_type type##_POOL_ALLOCATE_MANY(size_t many, flags8_t flags)
             }                                                                                   \
         }                                                                                       \
                                                                                                 \
-        POOL_SINGLETON(type).m_count += many;                                                   \
-                                                                                                \
         return alloc_start;                                                                     \
     }                                                                                           \
     else {                                                                                      \
         return 0;                                                                               \
     }                                                                                           \
 }                                                                                               \
-                                                                                                \
 static inline handle_type type##_POOL_REFERENCE(handle_type handle) {                           \
     assert(POOL_HANDLE_VALID(type, handle));                                                    \
-    if (0 == POOL_LOCK(type, handle)) {                                                         \
-        assert(POOL_HANDLE_IN_USE(type, handle));                                               \
-        assert(POOL_WRAPPER(type, handle).m_references > 0);                                    \
-        ++POOL_WRAPPER(type,handle).m_references;                                               \
-        POOL_UNLOCK(type, handle);                                                              \
-        return handle;                                                                          \
-    }                                                                                           \
-    else {                                                                                      \
-        return 0;                                                                               \
-    }                                                                                           \
+    assert(POOL_HANDLE_IN_USE(type, handle));                                                   \
+    atomic_size_t *references = &POOL_WRAPPER(type, handle).m_references;                       \
+    size_t old = atomic_fetch_add_explicit(references, 1, memory_order_relaxed);                \
+    assert(old > 0);                                                                            \
+    (void) old;                                                                                 \
+    return handle;                                                                              \
 }                                                                                               \
                                                                                                 \
 static inline int type##_POOL_RELEASE(handle_type handle) {                                     \
     assert(POOL_HANDLE_VALID(type, handle));                                                    \
-    if (0 == POOL_LOCK(type, handle)) {                                                         \
-        assert(POOL_HANDLE_IN_USE(type, handle));                                               \
-        assert(POOL_WRAPPER(type, handle).m_references > 0);                                    \
-        if (POOL_WRAPPER(type, handle).m_references == 1) {                                     \
-            destroy(&POOL_OBJECT(type, handle));                                                \
-            if (POOL_WRAPPER(type, handle).m_mutex != NULL) {                                   \
-                pthread_mutex_t *tmp = POOL_WRAPPER(type, handle).m_mutex;                      \
-                POOL_WRAPPER(type, handle).m_mutex = NULL;                                      \
-                pthread_mutex_unlock(tmp);                                                      \
-                pthread_mutex_destroy(tmp);                                                     \
-                free(tmp);                                                                      \
-            }                                                                                   \
-            POOL_WRAPPER(type, handle).m_references = 0;                                        \
-            _##type##_POOL_ADD_TO_FREE_LIST(handle);                                            \
-            POOL_SINGLETON(type).m_count--;                                                     \
-        }                                                                                       \
-        else {                                                                                  \
-            --POOL_WRAPPER(type, handle).m_references;                                          \
-            POOL_UNLOCK(type, handle);                                                          \
-        }                                                                                       \
+    assert(POOL_HANDLE_IN_USE(type, handle));                                                   \
+    atomic_size_t *references = &POOL_WRAPPER(type, handle).m_references;                       \
+    size_t old = atomic_fetch_sub_explicit(references, 1, memory_order_acq_rel);                \
+    assert(old > 0);                                                                            \
+    if (old == 1) {                                                                             \
+        /* that was the last reference, so nobody else can be using the object */               \
+        destroy(&POOL_OBJECT(type, handle));                                                    \
+        _##type##_POOL_UNSHARE(handle);                                                         \
+        _##type##_POOL_FREE(handle);                                                            \
+    }                                                                                           \
+                                                                                                \
+    return 0;                                                                                   \
+}                                                                                               \
                                                                                                 \
+static inline int type##_POOL_FLUSH(void) {                                                     \
+    int status = _##type##_POOL_DRAIN(0);                                                       \
+    if (0 != _##type##_POOL_DISOWN())  status = -1;                                             \
+    return status;                                                                              \
+}                                                                                               \
+                                                                                                \
+static inline int type##_POOL_MAGAZINE_STATS(pool_magazine_stats_t *stats) {                    \
+    assert(stats != NULL);                                                                      \
+    if (0 == pthread_mutex_lock(&POOL_SINGLETON(type).m_free_list_mutex)) {                     \
+        _##type##_POOL_ADD_STATS_UNLOCKED(&POOL_MAGAZINE(type));                                \
+        *stats = POOL_SINGLETON(type).m_magazine_stats;                                         \
+        pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                          \
         return 0;                                                                               \
     }                                                                                           \
     else {                                                                                      \
-        debug("failed to lock %s handle %"PRIuPTR"\n", #type, handle);                          \
-        FIXME("how to handle this?\n");                                                         \
         return -1;                                                                              \
     }                                                                                           \
 }                                                                                               \
@@ -405,52 +630,302 @@ static inline int type##_POOL_RELEASE(handle_type handle) {
 static inline handle_type _##type##_POOL_FIND_FREE_SEQUENCE_UNLOCKED(size_t len) {              \
     assert(len > 0);                                                                            \
                                                                                                 \
-    if (POOL_SINGLETON(type).m_free_count > len) {                                              \
-        handle_type prev, iter, sequence;                                                       \
-        size_t found = 0;                                                                       \
-                                                                                                \
-        iter = sequence = POOL_SINGLETON(type).m_free_list_head;                                \
-        prev = 0;                                                                               \
-        while (POOL_HANDLE_VALID(type, iter)) {                                                 \
-            if (POOL_HANDLE_IN_USE(type, iter)) {                                               \
-                found = 0;                                                                      \
-                iter = sequence = POOL_WRAPPER(type, prev).m_next_free;                         \
-                prev = 0;                                                                       \
+    if (POOL_SINGLETON(type).m_free_count >= len) {                                             \
+        /* the free list isn't in any order, so check each free item's neighbours directly */   \
+        for (   handle_type i = POOL_SINGLETON(type).m_free_list_head;                          \
+                i != 0;                                                                         \
+                i = POOL_WRAPPER(type, i).m_next_free) {                                        \
+            if (POOL_HANDLE_OWNER(type, i) != 0)  continue;                                     \
+                                                                                                \
+            size_t found = 1;                                                                   \
+            while (found < len                                                                  \
+                   && POOL_HANDLE_VALID(type, i + found)                                        \
+                   && POOL_HANDLE_OWNER(type, i + found) == 0                                   \
+                   && !POOL_HANDLE_IN_USE(type, i + found)                                      \
+                   && !POOL_HANDLE_CACHED(type, i + found)) {                                   \
+                ++found;                                                                        \
             }                                                                                   \
-            else {                                                                              \
-                if (++found == len)  break;                                                     \
-                prev = iter++;                                                                  \
+            if (found == len)  return i;                                                        \
+        }                                                                                       \
+    }                                                                                           \
+                                                                                                \
+    return 0;                                                                                   \
+}                                                                                               \
+                                                                                                \
+static inline handle_type _##type##_POOL_GROW_UNLOCKED(size_t count) {                          \
+    const size_t allocated_count = POOL_ALLOCATED_COUNT(type);                                  \
+    const size_t first = allocated_count / type##_POOL_CHUNK_SIZE;                              \
+    const size_t chunks = (count + type##_POOL_CHUNK_SIZE - 1) / type##_POOL_CHUNK_SIZE;        \
+                                                                                                \
+    if (first + chunks > POOL_DIRECTORY_SIZE) {                                                 \
+        debug("%s pool is full\n", #type);                                                      \
+        return 0;                                                                               \
+    }                                                                                           \
+                                                                                                \
+    for (size_t i = first; i < first + chunks; i++) {                                           \
+        POOL_WRAPPER_TYPE(type) *chunk = calloc(type##_POOL_CHUNK_SIZE, sizeof(*chunk));        \
+        if (chunk == NULL) {                                                                    \
+            debug("couldn't allocate %s pool chunk\n", #type);                                  \
+            while (i-- > first) {                                                               \
+                free(POOL_SINGLETON(type).m_chunks[i]);                                         \
+                POOL_SINGLETON(type).m_chunks[i] = NULL;                                        \
+            }                                                                                   \
+            return 0;                                                                           \
+        }                                                                                       \
+        POOL_SINGLETON(type).m_chunks[i] = chunk;                                               \
+    }                                                                                           \
+                                                                                                \
+    atomic_store_explicit(&POOL_SINGLETON(type).m_allocated_count,                              \
+                          allocated_count + chunks * type##_POOL_CHUNK_SIZE,                    \
+                          memory_order_release);                                                \
+    return allocated_count + 1;                                                                 \
+}                                                                                               \
+                                                                                                \
+static inline int _##type##_POOL_REFILL(int grow) {                                             \
+    POOL_MAGAZINE_TYPE(type) *magazine = &POOL_MAGAZINE(type);                                  \
+    assert(magazine->m_count == 0);                                                             \
+                                                                                                \
+    if (0 == pthread_mutex_lock(&POOL_SINGLETON(type).m_free_list_mutex)) {                     \
+        if (POOL_SINGLETON(type).m_free_count == 0) {                                           \
+            if (! grow) {                                                                       \
+                pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                  \
+                return 1;                                                                       \
+            }                                                                                   \
+                                                                                                \
+            handle_type first = _##type##_POOL_GROW_UNLOCKED(type##_POOL_CHUNK_SIZE);           \
+            if (first == 0) {                                                                   \
+                pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                  \
+                return -1;                                                                      \
+            }                                                                                   \
+                                                                                                \
+            const size_t new_size = POOL_ALLOCATED_COUNT(type);                                 \
+            for (handle_type i = first; i < new_size; i++) {                                    \
+                POOL_WRAPPER(type, i).m_next_free = i + 1;                                      \
             }                                                                                   \
+            POOL_WRAPPER(type, new_size).m_next_free = 0;                                       \
+            POOL_SINGLETON(type).m_free_list_head = first;                                      \
+            POOL_SINGLETON(type).m_free_count = new_size - first + 1;                           \
+        }                                                                                       \
+                                                                                                \
+        size_t n = POOL_MAGAZINE_SIZE / 2;                                                      \
+        if (n > POOL_SINGLETON(type).m_free_count)  n = POOL_SINGLETON(type).m_free_count;      \
+        for (size_t i = 0; i < n; i++) {                                                        \
+            handle_type handle = POOL_SINGLETON(type).m_free_list_head;                         \
+            POOL_SINGLETON(type).m_free_list_head = POOL_WRAPPER(type, handle).m_next_free;     \
+            POOL_WRAPPER(type, handle).m_next_free = POOL_OBJECT_STATE_CACHED;                  \
+            magazine->m_handles[magazine->m_count++] = handle;                                  \
         }                                                                                       \
+        POOL_SINGLETON(type).m_free_count -= n;                                                 \
+        POOL_SINGLETON(type).m_count += n;                                                      \
+                                                                                                \
+        ++POOL_SINGLETON(type).m_magazine_stats.m_refills;                                      \
+        POOL_SINGLETON(type).m_magazine_stats.m_refilled += n;                                  \
+        _##type##_POOL_ADD_STATS_UNLOCKED(magazine);                                            \
                                                                                                 \
-        return (found >= len ? sequence : 0);                                                   \
+        pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                          \
+        return 0;                                                                               \
     }                                                                                           \
     else {                                                                                      \
+        debug("couldn't lock free list mutex\n");                                               \
+        return -1;                                                                              \
+    }                                                                                           \
+}                                                                                               \
+                                                                                                \
+static inline int _##type##_POOL_DRAIN(size_t keep) {                                           \
+    POOL_MAGAZINE_TYPE(type) *magazine = &POOL_MAGAZINE(type);                                  \
+    assert(keep <= magazine->m_count);                                                          \
+                                                                                                \
+    if (0 == pthread_mutex_lock(&POOL_SINGLETON(type).m_free_list_mutex)) {                     \
+        /* give back the least recently released, and keep the rest */                          \
+        const size_t n = magazine->m_count - keep;                                              \
+        for (size_t i = 0; i < n; i++) {                                                        \
+            handle_type handle = magazine->m_handles[i];                                        \
+            assert(POOL_HANDLE_CACHED(type, handle));                                           \
+            POOL_WRAPPER(type, handle).m_next_free = POOL_SINGLETON(type).m_free_list_head;     \
+            POOL_SINGLETON(type).m_free_list_head = handle;                                     \
+        }                                                                                       \
+        for (size_t i = 0; i < keep; i++) {                                                     \
+            magazine->m_handles[i] = magazine->m_handles[n + i];                                \
+        }                                                                                       \
+        magazine->m_count = keep;                                                               \
+        POOL_SINGLETON(type).m_free_count += n;                                                 \
+        POOL_SINGLETON(type).m_count -= n;                                                      \
+                                                                                                \
+        if (n > 0) {                                                                            \
+            ++POOL_SINGLETON(type).m_magazine_stats.m_drains;                                   \
+            POOL_SINGLETON(type).m_magazine_stats.m_drained += n;                               \
+        }                                                                                       \
+        _##type##_POOL_ADD_STATS_UNLOCKED(magazine);                                            \
+                                                                                                \
+        pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                          \
         return 0;                                                                               \
     }                                                                                           \
+    else {                                                                                      \
+        debug("couldn't lock free list mutex\n");                                               \
+        return -1;                                                                              \
+    }                                                                                           \
 }                                                                                               \
                                                                                                 \
-static inline void _##type##_POOL_ADD_TO_FREE_LIST(handle_type handle) {                        \
-    assert(POOL_HANDLE_VALID(type, handle));                                                    \
+static inline handle_type _##type##_POOL_ALLOCATE_LOCAL(void) {                                 \
+    POOL_LOCAL_TYPE(type) *local = &POOL_LOCAL(type);                                           \
                                                                                                 \
-    handle_type prev = handle;                                                                  \
+    if (local->m_count == 0) {                                                                  \
+        /* reuse the pool's free objects (e.g. from finished threads) before growing it */      \
+        POOL_MAGAZINE_TYPE(type) *magazine = &POOL_MAGAZINE(type);                              \
+        if (magazine->m_count > 0 || 0 == _##type##_POOL_REFILL(0)) {                           \
+            handle_type handle = magazine->m_handles[--magazine->m_count];                      \
+            assert(POOL_HANDLE_CACHED(type, handle));                                           \
+            return handle;                                                                      \
+        }                                                                                       \
                                                                                                 \
-    if (0 == pthread_mutex_lock(&POOL_SINGLETON(type).m_free_list_mutex)) {                     \
-        for ( ; prev > 0 && !POOL_HANDLE_IN_USE(type, prev); --prev) ;                          \
+        /* there aren't any, so claim a new chunk for this thread */                            \
+        if (0 == pthread_mutex_lock(&POOL_SINGLETON(type).m_free_list_mutex)) {                 \
+            handle_type first = _##type##_POOL_GROW_UNLOCKED(type##_POOL_CHUNK_SIZE);           \
+            if (first == 0) {                                                                   \
+                pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                  \
+                return 0;                                                                       \
+            }                                                                                   \
+                                                                                                \
+            const size_t chunk = (first - 1) / type##_POOL_CHUNK_SIZE;                          \
+            const uint32_t owner = _##type##_POOL_OWNER();                                      \
+            atomic_store_explicit(&POOL_SINGLETON(type).m_chunk_owners[chunk], owner,           \
+                                  memory_order_relaxed);                                        \
+                                                                                                \
+            const size_t new_size = POOL_ALLOCATED_COUNT(type);                                 \
+            for (handle_type i = first; i < new_size; i++) {                                    \
+                POOL_WRAPPER(type, i).m_next_free = i + 1;                                      \
+            }                                                                                   \
+            POOL_WRAPPER(type, new_size).m_next_free = 0;                                       \
+            local->m_head = first;                                                              \
+            local->m_tail = new_size;                                                           \
+            local->m_count = new_size - first + 1;                                              \
                                                                                                 \
-        if (prev > 0) {                                                                         \
-            POOL_WRAPPER(type, handle).m_next_free = POOL_WRAPPER(type, prev).m_next_free;      \
-            POOL_WRAPPER(type, prev).m_next_free = handle;                                      \
+            POOL_SINGLETON(type).m_count += local->m_count;                                     \
+            ++POOL_SINGLETON(type).m_magazine_stats.m_claims;                                   \
+                                                                                                \
+            pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                      \
         }                                                                                       \
         else {                                                                                  \
-            POOL_WRAPPER(type, handle).m_next_free = POOL_SINGLETON(type).m_free_list_head;     \
-            POOL_SINGLETON(type).m_free_list_head = handle;                                     \
+            debug("couldn't lock free list mutex\n");                                           \
+            return 0;                                                                           \
+        }                                                                                       \
+    }                                                                                           \
+                                                                                                \
+    handle_type handle = local->m_head;                                                         \
+    local->m_head = POOL_WRAPPER(type, handle).m_next_free;                                     \
+    --local->m_count;                                                                           \
+    return handle;                                                                              \
+}                                                                                               \
+                                                                                                \
+static inline void _##type##_POOL_FREE(handle_type handle) {                                    \
+    POOL_MAGAZINE_TYPE(type) *magazine = &POOL_MAGAZINE(type);                                  \
+    POOL_LOCAL_TYPE(type) *local = &POOL_LOCAL(type);                                           \
+                                                                                                \
+    ++magazine->m_releases;                                                                     \
+                                                                                                \
+    if (local->m_owner != 0 && POOL_HANDLE_OWNER(type, handle) == local->m_owner) {             \
+        /* it's from one of our own chunks, so it goes back on our own free list */             \
+        if (local->m_count == 0)  local->m_tail = handle;                                       \
+        POOL_WRAPPER(type, handle).m_next_free = local->m_head;                                 \
+        local->m_head = handle;                                                                 \
+        ++local->m_count;                                                                       \
+    }                                                                                           \
+    else {                                                                                      \
+        if (magazine->m_count == POOL_MAGAZINE_SIZE) {                                          \
+            _##type##_POOL_DRAIN(POOL_MAGAZINE_SIZE / 2);                                       \
+        }                                                                                       \
+        if (magazine->m_count < POOL_MAGAZINE_SIZE) {                                           \
+            POOL_WRAPPER(type, handle).m_next_free = POOL_OBJECT_STATE_CACHED;                  \
+            magazine->m_handles[magazine->m_count++] = handle;                                  \
+        }                                                                                       \
+        else {                                                                                  \
+            debug("couldn't drain %s magazine, handle %"PRIuPTR" is lost\n", #type, handle);    \
+        }                                                                                       \
+    }                                                                                           \
+}                                                                                               \
+                                                                                                \
+static inline int _##type##_POOL_DISOWN(void) {                                                 \
+    POOL_LOCAL_TYPE(type) *local = &POOL_LOCAL(type);                                           \
+    if (local->m_owner == 0)  return 0;                                                         \
+                                                                                                \
+    if (0 == pthread_mutex_lock(&POOL_SINGLETON(type).m_free_list_mutex)) {                     \
+        _Atomic uint32_t *owners = POOL_SINGLETON(type).m_chunk_owners;                         \
+        const size_t chunk_count = POOL_ALLOCATED_COUNT(type) / type##_POOL_CHUNK_SIZE;         \
+        for (size_t i = 0; i < chunk_count; i++) {                                              \
+            if (atomic_load_explicit(&owners[i], memory_order_relaxed) == local->m_owner) {     \
+                atomic_store_explicit(&owners[i], 0, memory_order_relaxed);                     \
+            }                                                                                   \
         }                                                                                       \
                                                                                                 \
-        ++POOL_SINGLETON(type).m_free_count;                                                    \
+        if (local->m_count > 0) {                                                               \
+            /* put our free objects on the front of the pool's free list */                     \
+            handle_type *head = &POOL_SINGLETON(type).m_free_list_head;                         \
+            POOL_WRAPPER(type, local->m_tail).m_next_free = *head;                              \
+            *head = local->m_head;                                                              \
+            POOL_SINGLETON(type).m_free_count += local->m_count;                                \
+            POOL_SINGLETON(type).m_count -= local->m_count;                                     \
+            POOL_SINGLETON(type).m_magazine_stats.m_returned += local->m_count;                 \
+        }                                                                                       \
+        local->m_head = local->m_tail = 0;                                                      \
+        local->m_count = 0;                                                                     \
                                                                                                 \
         pthread_mutex_unlock(&POOL_SINGLETON(type).m_free_list_mutex);                          \
+        return 0;                                                                               \
+    }                                                                                           \
+    else {                                                                                      \
+        debug("couldn't lock free list mutex\n");                                               \
+        return -1;                                                                              \
+    }                                                                                           \
+}                                                                                               \
+                                                                                                \
+static inline uint32_t _##type##_POOL_OWNER(void) {                                             \
+    POOL_LOCAL_TYPE(type) *local = &POOL_LOCAL(type);                                           \
+    while (local->m_owner == 0) {                                                               \
+        /* 0 means no owner, and tokens must fit in a pool_lock_t, so skip 0 when they wrap */  \
+        uint32_t owner = 1 + atomic_fetch_add_explicit(&POOL_SINGLETON(type).m_owner_count, 1,  \
+                                                       memory_order_relaxed);                   \
+        local->m_owner = owner & POOL_LOCK_OWNER_MASK;                                          \
+    }                                                                                           \
+    return local->m_owner;                                                                      \
+}                                                                                               \
+                                                                                                \
+static inline int _##type##_POOL_SHARE(handle_type handle) {                                    \
+    if (type##_POOL_INLINE_LOCK) {                                                              \
+        POOL_WRAPPER(type, handle).m_lock.m_depth = 0;                                          \
+        atomic_store_explicit(&POOL_WRAPPER(type, handle).m_lock.m_word, POOL_LOCK_SHARED,      \
+                              memory_order_relaxed);                                            \
+        return 0;                                                                               \
+    }                                                                                           \
+                                                                                                \
+    pthread_mutex_t *mutex = calloc(1, sizeof(*mutex));                                         \
+    const pthread_mutexattr_t *attr = &POOL_SINGLETON(type).m_shared_mutex_attr;                \
+    if (mutex == NULL || 0 != pthread_mutex_init(mutex, attr)) {                                \
+        free(mutex);                                                                            \
+        return -1;                                                                              \
+    }                                                                                           \
+    POOL_WRAPPER(type, handle).m_mutex = mutex;                                                 \
+    return 0;                                                                                   \
+}                                                                                               \
+                                                                                                \
+static inline void _##type##_POOL_UNSHARE(handle_type handle) {                                 \
+    if (type##_POOL_INLINE_LOCK) {                                                              \
+        atomic_store_explicit(&POOL_WRAPPER(type, handle).m_lock.m_word, 0,                     \
+                              memory_order_relaxed);                                            \
+        return;                                                                                 \
     }                                                                                           \
+                                                                                                \
+    pthread_mutex_t *mutex = POOL_WRAPPER(type, handle).m_mutex;                                \
+    POOL_WRAPPER(type, handle).m_mutex = NULL;                                                  \
+    if (mutex != NULL) {                                                                        \
+        pthread_mutex_destroy(mutex);                                                           \
+        free(mutex);                                                                            \
+    }                                                                                           \
+}                                                                                               \
+                                                                                                \
+static inline void _##type##_POOL_ADD_STATS_UNLOCKED(POOL_MAGAZINE_TYPE(type) *magazine) {      \
+    POOL_SINGLETON(type).m_magazine_stats.m_allocations += magazine->m_allocations;             \
+    POOL_SINGLETON(type).m_magazine_stats.m_releases += magazine->m_releases;                   \
+    magazine->m_allocations = magazine->m_releases = 0;                                         \
 }                                                                                               \
                                                                                                 \
 /*
@@ -461,7 +936,9 @@ Call this from your source file
 =cut
  */
 #define POOL_SOURCE_CONTENTS(type)                                                              \
-POOL_TYPE(type) POOL_SINGLETON(type) = {0};
+POOL_TYPE(type) POOL_SINGLETON(type) = {0};                                                     \
+_Thread_local POOL_MAGAZINE_TYPE(type) POOL_MAGAZINE(type) = {0};                               \
+_Thread_local POOL_LOCAL_TYPE(type) POOL_LOCAL(type) = {0};
 
 /*
 =back
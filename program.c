@@ -0,0 +1,531 @@
+/*
+ *  program.c
+ *  dang
+ *
+=head1 NAME
+
+program
+
+=head1 INTRODUCTION
+
+A program is the internal form of a block of bytecode, built once when the bytecode is loaded and shared by every
+execution context running it.
+
+Each instruction is decoded into a fixed-size, aligned op_t record holding the address of its handler in the
+interpreter loop, its operands (already converted from their unaligned in-stream encodings), and for JMP, JMP0, JMPU,
+CALL, CORO and FUNLIT a pointer to the op at the destination.  Jumps and calls are therefore just pointer moves at run
+time.  NOOP padding is dropped entirely.  SYMFIND and SYMCLONE ops each get their own symbol cache.  CALL and FRCALL
+ops in tail position (i.e. followed by RETURN) are flagged OP_FLAG_TAIL_CALL.
+
+Each op that starts a function (i.e. the target of a CALL or FUNLIT) records the layout of the function's frame: the
+identifiers its own SYMDEF ops define.  A frame keeps those symbols in slots sized for the function, so that starting
+and ending it only costs as much as the function's own locals.  Identifiers keep their values from the bytecode,
+because symbols are dynamically scoped: a function can find symbols defined by whichever function called it, and
+anything not in a frame's slots is kept in its tree as usual.  Once loaded, ops only change when the interpreter
+quickens them (see bytecode.c).
+
+Function handles remain bytecode offsets, because they're visible to programs as FUNCREF values; program_op() maps them
+to ops in constant time.
+
+=head1 PUBLIC INTERFACE
+
+=over
+
+=cut
+ */
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bytecode.h"
+#include "debug.h"
+#include "symboltable.h"
+
+#include "program.h"
+
+static int _program_instruction_size(const uint8_t *, size_t, size_t, size_t *);
+static int _program_decode(op_t *, const uint8_t *, size_t);
+static int _program_resolve(program_t *, op_t *);
+static int _program_layout_frames(program_t *);
+static size_t _program_unique_identifiers(identifier_t *, size_t);
+static int _program_compare_identifiers(const void *, const void *);
+
+/*
+=item program_init()
+
+Decodes length bytes of bytecode into a program.  The bytecode must remain valid for the lifetime of the program.
+
+Returns 0 on success.  Returns -1 if the bytecode contains an invalid instruction, an instruction truncated by the end
+of the bytecode, or a jump or call whose destination isn't an instruction.
+
+=cut
+ */
+int program_init(program_t *self, const uint8_t *bytecode, size_t length) {
+    assert(self != NULL);
+    assert(bytecode != NULL);
+
+    memset(self, 0, sizeof(*self));
+
+    size_t count = 0, size = 0;
+    for (size_t position = 0; position < length; position += size) {
+        if (0 != _program_instruction_size(bytecode, length, position, &size))  return -1;
+        if (bytecode[position] != i_NOOP)  ++count;
+    }
+
+    // n.b. one extra op for a trailing END, so that execution can never run off the end
+    if (NULL == (self->m_ops = calloc(count + 1, sizeof(*self->m_ops)))) {
+        debug("couldn't allocate %zu ops\n", count + 1);
+        return -1;
+    }
+    if (NULL == (self->m_index = calloc(length + 1, sizeof(*self->m_index)))) {
+        debug("couldn't allocate index for %zu bytes of bytecode\n", length);
+        free(self->m_ops);
+        self->m_ops = NULL;
+        return -1;
+    }
+
+    self->m_bytecode = bytecode;
+    self->m_bytecode_length = length;
+
+    for (size_t position = 0; position < length; position += size) {
+        _program_instruction_size(bytecode, length, position, &size);
+
+        // padding maps to whichever op follows it
+        self->m_index[position] = &self->m_ops[self->m_op_count];
+
+        if (bytecode[position] != i_NOOP) {
+            if (0 != _program_decode(&self->m_ops[self->m_op_count], &bytecode[position], position)) {
+                program_destroy(self);
+                return -1;
+            }
+            ++self->m_op_count;
+        }
+    }
+
+    self->m_ops[self->m_op_count].m_instruction = i_END;
+    self->m_ops[self->m_op_count].m_handler = bytecode_handler(i_END);
+    self->m_index[length] = &self->m_ops[self->m_op_count];
+
+    for (size_t i = 0; i < self->m_op_count; i++) {
+        if (self->m_ops[i].m_instruction == i_SYMFIND || self->m_ops[i].m_instruction == i_SYMCLONE) {
+            ++self->m_symbol_cache_count;
+        }
+    }
+
+    if (self->m_symbol_cache_count > 0) {
+        if (NULL == (self->m_symbol_caches = calloc(self->m_symbol_cache_count, sizeof(*self->m_symbol_caches)))) {
+            debug("couldn't allocate %zu symbol caches\n", self->m_symbol_cache_count);
+            program_destroy(self);
+            return -1;
+        }
+
+        for (size_t i = 0, j = 0; i < self->m_op_count; i++) {
+            if (self->m_ops[i].m_instruction == i_SYMFIND || self->m_ops[i].m_instruction == i_SYMCLONE) {
+                self->m_ops[i].m_symbol_cache = &self->m_symbol_caches[j++];
+            }
+        }
+    }
+
+    for (size_t i = 0; i < self->m_op_count; i++) {
+        if (0 != _program_resolve(self, &self->m_ops[i])) {
+            program_destroy(self);
+            return -1;
+        }
+
+        // n.b. there's always a following op, because of the trailing END
+        if ((self->m_ops[i].m_instruction == i_CALL || self->m_ops[i].m_instruction == i_FRCALL)
+            && self->m_ops[i + 1].m_instruction == i_RETURN) {
+            self->m_ops[i].m_flags |= OP_FLAG_TAIL_CALL;
+        }
+    }
+
+    if (0 != _program_layout_frames(self)) {
+        program_destroy(self);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+=item program_destroy()
+
+Releases the resources held by a program.  No context may still be executing it.
+
+=cut
+ */
+int program_destroy(program_t *self) {
+    assert(self != NULL);
+
+    if (self->m_ops != NULL) {
+        for (size_t i = 0; i < self->m_op_count; i++) {
+            switch (self->m_ops[i].m_instruction) {
+                case i_STR:
+                case i_STRING:
+                    if (self->m_ops[i].m_operand.as_string)  string_free(self->m_ops[i].m_operand.as_string);
+                    break;
+                default:
+                    break;
+            }
+        }
+        free(self->m_ops);
+    }
+
+    if (self->m_index != NULL)  free(self->m_index);
+    if (self->m_symbol_caches != NULL)  free(self->m_symbol_caches);
+
+    if (self->m_frame_layouts != NULL) {
+        for (size_t i = 0; i < self->m_frame_layout_count; i++) {
+            if (self->m_frame_layouts[i].m_identifiers != NULL)  free(self->m_frame_layouts[i].m_identifiers);
+            if (self->m_frame_layouts[i].m_visible != NULL)  free(self->m_frame_layouts[i].m_visible);
+        }
+        free(self->m_frame_layouts);
+    }
+
+    memset(self, 0, sizeof(*self));
+    return 0;
+}
+
+/*
+=item program_op()
+
+Returns the op for the instruction at the given bytecode position, or NULL if there isn't one.
+
+=cut
+ */
+
+/*
+=item frame_layout_sees()
+
+Returns non-zero if the function a frame layout belongs to, or anything it calls, might look up the given identifier.
+
+=cut
+ */
+
+/*
+=back
+
+=head1 PRIVATE INTERFACE
+
+=over
+
+=item _program_instruction_size()
+
+Determines the size in bytes of the instruction at the given position, including its operands.
+
+=cut
+ */
+static int _program_instruction_size(const uint8_t *bytecode, size_t length, size_t position, size_t *size) {
+    assert(position < length);
+
+    const uint8_t instruction = bytecode[position];
+
+    if (instruction >= i__QUICK_MIN) {
+        debug("invalid instruction %"PRIu8" at %zu\n", instruction, position);
+        return -1;
+    }
+
+    *size = instruction_sizes[instruction];
+
+    if (position + *size <= length) {
+        if (instruction == i_STR) {
+            *size += bytecode[position + 1];
+        }
+        else if (instruction == i_STRING) {
+            uint32_t len;
+            memcpy(&len, &bytecode[position + 1], sizeof(len));
+            *size += len;
+        }
+    }
+
+    if (position + *size > length) {
+        debug("instruction '%s' at %zu is truncated\n", instruction_names[instruction], position);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+=item _program_decode()
+
+Decodes the instruction at the given position into an op.  Jump destinations are converted to absolute positions, but
+aren't resolved to ops until the whole program has been decoded.
+
+=cut
+ */
+static int _program_decode(op_t *op, const uint8_t *code, size_t position) {
+    assert(op != NULL);
+    assert(code != NULL);
+
+    const uint8_t *operand = &code[1];
+
+    op->m_instruction = code[0];
+    op->m_handler = bytecode_handler(op->m_instruction);
+
+    switch (op->m_instruction) {
+        case i_CALL:
+        case i_CORO:
+        case i_FUNLIT:
+            memcpy(&op->m_operand.as_function, operand, sizeof(function_handle_t));
+            break;
+        case i_JMP:
+        case i_JMP0:
+        case i_JMPU: {
+            intptr_t offset;
+            memcpy(&offset, operand, sizeof(offset));
+            op->m_operand.as_int = position + offset;
+            break;
+        }
+        case i_SYMDEF: {
+            flags32_t flags;
+            memcpy(&flags, operand, sizeof(flags));
+            op->m_flags = flags;
+            memcpy(&op->m_operand.as_identifier, &operand[sizeof(flags32_t)], sizeof(identifier_t));
+            break;
+        }
+        case i_SYMFIND:
+        case i_SYMCLONE:
+        case i_SYMUNDEF:
+            memcpy(&op->m_operand.as_identifier, operand, sizeof(identifier_t));
+            break;
+        case i_BYTE:
+            op->m_operand.as_int = operand[0];
+            break;
+        case i_INT:
+            memcpy(&op->m_operand.as_int, operand, sizeof(intptr_t));
+            break;
+        case i_FLOAT:
+            memcpy(&op->m_operand.as_float, operand, sizeof(floatptr_t));
+            break;
+        case i_OPEN:
+            op->m_flags = operand[0];
+            break;
+        case i_STR: {
+            const uint8_t len = operand[0];
+            op->m_operand.as_string = string_alloc(len, (const char *) &operand[sizeof(len)]);
+            if (op->m_operand.as_string == NULL) {
+                debug("couldn't allocate string literal at %zu\n", position);
+                return -1;
+            }
+            break;
+        }
+        case i_STRING: {
+            uint32_t len;
+            memcpy(&len, operand, sizeof(len));
+            op->m_operand.as_string = string_alloc(len, (const char *) &operand[sizeof(len)]);
+            if (op->m_operand.as_string == NULL) {
+                debug("couldn't allocate string literal at %zu\n", position);
+                return -1;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+/*
+=item _program_resolve()
+
+Points a jump or call op at its destination op.
+
+=cut
+ */
+static int _program_resolve(program_t *self, op_t *op) {
+    uintptr_t destination;
+
+    switch (op->m_instruction) {
+        case i_JMP:
+        case i_JMP0:
+        case i_JMPU:
+            destination = op->m_operand.as_int;
+            break;
+        case i_CALL:
+        case i_CORO:
+        case i_FUNLIT:
+            destination = op->m_operand.as_function;
+            break;
+        default:
+            return 0;
+    }
+
+    if (NULL != (op->m_target = program_op(self, destination))) {
+        return 0;
+    }
+    else {
+        debug("instruction '%s' has invalid destination %"PRIuPTR"\n", instruction_names[op->m_instruction], destination);
+        return -1;
+    }
+}
+
+/*
+=item _program_layout_frames()
+
+Gives each op targeted by CALL or FUNLIT the layout of the frames its function needs.
+
+The slots are the distinct identifiers defined by the SYMDEF ops reachable from the op, following jumps but not calls,
+up to RETURN or END.  Ops only reached some other way (e.g. by a computed function reference) get no layout, so their
+frames just keep any symbols in a tree.
+
+The visible identifiers are those of the SYMFIND and SYMCLONE ops reachable from the op, this time following calls as
+well, i.e. the symbols the function might look up from its caller's scope.  A function that can reach FRCALL could
+call anything, so it's flagged as seeing every identifier instead.  See _bytecode_call() for how these are used.
+
+=cut
+ */
+static int _program_layout_frames(program_t *self) {
+    size_t symdef_count = 0, symfind_count = 0, target_count = 0;
+
+    for (size_t i = 0; i < self->m_op_count; i++) {
+        switch (self->m_ops[i].m_instruction) {
+            case i_SYMDEF:
+                ++symdef_count;
+                break;
+            case i_SYMFIND:
+            case i_SYMCLONE:
+                ++symfind_count;
+                break;
+            case i_CALL:
+            case i_FUNLIT:
+                ++target_count;
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (target_count == 0)  return 0;
+
+    // n.b. ops are numbered up to m_op_count inclusive, because of the trailing END
+    const size_t op_count = self->m_op_count + 1;
+    size_t *visited = calloc(op_count, sizeof(*visited));
+    size_t *pending = calloc(op_count, sizeof(*pending));
+    identifier_t *identifiers = calloc(symdef_count + symfind_count + 1, sizeof(*identifiers));
+    self->m_frame_layouts = calloc(target_count, sizeof(*self->m_frame_layouts));
+
+    int status = 0;
+    if (visited == NULL || pending == NULL || identifiers == NULL || self->m_frame_layouts == NULL) {
+        debug("couldn't allocate frame layouts for %zu call targets\n", target_count);
+        status = -1;
+    }
+
+    // visited[n] is the last pass to reach op n: 2 * entry + 1 for slots, 2 * entry + 2 for visibility
+    for (size_t i = 0; status == 0 && i < self->m_op_count; i++) {
+        if (self->m_ops[i].m_instruction != i_CALL && self->m_ops[i].m_instruction != i_FUNLIT)  continue;
+
+        const size_t entry = self->m_ops[i].m_target - self->m_ops;
+        if (self->m_ops[entry].m_frame_layout != NULL)  continue;
+
+        frame_layout_t *layout = &self->m_frame_layouts[self->m_frame_layout_count++];
+        self->m_ops[entry].m_frame_layout = layout;
+
+        for (int visibility = 0; status == 0 && visibility <= 1; visibility++) {
+            const size_t pass = 2 * entry + 1 + visibility;
+            size_t pending_count = 0, count = 0;
+            visited[entry] = pass;
+            pending[pending_count++] = entry;
+
+            while (pending_count > 0) {
+                const op_t *op = &self->m_ops[pending[--pending_count]];
+                const op_t *next[2] = { op + 1, NULL };
+
+                switch (op->m_instruction) {
+                    case i_SYMDEF:
+                        if (!visibility)  identifiers[count++] = op->m_operand.as_identifier;
+                        break;
+                    case i_SYMFIND:
+                    case i_SYMCLONE:
+                        if (visibility)  identifiers[count++] = op->m_operand.as_identifier;
+                        break;
+                    case i_CALL:
+                        if (visibility)  next[1] = op->m_target;
+                        break;
+                    case i_FRCALL:
+                        if (visibility)  layout->m_flags |= FRAME_LAYOUT_FLAG_SEES_ALL;
+                        break;
+                    case i_JMP:
+                        next[0] = op->m_target;
+                        break;
+                    case i_JMP0:
+                    case i_JMPU:
+                        next[1] = op->m_target;
+                        break;
+                    case i_RETURN:
+                    case i_END:
+                        next[0] = NULL;
+                        break;
+                    default:
+                        break;
+                }
+
+                for (size_t n = 0; n < 2; n++) {
+                    if (next[n] == NULL)  continue;
+                    const size_t index = next[n] - self->m_ops;
+                    if (visited[index] == pass)  continue;
+                    visited[index] = pass;
+                    pending[pending_count++] = index;
+                }
+            }
+
+            identifier_t *copy = NULL;
+            count = _program_unique_identifiers(identifiers, count);
+            if (count > 0 && NULL == (copy = calloc(count, sizeof(*copy)))) {
+                debug("couldn't allocate %zu identifiers\n", count);
+                status = -1;
+                break;
+            }
+            if (count > 0)  memcpy(copy, identifiers, count * sizeof(*copy));
+
+            if (visibility) {
+                layout->m_visible = copy;
+                layout->m_visible_count = count;
+            }
+            else {
+                layout->m_identifiers = copy;
+                layout->m_slot_count = count;
+            }
+        }
+    }
+
+    if (visited != NULL)  free(visited);
+    if (pending != NULL)  free(pending);
+    if (identifiers != NULL)  free(identifiers);
+    return status;
+}
+
+/*
+=item _program_unique_identifiers()
+
+Sorts count identifiers in place and removes duplicates, returning how many are left.
+
+=cut
+ */
+static size_t _program_unique_identifiers(identifier_t *identifiers, size_t count) {
+    if (count == 0)  return 0;
+
+    qsort(identifiers, count, sizeof(*identifiers), _program_compare_identifiers);
+
+    size_t unique = 1;
+    for (size_t i = 1; i < count; i++) {
+        if (identifiers[i] != identifiers[unique - 1])  identifiers[unique++] = identifiers[i];
+    }
+
+    return unique;
+}
+
+static int _program_compare_identifiers(const void *a, const void *b) {
+    const identifier_t x = *(const identifier_t *) a, y = *(const identifier_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+=back
+
+=cut
+ */
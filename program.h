@@ -0,0 +1,87 @@
+/*
+ *  program.h
+ *  dang
+ *
+ */
+
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bytecode.h"
+#include "string.h"
+#include "vmtypes.h"
+
+/* set on quickenable ops once they've deoptimised, so they stay generic (see bytecode.c) */
+#define OP_FLAG_NO_QUICKEN  0x80000000u
+/* set by the loader on CALL and FRCALL ops that are immediately followed by RETURN */
+#define OP_FLAG_TAIL_CALL   0x40000000u
+
+/* set on frame layouts of functions that might call anything, and so might look up any identifier */
+#define FRAME_LAYOUT_FLAG_SEES_ALL  0x00000001u
+
+/* what a function's frames need (see program_init()) */
+typedef struct frame_layout_t {
+    size_t m_slot_count;
+    identifier_t *m_identifiers;                /* sorted: defined by the function, kept in slots */
+    size_t m_visible_count;
+    identifier_t *m_visible;                    /* sorted: might be looked up by the function or its callees */
+    flags32_t m_flags;
+} frame_layout_t;
+
+/* m_handler, m_instruction and m_flags are atomic because quickening rewrites ops while other threads run them */
+typedef struct op_t {
+    _Atomic(const void *) m_handler;
+    _Atomic(instruction_t) m_instruction;
+    _Atomic(flags32_t) m_flags;
+    union {
+        intptr_t as_int;
+        floatptr_t as_float;
+        function_handle_t as_function;
+        identifier_t as_identifier;
+        string_t *as_string;
+    } m_operand;
+    union {
+        const struct op_t *m_target;            /* JMP, JMP0, JMPU, CALL, CORO, FUNLIT */
+        struct symbol_cache_t *m_symbol_cache;  /* SYMFIND, SYMCLONE */
+    };
+    const frame_layout_t *m_frame_layout;       /* targets of CALL and FUNLIT, if they define anything */
+} op_t;
+
+typedef struct program_t {
+    const uint8_t *m_bytecode;
+    size_t m_bytecode_length;
+    op_t *m_ops;
+    size_t m_op_count;
+    op_t **m_index;
+    struct symbol_cache_t *m_symbol_caches;
+    size_t m_symbol_cache_count;
+    frame_layout_t *m_frame_layouts;
+    size_t m_frame_layout_count;
+} program_t;
+
+int program_init(program_t *, const uint8_t *, size_t);
+int program_destroy(program_t *);
+
+static inline int frame_layout_sees(const frame_layout_t *self, identifier_t identifier) {
+    if (self->m_flags & FRAME_LAYOUT_FLAG_SEES_ALL)  return 1;
+
+    size_t low = 0, high = self->m_visible_count;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (identifier < self->m_visible[middle])  high = middle;
+        else if (identifier > self->m_visible[middle])  low = middle + 1;
+        else  return 1;
+    }
+
+    return 0;
+}
+
+static inline const op_t *program_op(const program_t *self, function_handle_t position) {
+    return (position <= self->m_bytecode_length ? self->m_index[position] : NULL);
+}
+
+#endif
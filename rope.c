@@ -0,0 +1,229 @@
+/*
+ *  rope.c
+ *  dang
+ *
+=head1 NAME
+
+rope
+
+=head1 INTRODUCTION
+
+Strings built by joining other strings together, without copying them.  See rope.h.
+
+=head1 PUBLIC INTERFACE
+
+=over
+
+=cut
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug.h"
+#include "rope.h"
+#include "util.h"
+
+static int _rope_reserve(rope_t **, size_t);
+
+/*
+=item rope_alloc()
+
+=item rope_free()
+
+Allocate an empty rope with room for at least the given number of pieces, and release a reference to one.
+
+=cut
+ */
+rope_t *rope_alloc(size_t initial_count) {
+    const size_t allocated = MAX(initial_count, 4);
+    rope_t *self = calloc(1, sizeof(*self) + allocated * sizeof(self->m_pieces[0]));
+    if (self) {
+        atomic_init(&self->m_references, 1);
+        atomic_init(&self->m_flat, NULL);
+        self->m_allocated = allocated;
+    }
+    else {
+        debug("couldn't allocate rope of %zu pieces\n", allocated);
+    }
+    return self;
+}
+
+void rope_free(rope_t *self) {
+    if (self && 1 == atomic_fetch_sub_explicit(&self->m_references, 1, memory_order_acq_rel)) {
+        for (size_t i = 0; i < self->m_count; i++) {
+            string_free(self->m_pieces[i].m_string);
+        }
+        string_free(atomic_load_explicit(&self->m_flat, memory_order_relaxed));
+        free(self);
+    }
+}
+
+/*
+=item rope_append_bytes()
+
+=item rope_append_string()
+
+=item rope_append_rope()
+
+Append length bytes, length bytes of a string starting at offset, or another rope, to the end of a rope.
+
+Bytes are always copied, into the rope's last chunk if there's room, or a new chunk if not.  Ranges of strings of at
+least ROPE_PIECE_MIN bytes become pieces that share the string, and shorter ones are copied as bytes.  Appending a
+rope appends each of its pieces in the same way.
+
+=cut
+ */
+int rope_append_bytes(rope_t **restrict self, size_t length, const char *restrict bytes) {
+    assert(self != NULL && *self != NULL);
+    assert(bytes != NULL || length == 0);
+
+    if (length == 0)  return 0;
+    if (0 != _rope_reserve(self, (*self)->m_count + 1))  return -1;
+
+    rope_t *rope = *self;
+    rope_piece_t *last = (rope->m_count > 0 ? &rope->m_pieces[rope->m_count - 1] : NULL);
+
+    if (last != NULL
+        && last->m_offset + last->m_length == string_length(last->m_string)
+        && last->m_length + length <= ROPE_CHUNK_SIZE) {
+        if (last->m_offset == 0 && ! string_is_shared(last->m_string)) {
+            // the chunk is ours alone, so add to it in place
+            if (0 != string_append(&last->m_string, length, bytes))  return -1;
+        }
+        else {
+            // someone else can see the chunk, so start a new one with a copy of its bytes
+            string_t *chunk = string_alloc(ROPE_CHUNK_SIZE, NULL);
+            if (chunk == NULL)  return -1;
+            string_append(&chunk, last->m_length, string_cstr(last->m_string) + last->m_offset);
+            string_append(&chunk, length, bytes);
+            string_free(last->m_string);
+            last->m_string = chunk;
+            last->m_offset = 0;
+        }
+        last->m_length += length;
+    }
+    else {
+        string_t *chunk = string_alloc(MAX(length, ROPE_CHUNK_SIZE), NULL);
+        if (chunk == NULL)  return -1;
+        string_append(&chunk, length, bytes);
+        rope->m_pieces[rope->m_count++] = (rope_piece_t) { chunk, 0, length };
+    }
+
+    rope->m_length += length;
+    return 0;
+}
+
+int rope_append_string(rope_t **restrict self, const string_t *restrict str, size_t offset, size_t length) {
+    assert(self != NULL && *self != NULL);
+    assert(str != NULL);
+    assert(offset + length <= string_length(str));
+
+    if (length < ROPE_PIECE_MIN)  return rope_append_bytes(self, length, string_cstr(str) + offset);
+    if (0 != _rope_reserve(self, (*self)->m_count + 1))  return -1;
+
+    rope_t *rope = *self;
+    rope->m_pieces[rope->m_count++] = (rope_piece_t) { string_dup(str), offset, length };
+    rope->m_length += length;
+    return 0;
+}
+
+int rope_append_rope(rope_t **restrict self, const rope_t *restrict other) {
+    assert(self != NULL && *self != NULL);
+    assert(other != NULL);
+
+    if (0 != _rope_reserve(self, (*self)->m_count + other->m_count))  return -1;
+
+    for (size_t i = 0; i < other->m_count; i++) {
+        const rope_piece_t *piece = &other->m_pieces[i];
+        if (0 != rope_append_string(self, piece->m_string, piece->m_offset, piece->m_length))  return -1;
+    }
+    return 0;
+}
+
+/*
+=item rope_flatten()
+
+Returns the contents of a rope as a single string, which belongs to the rope, and remains valid for as long as the
+caller's reference to the rope does.  The string is only built the first time it's asked for.  Two threads sharing a
+rope may both build it at once, in which case the one that finishes second throws its copy away and uses the other.
+
+Returns NULL if the string couldn't be allocated.
+
+=cut
+ */
+const string_t *rope_flatten(const rope_t *self) {
+    assert(self != NULL);
+
+    rope_t *rope = (rope_t *) self;
+    string_t *flat = atomic_load_explicit(&rope->m_flat, memory_order_acquire);
+    if (flat != NULL)  return flat;
+
+    if (NULL == (flat = string_alloc(self->m_length, NULL)))  return NULL;
+    for (size_t i = 0; i < self->m_count; i++) {
+        const rope_piece_t *piece = &self->m_pieces[i];
+        string_append(&flat, piece->m_length, string_cstr(piece->m_string) + piece->m_offset);
+    }
+
+    string_t *expected = NULL;
+    if (! atomic_compare_exchange_strong_explicit(&rope->m_flat, &expected, flat, memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+        string_free(flat);
+        flat = expected;
+    }
+    return flat;
+}
+
+/*
+=back
+
+=head1 PRIVATE INTERFACE
+
+=over
+
+=item _rope_reserve()
+
+Makes sure there's room for at least count pieces, and that the caller holds the only reference to the rope, so it can
+be modified in place.  Either may mean replacing *self with a new copy.  Also throws away the flattened string, if
+there is one, because it's about to be out of date.
+
+=cut
+ */
+static int _rope_reserve(rope_t **self, size_t count) {
+    rope_t *rope = *self;
+
+    if (rope_is_shared(rope)) {
+        rope_t *copy = rope_alloc(MAX(count, rope->m_allocated));
+        if (copy == NULL)  return -1;
+        for (size_t i = 0; i < rope->m_count; i++) {
+            copy->m_pieces[i] = rope->m_pieces[i];
+            string_dup(copy->m_pieces[i].m_string);
+        }
+        copy->m_count = rope->m_count;
+        copy->m_length = rope->m_length;
+        rope_free(rope);
+        *self = copy;
+        return 0;
+    }
+
+    string_free(atomic_exchange_explicit(&rope->m_flat, NULL, memory_order_relaxed));
+
+    if (count > rope->m_allocated) {
+        const size_t allocated = nextupow2(count);
+        rope_t *tmp = realloc(rope, sizeof(*rope) + allocated * sizeof(rope->m_pieces[0]));
+        if (tmp == NULL) {
+            debug("couldn't grow rope to %zu pieces\n", allocated);
+            return -1;
+        }
+        tmp->m_allocated = allocated;
+        *self = tmp;
+    }
+    return 0;
+}
+
+/*
+=back
+
+=cut
+ */
@@ -0,0 +1,73 @@
+/*
+ *  rope.h
+ *  dang
+ *
+ */
+
+#ifndef ROPE_H
+#define ROPE_H
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "string.h"
+
+/*
+ A rope is a string held as a sequence of pieces of other strings, so that joining strings together doesn't copy them.
+ Each piece shares a range of a string_t.  Pieces shorter than ROPE_PIECE_MIN are copied instead, into chunks of up to
+ ROPE_CHUNK_SIZE bytes that the rope owns, so a rope built from lots of little bits doesn't end up with lots of little
+ pieces.
+
+ Ropes are reference counted and copy-on-write in the same way as strings (see string.h): the functions that modify a
+ rope take a rope_t ** so they can replace a shared rope with a private copy first.  The copy shares the original's
+ pieces, so only the piece array is copied, never the bytes.
+
+ rope_flatten() returns the whole rope as a single string, for anything that needs random access to it.  The result is
+ cached in the rope, so a rope is flattened at most once until it's next modified.
+ */
+#define ROPE_PIECE_MIN      (256)
+#define ROPE_CHUNK_SIZE     (4096)
+
+typedef struct rope_piece_t {
+    string_t *m_string;
+    size_t m_offset;
+    size_t m_length;
+} rope_piece_t;
+
+typedef struct rope_t {
+    atomic_size_t m_references;
+    string_t *_Atomic m_flat;
+    size_t m_length;
+    size_t m_count;
+    size_t m_allocated;
+    rope_piece_t m_pieces[];
+} rope_t;
+
+rope_t *rope_alloc(size_t);
+void rope_free(rope_t *);
+
+static inline rope_t *rope_dup(const rope_t *orig) {
+    rope_t *self = (rope_t *) orig;
+    atomic_fetch_add_explicit(&self->m_references, 1, memory_order_relaxed);
+    return self;
+}
+
+static inline int rope_is_shared(const rope_t *self) {
+    return atomic_load_explicit(&((rope_t *) self)->m_references, memory_order_acquire) > 1;
+}
+
+int rope_append_bytes(rope_t **restrict, size_t, const char *restrict);
+int rope_append_string(rope_t **restrict, const string_t *restrict, size_t, size_t);
+int rope_append_rope(rope_t **restrict, const rope_t *restrict);
+
+const string_t *rope_flatten(const rope_t *);
+
+static inline size_t rope_length(const rope_t *self) { return self->m_length; }
+static inline size_t rope_piece_count(const rope_t *self) { return self->m_count; }
+
+static inline const char *rope_piece(const rope_t *self, size_t i, size_t *length) {
+    *length = self->m_pieces[i].m_length;
+    return string_cstr(self->m_pieces[i].m_string) + self->m_pieces[i].m_offset;
+}
+
+#endif
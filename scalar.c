@@ -9,6 +9,7 @@
 
 #include <assert.h>
 #include <inttypes.h>
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -16,12 +17,46 @@
 #include "channel.h"
 #include "debug.h"
 #include "hash.h"
+#include "numeric.h"
 #include "stream.h"
 
 #include "scalar.h"
 
 POOL_SOURCE_CONTENTS(scalar_t)
 
+#ifdef SCALAR_NANBOX
+typedef char _scalar_nanbox_requires_64_bit_double[sizeof(floatptr_t) == sizeof(uint64_t) ? 1 : -1];
+#else
+typedef char _scalar_short_length_fits_in_flags[
+    SCALAR_SHORT_STRING_MAX <= (SCALAR_SHORT_LENGTH_MASK >> SCALAR_SHORT_LENGTH_SHIFT) ? 1 : -1];
+typedef char _scalar_short_int_fits_in_int32[SCALAR_SHORT_INT_LENGTH_MAX <= 9 ? 1 : -1];
+#endif
+
+/* a view on a string at least this long and this many times its own length is replaced with a copy when it's stored */
+#define SCALAR_VIEW_COMPACT_MIN_PARENT  (1024)
+#define SCALAR_VIEW_COMPACT_RATIO       (4)
+
+/* concatenations at least this long are built as ropes rather than copied into a single string */
+#define SCALAR_ROPE_MIN_LENGTH          (4096)
+
+static inline uint32_t _anon_scalar_flags(const scalar_t *);
+static inline intptr_t _anon_scalar_get_int(const scalar_t *);
+static inline floatptr_t _anon_scalar_get_float(const scalar_t *);
+static inline string_t *_anon_scalar_get_string(const scalar_t *);
+static inline rope_t *_anon_scalar_get_rope(const scalar_t *);
+static inline handle_t _anon_scalar_get_handle(const scalar_t *);
+static inline void _anon_scalar_set_int(scalar_t *, intptr_t);
+static inline void _anon_scalar_set_float(scalar_t *, floatptr_t);
+static inline void _anon_scalar_set_string(scalar_t *, string_t *);
+static inline void _anon_scalar_set_rope(scalar_t *, rope_t *);
+static inline const char *_anon_scalar_get_string_bytes(const scalar_t *, size_t *);
+static inline void _anon_scalar_set_string_bytes(scalar_t *, size_t, const char *);
+static inline int _anon_scalar_set_string_view(scalar_t *, string_t *, size_t, size_t);
+static inline void _anon_scalar_set_handle(scalar_t *, uint32_t, handle_t);
+static inline intptr_t _anon_scalar_get_short_int(const scalar_t *);
+static const char *_anon_scalar_get_string_cstr(const scalar_t *, char *, size_t, string_t **);
+static int _anon_scalar_append_to_rope(rope_t **restrict, const scalar_t *restrict);
+
 /*
 =head1 NAME
 
@@ -45,7 +80,13 @@ scalar
 
 =item scalar_pool_destroy()
 
-Scalar pool setup and teardown functions
+=item scalar_pool_flush()
+
+=item scalar_pool_stats()
+
+Scalar pool setup and teardown functions.  scalar_pool_flush() gives the calling thread's cached free scalars back to
+the pool, and must be called by each thread before it finishes.  scalar_pool_stats() fills in stats with the pool's
+allocation counts, as POOL_MAGAZINE_STATS() does.
 
 =cut
 */
@@ -57,6 +98,14 @@ int scalar_pool_destroy(void) {
     return POOL_DESTROY(scalar_t);
 }
 
+int scalar_pool_flush(void) {
+    return POOL_FLUSH(scalar_t);
+}
+
+int scalar_pool_stats(pool_magazine_stats_t *stats) {
+    return POOL_MAGAZINE_STATS(scalar_t, stats);
+}
+
 /*
 =item scalar_allocate()
 
@@ -111,8 +160,7 @@ or initialised with {0}, then you do not need to also call C<anon_scalar_init()>
  */
 int anon_scalar_init(scalar_t *self) {
     assert(self != NULL);
-    self->m_flags = SCALAR_UNDEF;
-    self->m_value.as_int = 0;
+    memset(self, 0, sizeof(*self));
     return 0;
 }
 
@@ -127,47 +175,58 @@ This properly releases any references the object may hold.
  */
 int anon_scalar_destroy(scalar_t *self) {
     assert(self != NULL);
-    if (self->m_flags & SCALAR_FLAG_PTR) {
-        switch (self->m_flags & SCALAR_TYPE_MASK) {
+    const uint32_t flags = _anon_scalar_flags(self);
+
+    if (flags & SCALAR_FLAG_PTR) {
+        switch (flags & SCALAR_TYPE_MASK) {
             case SCALAR_STRING:
-                assert(self->m_value.as_string != NULL);
-                string_free(self->m_value.as_string);
+                assert(_anon_scalar_get_string(self) != NULL);
+                string_free(_anon_scalar_get_string(self));
+                break;
+#ifdef SCALAR_NANBOX
+            case SCALAR_INT:
+                free((void *) (uintptr_t) (self->m_bits & SCALAR_NANBOX_PAYLOAD_MASK));
                 break;
+#endif
             default:
-                debug("unexpected anon scalar type: %"PRIu32"\n", self->m_flags & SCALAR_TYPE_MASK);
+                debug("unexpected anon scalar type: %"PRIu32"\n", flags & SCALAR_TYPE_MASK);
                 break;
         }
     }
 
-    if (self->m_flags & SCALAR_FLAG_REF) {
-        switch (self->m_flags & SCALAR_TYPE_MASK) {
+    if (flags & SCALAR_FLAG_ROPE) {
+        assert(_anon_scalar_get_rope(self) != NULL);
+        rope_free(_anon_scalar_get_rope(self));
+    }
+
+    if (flags & SCALAR_FLAG_REF) {
+        switch (flags & SCALAR_TYPE_MASK) {
             case SCALAR_SCAREF:
-                scalar_release(self->m_value.as_scalar_handle);
+                scalar_release(_anon_scalar_get_handle(self));
                 break;
             case SCALAR_ARRREF:
-                array_release(self->m_value.as_array_handle);
+                array_release(_anon_scalar_get_handle(self));
                 break;
             case SCALAR_HASHREF:
-                hash_release(self->m_value.as_hash_handle);
+                hash_release(_anon_scalar_get_handle(self));
                 break;
             case SCALAR_CHANREF:
-                channel_release(self->m_value.as_channel_handle);
+                channel_release(_anon_scalar_get_handle(self));
                 break;
             case SCALAR_FUNCREF:
                 /* function references aren't allocated anywhere, and don't need to be released */
                 break;
             case SCALAR_STRMREF:
-                stream_release(self->m_value.as_stream_handle);
+                stream_release(_anon_scalar_get_handle(self));
                 break;
             //...
             default:
-                debug("unexpected anon scalar type: %"PRIu32"\n", self->m_flags & SCALAR_TYPE_MASK);
+                debug("unexpected anon scalar type: %"PRIu32"\n", flags & SCALAR_TYPE_MASK);
                 break;
         }
     }
 
-    self->m_flags = SCALAR_UNDEF;
-    self->m_value.as_int = 0;
+    memset(self, 0, sizeof(*self));
     return 0;
 }
 
@@ -184,36 +243,35 @@ int anon_scalar_clone(scalar_t * restrict self, const scalar_t * restrict other)
     
     if (self == other)  return 0;
     
-    if ((self->m_flags & SCALAR_TYPE_MASK) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
     
-    switch(other->m_flags & SCALAR_TYPE_MASK) {
+    switch(anon_scalar_type(other)) {
+        case SCALAR_INT:
+            _anon_scalar_set_int(self, _anon_scalar_get_int(other));
+            break;
         case SCALAR_STRING:
-            self->m_flags = SCALAR_FLAG_PTR | SCALAR_STRING;
-            self->m_value.as_string = string_dup(other->m_value.as_string);
+            // n.b. this copies the whole representation, so views and ropes stay views and ropes
+            memcpy(self, other, sizeof(*self));
+            if (_anon_scalar_flags(other) & SCALAR_FLAG_PTR)  string_dup(_anon_scalar_get_string(other));
+            if (_anon_scalar_flags(other) & SCALAR_FLAG_ROPE)  rope_dup(_anon_scalar_get_rope(other));
             break;
         case SCALAR_SCAREF:
-            self->m_flags = SCALAR_SCAREF;
-            self->m_value.as_scalar_handle = scalar_reference(other->m_value.as_scalar_handle);
+            _anon_scalar_set_handle(self, SCALAR_SCAREF, scalar_reference(_anon_scalar_get_handle(other)));
             break;
         case SCALAR_ARRREF:
-            self->m_flags = SCALAR_ARRREF;
-            self->m_value.as_array_handle = array_reference(other->m_value.as_array_handle);
+            _anon_scalar_set_handle(self, SCALAR_ARRREF, array_reference(_anon_scalar_get_handle(other)));
             break;
         case SCALAR_HASHREF:
-            self->m_flags = SCALAR_HASHREF;
-            self->m_value.as_hash_handle = hash_reference(other->m_value.as_hash_handle);
+            _anon_scalar_set_handle(self, SCALAR_HASHREF, hash_reference(_anon_scalar_get_handle(other)));
             break;
         case SCALAR_CHANREF:
-            self->m_flags = SCALAR_CHANREF;
-            self->m_value.as_channel_handle = channel_reference(other->m_value.as_channel_handle);
+            _anon_scalar_set_handle(self, SCALAR_CHANREF, channel_reference(_anon_scalar_get_handle(other)));
             break;
         case SCALAR_FUNCREF:
-            self->m_flags = SCALAR_FUNCREF;
-            self->m_value.as_function_handle = other->m_value.as_function_handle;
+            _anon_scalar_set_handle(self, SCALAR_FUNCREF, _anon_scalar_get_handle(other));
             break;
         case SCALAR_STRMREF:
-            self->m_flags = SCALAR_STRMREF;
-            self->m_value.as_stream_handle = stream_reference(other->m_value.as_stream_handle);
+            _anon_scalar_set_handle(self, SCALAR_STRMREF, stream_reference(_anon_scalar_get_handle(other)));
             break;
         //...
         default:
@@ -235,7 +293,7 @@ int anon_scalar_assign(scalar_t * restrict self, const scalar_t * restrict other
     
     if (self == other)  return 0;
     
-    if ((self->m_flags & SCALAR_TYPE_MASK) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
     
     memcpy(self, other, sizeof(scalar_t));
     return 0;
@@ -248,33 +306,48 @@ int anon_scalar_assign(scalar_t * restrict self, const scalar_t * restrict other
 
 =item anon_scalar_set_string_value()
 
+=item anon_scalar_set_string_bytes()
+
 Functions for setting the value of anonymous scalar_t objects.  Any previous value is properly cleaned up.
 
+Strings short enough to be stored inline in the scalar are copied there, without allocating.  Longer string_t values
+are shared with the caller, and longer byte sequences are copied into a newly allocated string_t.
+
 =cut
 */
 void anon_scalar_set_int_value(scalar_t *self, intptr_t ival) {
     assert(self != NULL);
-    if ((self->m_flags & SCALAR_TYPE_MASK) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
 
-    self->m_flags = SCALAR_INT;
-    self->m_value.as_int = ival;
+    _anon_scalar_set_int(self, ival);
 }
 
 void anon_scalar_set_float_value(scalar_t *self, floatptr_t fval) {
     assert(self != NULL);
-    if ((self->m_flags & SCALAR_TYPE_MASK) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
 
-    self->m_flags = SCALAR_FLOAT;
-    self->m_value.as_float = fval;
+    _anon_scalar_set_float(self, fval);
 }
 
 void anon_scalar_set_string_value(scalar_t *self, const string_t *sval) {
     assert(self != NULL);
     assert(sval != NULL);
-    if ((self->m_flags & SCALAR_TYPE_MASK) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
 
-    self->m_flags = SCALAR_FLAG_PTR | SCALAR_STRING;
-    self->m_value.as_string = string_dup(sval);
+    if (string_length(sval) <= SCALAR_SHORT_STRING_MAX) {
+        _anon_scalar_set_string_bytes(self, string_length(sval), string_cstr(sval));
+    }
+    else {
+        _anon_scalar_set_string(self, string_dup(sval));
+    }
+}
+
+void anon_scalar_set_string_bytes(scalar_t *self, size_t length, const char *bytes) {
+    assert(self != NULL);
+    assert(bytes != NULL || length == 0);
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+
+    _anon_scalar_set_string_bytes(self, length, bytes);
 }
 
 
@@ -299,50 +372,249 @@ cleaned up.
 
 void anon_scalar_set_scalar_reference(scalar_t *self, scalar_handle_t handle) {
     assert(self != NULL);
-    if ((self->m_flags & SCALAR_TYPE_MASK) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
     
-    self->m_flags = SCALAR_SCAREF;
-    self->m_value.as_scalar_handle = scalar_reference(handle);
+    _anon_scalar_set_handle(self, SCALAR_SCAREF, scalar_reference(handle));
 }
 
 void anon_scalar_set_array_reference(scalar_t *self, array_handle_t handle) {
     assert(self != NULL);
-    if ((self->m_flags & SCALAR_TYPE_MASK) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
     
-    self->m_flags = SCALAR_ARRREF;
-    self->m_value.as_array_handle = array_reference(handle);
+    _anon_scalar_set_handle(self, SCALAR_ARRREF, array_reference(handle));
 }
 
 void anon_scalar_set_hash_reference(scalar_t *self, hash_handle_t handle) {
     assert(self != NULL);
-    if ((self->m_flags & SCALAR_TYPE_MASK) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
     
-    self->m_flags = SCALAR_HASHREF;
-    self->m_value.as_hash_handle = hash_reference(handle);
+    _anon_scalar_set_handle(self, SCALAR_HASHREF, hash_reference(handle));
 }
 
 void anon_scalar_set_channel_reference(scalar_t *self, channel_handle_t handle) {
     assert(self != NULL);
-    if ((self->m_flags & SCALAR_TYPE_MASK) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
     
-    self->m_flags = SCALAR_CHANREF;
-    self->m_value.as_channel_handle = channel_reference(handle);
+    _anon_scalar_set_handle(self, SCALAR_CHANREF, channel_reference(handle));
 }
 
 void anon_scalar_set_function_reference(scalar_t *self, function_handle_t handle) {
     assert(self != NULL);
-    if ((self->m_flags & SCALAR_TYPE_MASK) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
     
-    self->m_flags = SCALAR_FUNCREF;
-    self->m_value.as_function_handle = handle;
+    _anon_scalar_set_handle(self, SCALAR_FUNCREF, handle);
 }
 
 void anon_scalar_set_stream_reference(scalar_t *self, stream_handle_t handle) {
     assert(self != NULL);
-    if ((self->m_flags & SCALAR_TYPE_MASK) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
     
-    self->m_flags = SCALAR_STRMREF;
-    self->m_value.as_stream_handle = stream_reference(handle);
+    _anon_scalar_set_handle(self, SCALAR_STRMREF, stream_reference(handle));
+}
+
+/*
+=item anon_scalar_append_bytes()
+
+=item anon_scalar_append_value()
+
+Append length bytes, or the string value of another scalar, to the string value of an anonymous scalar in place.  A
+scalar that isn't already a string becomes one first.  An allocated string is appended to with C<string_append()>, so
+its capacity grows geometrically and building up a long string a piece at a time takes linear time overall.  A rope is
+appended to without being flattened, and shares the value's bytes rather than copying them where it can.
+
+=cut
+*/
+void anon_scalar_append_bytes(scalar_t *self, size_t length, const char *bytes) {
+    assert(self != NULL);
+    assert(bytes != NULL || length == 0);
+
+    if (_anon_scalar_flags(self) & SCALAR_FLAG_ROPE) {
+        rope_t *rope = _anon_scalar_get_rope(self);
+        rope_append_bytes(&rope, length, bytes);
+        _anon_scalar_set_rope(self, rope);
+        return;
+    }
+
+    if (_anon_scalar_flags(self) == (SCALAR_FLAG_PTR | SCALAR_STRING)) {
+        string_t *str = _anon_scalar_get_string(self);
+        string_append(&str, length, bytes);
+        _anon_scalar_set_string(self, str);
+        return;
+    }
+
+    char buffer[SCALAR_FORMAT_BUFFER_SIZE];
+    size_t current_length;
+    const char *current = anon_scalar_format(self, buffer, &current_length);
+
+    if (current_length + length <= SCALAR_SHORT_STRING_MAX) {
+        char joined[SCALAR_SHORT_STRING_MAX + 1];
+        memcpy(joined, current, current_length);
+        memcpy(joined + current_length, bytes, length);
+        if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+        _anon_scalar_set_string_bytes(self, current_length + length, joined);
+    }
+    else {
+        string_t *str = string_alloc(current_length + length, NULL);
+        if (str == NULL) {
+            debug("couldn't allocate string of %zu bytes\n", current_length + length);
+            return;
+        }
+        string_append(&str, current_length, current);
+        string_append(&str, length, bytes);
+        if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+        _anon_scalar_set_string(self, str);
+    }
+}
+
+void anon_scalar_append_value(scalar_t * restrict self, const scalar_t * restrict value) {
+    assert(self != NULL);
+    assert(value != NULL);
+
+    if (_anon_scalar_flags(self) & SCALAR_FLAG_ROPE) {
+        rope_t *rope = _anon_scalar_get_rope(self);
+        _anon_scalar_append_to_rope(&rope, value);
+        _anon_scalar_set_rope(self, rope);
+        return;
+    }
+
+    char buffer[SCALAR_FORMAT_BUFFER_SIZE];
+    size_t length;
+    const char *bytes = anon_scalar_format(value, buffer, &length);
+    anon_scalar_append_bytes(self, length, bytes);
+}
+
+/*
+=item anon_scalar_concatenate()
+
+Sets an anonymous scalar to the concatenation of the string values of count scalars.  The scalars are taken over, and
+left undefined.
+
+A short result is copied into a single string.  A long one is built as a rope, which shares the items' bytes rather
+than copying them, and if the first item is already a rope the rest are appended to it in place.  Repeatedly
+concatenating more onto the end of a long string therefore doesn't copy the whole string each time.
+
+=cut
+*/
+void anon_scalar_concatenate(scalar_t * restrict self, size_t count, scalar_t * restrict items) {
+    assert(self != NULL);
+    assert(items != NULL || count == 0);
+
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += anon_scalar_get_string_length(&items[i]);
+    }
+
+    scalar_t result = {0};
+    if (total < SCALAR_ROPE_MIN_LENGTH) {
+        char buffer[SCALAR_FORMAT_BUFFER_SIZE];
+        size_t length;
+        string_t *str = string_alloc(total, NULL);
+        if (str != NULL) {
+            for (size_t i = 0; i < count; i++) {
+                const char *bytes = anon_scalar_format(&items[i], buffer, &length);
+                string_append(&str, length, bytes);
+            }
+            anon_scalar_set_string_value(&result, str);
+            string_free(str);
+        }
+        else {
+            debug("couldn't allocate string of %zu bytes\n", total);
+        }
+    }
+    else {
+        rope_t *rope;
+        size_t first = 0;
+        if (_anon_scalar_flags(&items[0]) & SCALAR_FLAG_ROPE) {
+            // take the rope over, so that if nothing else shares it it can be appended to in place
+            rope = _anon_scalar_get_rope(&items[0]);
+            anon_scalar_init(&items[0]);
+            first = 1;
+        }
+        else {
+            rope = rope_alloc(count);
+        }
+
+        if (rope != NULL) {
+            for (size_t i = first; i < count; i++) {
+                _anon_scalar_append_to_rope(&rope, &items[i]);
+            }
+            _anon_scalar_set_rope(&result, rope);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        anon_scalar_destroy(&items[i]);
+    }
+
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+    memcpy(self, &result, sizeof(*self));
+}
+
+/*
+=item anon_scalar_set_substring()
+
+Sets an anonymous scalar to length bytes of the string value of source, starting at offset.  Where possible the result
+is a view that shares source's bytes, so taking a substring of a long string doesn't allocate or copy.  Short results
+are stored inline as usual.  self and source may be the same scalar.
+
+=cut
+*/
+void anon_scalar_set_substring(scalar_t *self, const scalar_t *source, size_t offset, size_t length) {
+    assert(self != NULL);
+    assert(source != NULL);
+
+    char buffer[SCALAR_FORMAT_BUFFER_SIZE];
+    size_t source_length;
+    const char *bytes = anon_scalar_format(source, buffer, &source_length);
+    assert(offset + length <= source_length);
+
+    scalar_t result = {0};
+    if (length > SCALAR_SHORT_STRING_MAX && anon_scalar_type(source) == SCALAR_STRING
+        && (_anon_scalar_flags(source) & (SCALAR_FLAG_PTR | SCALAR_FLAG_ROPE))) {
+        // n.b. a rope's bytes are those of its flattened string, so a substring of a rope is a view of that
+        string_t *parent = (_anon_scalar_flags(source) & SCALAR_FLAG_ROPE
+                            ? (string_t *) rope_flatten(_anon_scalar_get_rope(source))
+                            : _anon_scalar_get_string(source));
+        const size_t parent_offset = bytes + offset - string_cstr(parent);
+
+        if (parent_offset == 0 && length == string_length(parent)) {
+            _anon_scalar_set_string(&result, string_dup(parent));
+        }
+        else if (0 != _anon_scalar_set_string_view(&result, parent, parent_offset, length)) {
+            _anon_scalar_set_string_bytes(&result, length, bytes + offset);
+        }
+    }
+    else {
+        _anon_scalar_set_string_bytes(&result, length, bytes + offset);
+    }
+
+    if (anon_scalar_type(self) != SCALAR_UNDEF)  anon_scalar_destroy(self);
+    memcpy(self, &result, sizeof(*self));
+}
+
+/*
+=item anon_scalar_compact()
+
+If an anonymous scalar is a view on a string much longer than itself, replaces it with a copy of just its own bytes,
+so that it doesn't keep the rest of the string alive.  Otherwise does nothing.
+
+=cut
+*/
+void anon_scalar_compact(scalar_t *self) {
+    assert(self != NULL);
+
+    if (_anon_scalar_flags(self) & SCALAR_FLAG_VIEW) {
+        size_t length;
+        const char *bytes = _anon_scalar_get_string_bytes(self, &length);
+        const size_t parent_length = string_length(_anon_scalar_get_string(self));
+
+        if (parent_length >= SCALAR_VIEW_COMPACT_MIN_PARENT && parent_length / SCALAR_VIEW_COMPACT_RATIO >= length) {
+            scalar_t copy = {0};
+            _anon_scalar_set_string_bytes(&copy, length, bytes);
+            anon_scalar_destroy(self);
+            memcpy(self, &copy, sizeof(*self));
+        }
+    }
 }
 
 /*
@@ -354,7 +626,7 @@ Returns 1 if a scalar has some sort of value, or zero if it is undefined.
  */
 intptr_t anon_scalar_is_defined(const scalar_t * self) {
     assert(self != NULL);
-    switch (self->m_flags & SCALAR_TYPE_MASK) {
+    switch (anon_scalar_type(self)) {
         case SCALAR_UNDEF:
             return 0;
         case SCALAR_INT:
@@ -368,7 +640,7 @@ intptr_t anon_scalar_is_defined(const scalar_t * self) {
         case SCALAR_STRMREF:
             return 1;
         default:
-            debug("unhandled scalar type: %"PRIu32"\n", self->m_flags);
+            debug("unhandled scalar type: %"PRIu32"\n", _anon_scalar_flags(self));
             return 0;
     }
 }
@@ -383,37 +655,46 @@ intptr_t anon_scalar_is_defined(const scalar_t * self) {
 
 =item anon_scalar_get_string_value()
 
-Functions for getting values from anonymous scalar_t objects.
+Functions for getting values from anonymous scalar_t objects.  Conversions between numbers and strings are done by
+the numeric module, so floats become strings with as many digits as it takes to read them back exactly, and no more.
+
+The numeric value of an allocated string is cached in the string_t (see C<string_int_value()>), so it's only parsed
+once however many scalars share it.  A rope's is cached in its flattened string.  An inline string short enough to
+leave room keeps its value alongside it if it's a plain decimal integer (see SCALAR_FLAG_SHORT_INT); other inline
+strings are parsed each time.  Numbers are formatted as strings each time they're used as one.
 
 =cut
 */
 intptr_t anon_scalar_get_bool_value(const scalar_t *self) {
     assert(self != NULL);
-    switch (self->m_flags & SCALAR_TYPE_MASK) {
+    switch (anon_scalar_type(self)) {
         case SCALAR_UNDEF:
             return 0;
         case SCALAR_INT:
+            return (_anon_scalar_get_int(self) != 0);
         case SCALAR_SCAREF:
         case SCALAR_ARRREF:
         case SCALAR_HASHREF:
         case SCALAR_CHANREF:
         case SCALAR_FUNCREF:
         case SCALAR_STRMREF:
-            return (self->m_value.as_int != 0);
+            return (_anon_scalar_get_handle(self) != 0);
         case SCALAR_FLOAT:
-            return (self->m_value.as_float != 0);
+            return (_anon_scalar_get_float(self) != 0);
             break;
-        case SCALAR_STRING:
-            assert(self->m_value.as_string != NULL);            
-            if (string_length(self->m_value.as_string) > 0) {
-                if (string_length(self->m_value.as_string) == 1 && self->m_value.as_string->m_bytes[0] == '0') {
+        case SCALAR_STRING: {
+            size_t length;
+            const char *bytes = _anon_scalar_get_string_bytes(self, &length);
+            if (length > 0) {
+                if (length == 1 && bytes[0] == '0') {
                     return 0;
                 }
                 return 1;
             }
             return 0;
+        }
         default:
-            debug("unhandled scalar type: %"PRIu32"\n", self->m_flags);
+            debug("unhandled scalar type: %"PRIu32"\n", _anon_scalar_flags(self));
             return 0;
     }
 }
@@ -421,22 +702,35 @@ intptr_t anon_scalar_get_bool_value(const scalar_t *self) {
 intptr_t anon_scalar_get_int_value(const scalar_t *self) {
     assert(self != NULL);
     intptr_t value;
-    switch (self->m_flags & SCALAR_TYPE_MASK) {
+    switch (anon_scalar_type(self)) {
         case SCALAR_INT:
-            value = self->m_value.as_int;
+            value = _anon_scalar_get_int(self);
             break;
         case SCALAR_FLOAT:
-            value = (intptr_t) self->m_value.as_float;
+            value = (intptr_t) _anon_scalar_get_float(self);
             break;
         case SCALAR_STRING:
-            assert(self->m_value.as_string != NULL);
-            value = strtol(string_cstr(self->m_value.as_string), NULL, 0);
+            if (_anon_scalar_flags(self) == (SCALAR_FLAG_PTR | SCALAR_STRING)) {
+                value = string_int_value(_anon_scalar_get_string(self));
+            }
+            else if (_anon_scalar_flags(self) & SCALAR_FLAG_ROPE) {
+                value = string_int_value(rope_flatten(_anon_scalar_get_rope(self)));
+            }
+            else if (_anon_scalar_flags(self) & SCALAR_FLAG_SHORT_INT) {
+                value = _anon_scalar_get_short_int(self);
+            }
+            else {
+                char buffer[SCALAR_FORMAT_BUFFER_SIZE];
+                string_t *tmp = NULL;
+                value = numeric_parse_int(_anon_scalar_get_string_cstr(self, buffer, sizeof(buffer), &tmp));
+                string_free(tmp);
+            }
             break;
         case SCALAR_UNDEF:
             value = 0;
             break;
         default:
-            debug("unexpected type value %"PRIu32"\n", self->m_flags & SCALAR_TYPE_MASK);
+            debug("unexpected type value %"PRIu32"\n", anon_scalar_type(self));
             value = 0;
             break;
     }
@@ -447,22 +741,35 @@ floatptr_t anon_scalar_get_float_value(const scalar_t *self) {
     assert(self != NULL);
     floatptr_t value;
     
-    switch(self->m_flags & SCALAR_TYPE_MASK) {
+    switch (anon_scalar_type(self)) {
         case SCALAR_INT:
-            value = (floatptr_t) self->m_value.as_int;
+            value = (floatptr_t) _anon_scalar_get_int(self);
             break;
         case SCALAR_FLOAT:
-            value = self->m_value.as_float;
+            value = _anon_scalar_get_float(self);
             break;
         case SCALAR_STRING:
-            assert(self->m_value.as_string != NULL);
-            value = strtof(string_cstr(self->m_value.as_string), NULL);
+            if (_anon_scalar_flags(self) == (SCALAR_FLAG_PTR | SCALAR_STRING)) {
+                value = string_float_value(_anon_scalar_get_string(self));
+            }
+            else if (_anon_scalar_flags(self) & SCALAR_FLAG_ROPE) {
+                value = string_float_value(rope_flatten(_anon_scalar_get_rope(self)));
+            }
+            else if (_anon_scalar_flags(self) & SCALAR_FLAG_SHORT_INT) {
+                value = (floatptr_t) _anon_scalar_get_short_int(self);
+            }
+            else {
+                char buffer[SCALAR_FORMAT_BUFFER_SIZE];
+                string_t *tmp = NULL;
+                value = numeric_parse_float(_anon_scalar_get_string_cstr(self, buffer, sizeof(buffer), &tmp));
+                string_free(tmp);
+            }
             break;
         case SCALAR_UNDEF:
             value = 0;
             break;
         default:
-            debug("unexpected type value %"PRIu32"\n", self->m_flags & SCALAR_TYPE_MASK);
+            debug("unexpected type value %"PRIu32"\n", anon_scalar_type(self));
             value = 0;
             break;
     }
@@ -473,56 +780,133 @@ floatptr_t anon_scalar_get_float_value(const scalar_t *self) {
 void anon_scalar_get_string_value(const scalar_t *self, string_t **result) {
     assert(self != NULL);
     
-    char buffer[100];
+    if (_anon_scalar_flags(self) == (SCALAR_FLAG_PTR | SCALAR_STRING)) {
+        *result = string_dup(_anon_scalar_get_string(self));
+    }
+    else if (_anon_scalar_flags(self) & SCALAR_FLAG_ROPE) {
+        *result = string_dup(rope_flatten(_anon_scalar_get_rope(self)));
+    }
+    else {
+        char buffer[SCALAR_FORMAT_BUFFER_SIZE];
+        size_t length;
+        const char *bytes = anon_scalar_format(self, buffer, &length);
+        *result = string_alloc(length, bytes);
+    }
+
+    return;
+}
+
+/*
+=item anon_scalar_get_string_bytes()
+
+Returns a pointer to the bytes of a string scalar, and sets *length (if length isn't NULL) to the number of bytes,
+without copying or allocating anything.  The pointer remains valid only until the scalar is next modified or destroyed.
+Returns NULL if the scalar isn't a string, in which case use C<anon_scalar_get_string_value()>.
+
+The bytes are followed by a terminating NUL unless the scalar is a string view, so use the length.  A rope is
+flattened to get its bytes.
+
+=cut
+*/
+const char *anon_scalar_get_string_bytes(const scalar_t *self, size_t *length) {
+    assert(self != NULL);
+
+    if (anon_scalar_type(self) != SCALAR_STRING)  return NULL;
+
+    return _anon_scalar_get_string_bytes(self, length);
+}
+
+/*
+=item anon_scalar_get_string_length()
+
+Returns the length of the string value of a scalar, without flattening a rope or allocating anything.
+
+=cut
+*/
+size_t anon_scalar_get_string_length(const scalar_t *self) {
+    assert(self != NULL);
+
+    if (_anon_scalar_flags(self) & SCALAR_FLAG_ROPE)  return rope_length(_anon_scalar_get_rope(self));
+
+    char buffer[SCALAR_FORMAT_BUFFER_SIZE];
+    size_t length;
+    anon_scalar_format(self, buffer, &length);
+    return length;
+}
+
+/*
+=item anon_scalar_get_rope()
+
+Returns the rope_t of a scalar that holds one, or NULL if it doesn't, for things like C<stream_write_rope()> that can
+deal with a rope's pieces directly.  Like C<anon_scalar_get_string_bytes()>, the result is only valid until the scalar
+is next modified or destroyed.
+
+=cut
+*/
+const rope_t *anon_scalar_get_rope(const scalar_t *self) {
+    assert(self != NULL);
+
+    return (_anon_scalar_flags(self) & SCALAR_FLAG_ROPE ? _anon_scalar_get_rope(self) : NULL);
+}
+
+/*
+=item anon_scalar_format()
+
+Returns a pointer to the string value of a scalar, and sets *length (if length isn't NULL) to the number of bytes,
+without allocating anything.  For a string scalar this is the same as C<anon_scalar_get_string_bytes()>, so the bytes
+may not be NUL-terminated.  Any other value is formatted into buffer, which must be at least SCALAR_FORMAT_BUFFER_SIZE
+bytes.
+
+=cut
+*/
+const char *anon_scalar_format(const scalar_t *self, char *buffer, size_t *length) {
+    assert(self != NULL);
+    assert(buffer != NULL);
+
+    size_t n;
     
-    switch(self->m_flags & SCALAR_TYPE_MASK) {
+    switch (anon_scalar_type(self)) {
         case SCALAR_UNDEF:
-            *result = string_alloc(0, NULL);
+            buffer[0] = '\0';
+            n = 0;
             break;
         case SCALAR_INT:
-            snprintf(buffer, sizeof(buffer), "%"PRIiPTR"", self->m_value.as_int);
-            *result = string_alloc(strlen(buffer), buffer);
+            n = numeric_format_int(buffer, _anon_scalar_get_int(self));
             break;
         case SCALAR_FLOAT:
-            snprintf(buffer, sizeof(buffer), "%f", self->m_value.as_float);
-            *result = string_alloc(strlen(buffer), buffer);
+            n = numeric_format_float(buffer, _anon_scalar_get_float(self));
             break;
         case SCALAR_STRING:
-            *result = string_dup(self->m_value.as_string);
-            break;
+            return _anon_scalar_get_string_bytes(self, length);
 
         case SCALAR_SCAREF:
-            snprintf(buffer, sizeof(buffer), "SCALAR(%"PRIuPTR")", self->m_value.as_scalar_handle);
-            *result = string_alloc(strlen(buffer), buffer);
+            n = snprintf(buffer, SCALAR_FORMAT_BUFFER_SIZE, "SCALAR(%"PRIuPTR")", _anon_scalar_get_handle(self));
             break;
         case SCALAR_ARRREF:
-            snprintf(buffer, sizeof(buffer), "ARRAY(%"PRIuPTR")", self->m_value.as_array_handle);
-            *result = string_alloc(strlen(buffer), buffer);
+            n = snprintf(buffer, SCALAR_FORMAT_BUFFER_SIZE, "ARRAY(%"PRIuPTR")", _anon_scalar_get_handle(self));
             break;
         case SCALAR_HASHREF:
-            snprintf(buffer, sizeof(buffer), "HASH(%"PRIuPTR")", self->m_value.as_hash_handle);
-            *result = string_alloc(strlen(buffer), buffer);
+            n = snprintf(buffer, SCALAR_FORMAT_BUFFER_SIZE, "HASH(%"PRIuPTR")", _anon_scalar_get_handle(self));
             break;
         case SCALAR_CHANREF:
-            snprintf(buffer, sizeof(buffer), "CHANNEL(%"PRIuPTR")", self->m_value.as_channel_handle);
-            *result = string_alloc(strlen(buffer), buffer);
+            n = snprintf(buffer, SCALAR_FORMAT_BUFFER_SIZE, "CHANNEL(%"PRIuPTR")", _anon_scalar_get_handle(self));
             break;
         case SCALAR_FUNCREF:
-            snprintf(buffer, sizeof(buffer), "FUNCTION(%"PRIuPTR")", self->m_value.as_function_handle);
-            *result = string_alloc(strlen(buffer), buffer);
+            n = snprintf(buffer, SCALAR_FORMAT_BUFFER_SIZE, "FUNCTION(%"PRIuPTR")", _anon_scalar_get_handle(self));
             break;
         case SCALAR_STRMREF:
-            snprintf(buffer, sizeof(buffer), "STREAM(%"PRIuPTR")", self->m_value.as_stream_handle);
-            *result = string_alloc(strlen(buffer), buffer);
+            n = snprintf(buffer, SCALAR_FORMAT_BUFFER_SIZE, "STREAM(%"PRIuPTR")", _anon_scalar_get_handle(self));
             break;
         //...        
         default:
-            debug("unexpected type value %"PRIu32"\n", self->m_flags & SCALAR_TYPE_MASK);
-            *result = string_alloc(0, NULL);
+            debug("unexpected type value %"PRIu32"\n", anon_scalar_type(self));
+            buffer[0] = '\0';
+            n = 0;
             break;
     }
 
-    return;
+    if (length != NULL)  *length = n;
+    return buffer;
 }
 
 /*
@@ -550,44 +934,44 @@ when you are finished with it call C<foo_release> to release it.
 */
 scalar_handle_t anon_scalar_deref_scalar_reference(const scalar_t *self) {
     assert(self != NULL);
-    assert((self->m_flags & SCALAR_TYPE_MASK) == SCALAR_SCAREF);
+    assert(anon_scalar_type(self) == SCALAR_SCAREF);
     
-    return self->m_value.as_scalar_handle;
+    return _anon_scalar_get_handle(self);
 }
 
 array_handle_t anon_scalar_deref_array_reference(const scalar_t *self) {
     assert(self != NULL);
-    assert((self->m_flags & SCALAR_TYPE_MASK) == SCALAR_ARRREF);
+    assert(anon_scalar_type(self) == SCALAR_ARRREF);
     
-    return self->m_value.as_array_handle;
+    return _anon_scalar_get_handle(self);
 }
 
 hash_handle_t anon_scalar_deref_hash_reference(const scalar_t *self) {
     assert(self != NULL);
-    assert((self->m_flags & SCALAR_TYPE_MASK) == SCALAR_HASHREF);
+    assert(anon_scalar_type(self) == SCALAR_HASHREF);
     
-    return self->m_value.as_hash_handle;
+    return _anon_scalar_get_handle(self);
 }
 
 channel_handle_t anon_scalar_deref_channel_reference(const scalar_t *self) {
     assert(self != NULL);
-    assert((self->m_flags & SCALAR_TYPE_MASK) == SCALAR_CHANREF);
+    assert(anon_scalar_type(self) == SCALAR_CHANREF);
     
-    return self->m_value.as_channel_handle;    
+    return _anon_scalar_get_handle(self);    
 }
 
 function_handle_t anon_scalar_deref_function_reference(const scalar_t *self) {
     assert(self != NULL);
-    assert((self->m_flags & SCALAR_TYPE_MASK) == SCALAR_FUNCREF);
+    assert(anon_scalar_type(self) == SCALAR_FUNCREF);
     
-    return self->m_value.as_function_handle;
+    return _anon_scalar_get_handle(self);
 }
 
 stream_handle_t anon_scalar_deref_stream_reference(const scalar_t *self) {
     assert(self != NULL);
-    assert((self->m_flags & SCALAR_TYPE_MASK) == SCALAR_STRMREF);
+    assert(anon_scalar_type(self) == SCALAR_STRMREF);
     
-    return self->m_value.as_stream_handle;
+    return _anon_scalar_get_handle(self);
 }
 
 
@@ -598,8 +982,325 @@ stream_handle_t anon_scalar_deref_stream_reference(const scalar_t *self) {
 
 =over
 
+=item _anon_scalar_flags()
+
+=item _anon_scalar_get_int()
+
+=item _anon_scalar_get_float()
+
+=item _anon_scalar_get_string()
+
+=item _anon_scalar_get_rope()
+
+=item _anon_scalar_get_handle()
+
+=item _anon_scalar_set_int()
+
+=item _anon_scalar_set_float()
+
+=item _anon_scalar_set_string()
+
+=item _anon_scalar_set_rope()
+
+=item _anon_scalar_set_handle()
+
+=item _anon_scalar_get_string_bytes()
+
+=item _anon_scalar_set_string_bytes()
+
+=item _anon_scalar_get_short_int()
+
+The representation of a scalar_t is only known to these functions.  C<_anon_scalar_flags()> returns the SCALAR_* type
+and flags, as stored in m_flags by the default representation.  The getters expect the scalar to be of the right type
+already.  The setters expect the scalar to hold nothing that needs cleaning up, and take ownership of the string
+they're given.
+
+C<_anon_scalar_get_string()> and C<_anon_scalar_set_string()> deal only in allocated strings, which a string scalar has
+if SCALAR_FLAG_PTR is set, and C<_anon_scalar_get_rope()> and C<_anon_scalar_set_rope()> only in ropes, which it has if
+SCALAR_FLAG_ROPE is set.  C<_anon_scalar_get_string_bytes()> and C<_anon_scalar_set_string_bytes()> work with any
+string scalar, storing short strings inline where the representation allows it, and flattening ropes.  C<_anon_scalar_set_string_view()>
+takes a new reference to parent if it succeeds, and returns non-zero without doing anything if the representation
+can't hold a view of that offset and length.  C<_anon_scalar_get_short_int()> returns the value kept with an inline
+string that has SCALAR_FLAG_SHORT_INT.  The NaN-boxed representation has no room for inline strings or views, so
+always allocates.
+
+=cut
+*/
+#ifdef SCALAR_NANBOX
+static inline uint32_t _anon_scalar_flags(const scalar_t *self) {
+    const uint64_t tag = self->m_bits >> SCALAR_NANBOX_TAG_SHIFT;
+
+    if (tag == SCALAR_NANBOX_TAG_STRING || tag == SCALAR_NANBOX_TAG_BIG_INT)  return SCALAR_FLAG_PTR | anon_scalar_type(self);
+    if (tag == SCALAR_NANBOX_TAG_ROPE)  return SCALAR_FLAG_ROPE | SCALAR_STRING;
+    return anon_scalar_type(self);
+}
+
+static inline intptr_t _anon_scalar_get_int(const scalar_t *self) {
+    if ((self->m_bits >> SCALAR_NANBOX_TAG_SHIFT) == SCALAR_NANBOX_TAG_BIG_INT) {
+        return *(const intptr_t *) (uintptr_t) (self->m_bits & SCALAR_NANBOX_PAYLOAD_MASK);
+    }
+    return anon_scalar_int(self);
+}
+
+static inline floatptr_t _anon_scalar_get_float(const scalar_t *self) {
+    const uint64_t bits = self->m_bits - SCALAR_NANBOX_FLOAT_OFFSET;
+    floatptr_t fval;
+    memcpy(&fval, &bits, sizeof(fval));
+    return fval;
+}
+
+static inline string_t *_anon_scalar_get_string(const scalar_t *self) {
+    return (string_t *) (uintptr_t) (self->m_bits & SCALAR_NANBOX_PAYLOAD_MASK);
+}
+
+static inline rope_t *_anon_scalar_get_rope(const scalar_t *self) {
+    return (rope_t *) (uintptr_t) (self->m_bits & SCALAR_NANBOX_PAYLOAD_MASK);
+}
+
+static inline handle_t _anon_scalar_get_handle(const scalar_t *self) {
+    return (handle_t) (self->m_bits & SCALAR_NANBOX_PAYLOAD_MASK);
+}
+
+static inline void _anon_scalar_set_int(scalar_t *self, intptr_t ival) {
+    if (ival >= SCALAR_NANBOX_INT_MIN && ival <= SCALAR_NANBOX_INT_MAX) {
+        anon_scalar_put_int(self, ival);
+    }
+    else {
+        intptr_t *box = malloc(sizeof(*box));
+        if (box != NULL) {
+            *box = ival;
+            assert(((uintptr_t) box & ~SCALAR_NANBOX_PAYLOAD_MASK) == 0);
+            self->m_bits = (SCALAR_NANBOX_TAG_BIG_INT << SCALAR_NANBOX_TAG_SHIFT) | (uintptr_t) box;
+        }
+        else {
+            debug("couldn't allocate box for int %"PRIiPTR"\n", ival);
+            self->m_bits = 0;
+        }
+    }
+}
+
+static inline void _anon_scalar_set_float(scalar_t *self, floatptr_t fval) {
+    uint64_t bits;
+    if (isnan(fval)) {
+        bits = UINT64_C(0x7FF8000000000000);
+    }
+    else {
+        memcpy(&bits, &fval, sizeof(bits));
+    }
+    self->m_bits = bits + SCALAR_NANBOX_FLOAT_OFFSET;
+}
+
+static inline void _anon_scalar_set_string(scalar_t *self, string_t *sval) {
+    assert(((uintptr_t) sval & ~SCALAR_NANBOX_PAYLOAD_MASK) == 0);
+    self->m_bits = (SCALAR_NANBOX_TAG_STRING << SCALAR_NANBOX_TAG_SHIFT) | (uintptr_t) sval;
+}
+
+static inline void _anon_scalar_set_rope(scalar_t *self, rope_t *rval) {
+    assert(((uintptr_t) rval & ~SCALAR_NANBOX_PAYLOAD_MASK) == 0);
+    self->m_bits = (SCALAR_NANBOX_TAG_ROPE << SCALAR_NANBOX_TAG_SHIFT) | (uintptr_t) rval;
+}
+
+static inline void _anon_scalar_set_handle(scalar_t *self, uint32_t type, handle_t handle) {
+    assert(type & SCALAR_FLAG_REF);
+    assert((handle & ~SCALAR_NANBOX_PAYLOAD_MASK) == 0);
+    const uint64_t tag = SCALAR_NANBOX_TAG_REF | (type & ~SCALAR_FLAG_REF & SCALAR_TYPE_MASK);
+    self->m_bits = (tag << SCALAR_NANBOX_TAG_SHIFT) | handle;
+}
+
+static inline const char *_anon_scalar_get_string_bytes(const scalar_t *self, size_t *length) {
+    const string_t *str = ((self->m_bits >> SCALAR_NANBOX_TAG_SHIFT) == SCALAR_NANBOX_TAG_ROPE
+                           ? rope_flatten(_anon_scalar_get_rope(self))
+                           : _anon_scalar_get_string(self));
+    assert(str != NULL);
+
+    if (length != NULL)  *length = string_length(str);
+    return string_cstr(str);
+}
+
+static inline void _anon_scalar_set_string_bytes(scalar_t *self, size_t length, const char *bytes) {
+    _anon_scalar_set_string(self, string_alloc(length, bytes));
+}
+
+static inline int _anon_scalar_set_string_view(scalar_t *self, string_t *parent, size_t offset, size_t length) {
+    return -1;
+}
+
+static inline intptr_t _anon_scalar_get_short_int(const scalar_t *self) {
+    return 0;
+}
+#else
+static inline uint32_t _anon_scalar_flags(const scalar_t *self) {
+    return self->m_flags;
+}
+
+static inline intptr_t _anon_scalar_get_int(const scalar_t *self) {
+    return self->m_value.as_int;
+}
+
+static inline floatptr_t _anon_scalar_get_float(const scalar_t *self) {
+    return self->m_value.as_float;
+}
+
+static inline string_t *_anon_scalar_get_string(const scalar_t *self) {
+    return self->m_value.as_string;
+}
+
+static inline rope_t *_anon_scalar_get_rope(const scalar_t *self) {
+    return self->m_value.as_rope;
+}
+
+static inline handle_t _anon_scalar_get_handle(const scalar_t *self) {
+    return self->m_value.as_scalar_handle;  // handle types are interchangeable
+}
+
+static inline void _anon_scalar_set_int(scalar_t *self, intptr_t ival) {
+    self->m_flags = SCALAR_INT;
+    self->m_value.as_int = ival;
+}
+
+static inline void _anon_scalar_set_float(scalar_t *self, floatptr_t fval) {
+    self->m_flags = SCALAR_FLOAT;
+    self->m_value.as_float = fval;
+}
+
+static inline void _anon_scalar_set_string(scalar_t *self, string_t *sval) {
+    self->m_flags = SCALAR_FLAG_PTR | SCALAR_STRING;
+    self->m_value.as_string = sval;
+}
+
+static inline void _anon_scalar_set_rope(scalar_t *self, rope_t *rval) {
+    self->m_flags = SCALAR_FLAG_ROPE | SCALAR_STRING;
+    self->m_value.as_rope = rval;
+}
+
+static inline void _anon_scalar_set_handle(scalar_t *self, uint32_t type, handle_t handle) {
+    assert(type & SCALAR_FLAG_REF);
+    self->m_flags = type;
+    self->m_value.as_scalar_handle = handle;
+}
+
+static inline intptr_t _anon_scalar_get_short_int(const scalar_t *self) {
+    int32_t ival;
+    memcpy(&ival, (const char *) self + SCALAR_SHORT_INT_OFFSET, sizeof(ival));
+    return ival;
+}
+
+static inline const char *_anon_scalar_get_string_bytes(const scalar_t *self, size_t *length) {
+    if (self->m_flags & SCALAR_FLAG_SHORT) {
+        if (length != NULL)  *length = (self->m_flags & SCALAR_SHORT_LENGTH_MASK) >> SCALAR_SHORT_LENGTH_SHIFT;
+        return (const char *) self + offsetof(scalar_t, m_short_string);
+    }
+
+    if (self->m_flags & SCALAR_FLAG_ROPE) {
+        const string_t *flat = rope_flatten(self->m_value.as_rope);
+        assert(flat != NULL);
+        if (length != NULL)  *length = string_length(flat);
+        return string_cstr(flat);
+    }
+
+    assert(self->m_value.as_string != NULL);
+    if (self->m_flags & SCALAR_FLAG_VIEW) {
+        if (length != NULL)  *length = (self->m_flags & SCALAR_VIEW_LENGTH_MASK) >> SCALAR_VIEW_LENGTH_SHIFT;
+        return string_cstr(self->m_value.as_string) + self->m_view_offset;
+    }
+
+    if (length != NULL)  *length = string_length(self->m_value.as_string);
+    return string_cstr(self->m_value.as_string);
+}
+
+/* parses bytes as numeric_parse_int() would if they are a plain decimal integer that fits an int32_t, else returns 0 */
+static inline int _anon_scalar_parse_short_int(const char *bytes, size_t length, int32_t *value) {
+    const int negative = (bytes[0] == '-');
+    size_t i = negative;
+    if (i == length || (bytes[i] == '0' && length > 1))  return 0;
+
+    int32_t ival = 0;
+    for (; i < length; i++) {
+        if (bytes[i] < '0' || bytes[i] > '9')  return 0;
+        ival = ival * 10 + (bytes[i] - '0');
+    }
+
+    *value = negative ? -ival : ival;
+    return 1;
+}
+
+static inline void _anon_scalar_set_string_bytes(scalar_t *self, size_t length, const char *bytes) {
+    if (length <= SCALAR_SHORT_STRING_MAX) {
+        char *short_string = (char *) self + offsetof(scalar_t, m_short_string);
+        self->m_flags = SCALAR_FLAG_SHORT | (length << SCALAR_SHORT_LENGTH_SHIFT) | SCALAR_STRING;
+        if (length > 0)  memcpy(short_string, bytes, length);
+        short_string[length] = '\0';
+
+        int32_t ival;
+        if (length > 0 && length <= SCALAR_SHORT_INT_LENGTH_MAX
+            && _anon_scalar_parse_short_int(short_string, length, &ival)) {
+            memcpy((char *) self + SCALAR_SHORT_INT_OFFSET, &ival, sizeof(ival));
+            self->m_flags |= SCALAR_FLAG_SHORT_INT;
+        }
+    }
+    else {
+        _anon_scalar_set_string(self, string_alloc(length, bytes));
+    }
+}
+
+static inline int _anon_scalar_set_string_view(scalar_t *self, string_t *parent, size_t offset, size_t length) {
+    if (length > SCALAR_VIEW_LENGTH_MAX || offset > UINT32_MAX)  return -1;
+
+    self->m_flags = SCALAR_FLAG_PTR | SCALAR_FLAG_VIEW | (length << SCALAR_VIEW_LENGTH_SHIFT) | SCALAR_STRING;
+    self->m_view_offset = offset;
+    self->m_value.as_string = string_dup(parent);
+    return 0;
+}
+#endif
+
+/*
+=item _anon_scalar_get_string_cstr()
+
+Returns the bytes of a string scalar with a terminating NUL, for passing to functions that need one.  Views are copied
+into buffer if they fit, and into a new string_t passed back in *tmp otherwise, which the caller must free.
+
 =cut
 */
+static const char *_anon_scalar_get_string_cstr(const scalar_t *self, char *buffer, size_t size, string_t **tmp) {
+    size_t length;
+    const char *bytes = _anon_scalar_get_string_bytes(self, &length);
+
+    if (0 == (_anon_scalar_flags(self) & SCALAR_FLAG_VIEW))  return bytes;
+
+    if (length < size) {
+        memcpy(buffer, bytes, length);
+        buffer[length] = '\0';
+        return buffer;
+    }
+    else {
+        *tmp = string_alloc(length, bytes);
+        return string_cstr(*tmp);
+    }
+}
+
+/*
+=item _anon_scalar_append_to_rope()
+
+Appends the string value of a scalar to a rope.  Allocated strings and views are shared with the rope, ropes have their
+pieces shared, and anything else is copied.
+
+=cut
+*/
+static int _anon_scalar_append_to_rope(rope_t **restrict rope, const scalar_t *restrict value) {
+    const uint32_t flags = _anon_scalar_flags(value);
+
+    if (flags & SCALAR_FLAG_ROPE)  return rope_append_rope(rope, _anon_scalar_get_rope(value));
+
+    char buffer[SCALAR_FORMAT_BUFFER_SIZE];
+    size_t length;
+    const char *bytes = anon_scalar_format(value, buffer, &length);
+
+    if ((flags & SCALAR_FLAG_PTR) && anon_scalar_type(value) == SCALAR_STRING) {
+        const string_t *str = _anon_scalar_get_string(value);
+        return rope_append_string(rope, str, bytes - string_cstr(str), length);
+    }
+    return rope_append_bytes(rope, length, bytes);
+}
 
 
 /*
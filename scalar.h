@@ -12,10 +12,12 @@
 #define SCALAR_H
 
 #include <pthread.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 
 #include "floatptr_t.h"
+#include "rope.h"
 #include "string.h"
 #include "vmtypes.h"
 
@@ -27,6 +29,9 @@
 
 #define SCALAR(handle)      POOL_OBJECT(scalar_t, handle)
 
+/* big enough for anon_scalar_format() to format any non-string value into */
+#define SCALAR_FORMAT_BUFFER_SIZE   (64)
+
 #define SCALAR_UNDEF            0x00000000u
 #define SCALAR_INT              0x01u
 #define SCALAR_FLOAT            0x02u
@@ -45,21 +50,91 @@
 #define SCALAR_FLAG_REF         0x00000010u     /* pseudo flag, actually part of the type mask */
 // ...
 #define SCALAR_FLAG_PTR         0x08000000u
+#define SCALAR_FLAG_SHORT       0x04000000u
+#define SCALAR_FLAG_VIEW        0x02000000u
+#define SCALAR_FLAG_ROPE        0x01000000u
+#define SCALAR_FLAG_SHORT_INT   0x00000020u
+
+#define SCALAR_SHORT_LENGTH_MASK    0x00000F00u
+#define SCALAR_SHORT_LENGTH_SHIFT   (8)
+#define SCALAR_VIEW_LENGTH_MASK     0x00FFFF00u
+#define SCALAR_VIEW_LENGTH_SHIFT    (8)
 
-#define SCALAR_ALL_FLAGS        0x0800001Fu     /* keep this up to date */
+#define SCALAR_ALL_FLAGS        0x0FFFFF3Fu     /* keep this up to date */
 /*
- 0000 1000  0000 0000  0000 0000  0001 1111
-      |                              | ''''-- basic types
-      |                              '------- value is a reference
+ 0000 1111  1111 1111  1111 1111  0011 1111
+      ||||  '''''''''''''''''''     || ''''-- basic types
+      ||||           |              |'------- value is a reference
+      ||||           |              '-------- short string is an integer, also stored in its last bytes, see below
+      ||||           '----------------------- length of a string view, or of a short string (low 4 bits only)
+      |||'----------------------------------- string is a rope, see below
+      ||'------------------------------------ string is a view on part of another string, see below
+      |'------------------------------------- string is stored inline in the scalar, see below
       '-------------------------------------- value is a malloc'd pointer, make sure to free it
  */
 
+#ifdef SCALAR_NANBOX
+/*
+ With SCALAR_NANBOX, a scalar is a single 64-bit word.  The top 16 bits are a tag, and the low 48 bits the payload:
+
+   0x0000               undef (all bits zero)
+   0x0001               int, as a 48-bit two's complement payload
+   0x0003               string, payload is the string_t pointer
+   0x0004               int that doesn't fit in 48 bits, payload is a pointer to a malloc'd intptr_t
+   0x0005               string, payload is a rope_t pointer
+   0x0009 - 0x000E      reference, tag is the SCALAR_*REF type with 0x08 in place of SCALAR_FLAG_REF, payload is the handle
+   0x000F - 0xFFFF      float, stored as its IEEE 754 bits (with NaNs made canonical) plus SCALAR_NANBOX_FLOAT_OFFSET
+
+ This relies on pointers and handles fitting in 48 bits, and on floatptr_t being a 64-bit double.
+ */
+#define SCALAR_NANBOX_TAG_SHIFT         (48)
+#define SCALAR_NANBOX_PAYLOAD_MASK      ((UINT64_C(1) << SCALAR_NANBOX_TAG_SHIFT) - 1)
+#define SCALAR_NANBOX_TAG_INT           (UINT64_C(0x0001))
+#define SCALAR_NANBOX_TAG_STRING        (UINT64_C(0x0003))
+#define SCALAR_NANBOX_TAG_BIG_INT       (UINT64_C(0x0004))
+#define SCALAR_NANBOX_TAG_ROPE          (UINT64_C(0x0005))
+#define SCALAR_NANBOX_TAG_REF           (UINT64_C(0x0008))
+#define SCALAR_NANBOX_TAG_FLOAT_MIN     (UINT64_C(0x000F))
+#define SCALAR_NANBOX_FLOAT_OFFSET      (SCALAR_NANBOX_TAG_FLOAT_MIN << SCALAR_NANBOX_TAG_SHIFT)
+#define SCALAR_NANBOX_INT_MIN           (-((intptr_t) 1 << (SCALAR_NANBOX_TAG_SHIFT - 1)))
+#define SCALAR_NANBOX_INT_MAX           (((intptr_t) 1 << (SCALAR_NANBOX_TAG_SHIFT - 1)) - 1)
+
+typedef struct scalar_t {
+    uint64_t m_bits;
+} scalar_t;
+
+#define SCALAR_SHORT_STRING_MAX     (0)     /* no room for inline strings */
+#define SCALAR_VIEW_LENGTH_MAX      (0)     /* or for string views */
+#else
+/*
+ A string short enough to fit (with its terminating NUL) in the bytes from m_short_string to the end of the scalar is
+ stored there directly, rather than in a separately allocated string_t.  Such a scalar has the SCALAR_FLAG_SHORT flag
+ instead of SCALAR_FLAG_PTR, and its length in the SCALAR_SHORT_LENGTH_MASK bits of m_flags.  m_short_string occupies
+ what would otherwise be padding, and the rest of the string continues on into m_value.
+
+ A short string of up to SCALAR_SHORT_INT_LENGTH_MAX characters leaves the last 32 bits of the scalar unused.  If it's a
+ plain decimal integer, it also has SCALAR_FLAG_SHORT_INT, and its value as an int32_t at SCALAR_SHORT_INT_OFFSET, so
+ that using it as a number doesn't parse it again.
+
+ A string view is a substring of an allocated string_t that shares the original's bytes rather than copying them.  It has
+ both SCALAR_FLAG_PTR and SCALAR_FLAG_VIEW, holds a reference to the whole string in m_value, and has its offset into
+ it in m_view_offset and its length in the SCALAR_VIEW_LENGTH_MASK bits of m_flags.  Unlike other strings, the bytes of
+ a view aren't followed by a terminating NUL.
+
+ A long string built by concatenation is a rope (see rope.h), which holds its pieces without copying them into one
+ string.  It has SCALAR_FLAG_ROPE rather than SCALAR_FLAG_PTR, and the rope_t in m_value.
+ */
 typedef struct scalar_t {
     uint32_t m_flags;
+    union {
+        char m_short_string[4];
+        uint32_t m_view_offset;
+    };
     union {
         intptr_t as_int;
         floatptr_t as_float;
         string_t *as_string;
+        rope_t *as_rope;
         scalar_handle_t as_scalar_handle;
         array_handle_t as_array_handle;
         hash_handle_t as_hash_handle;
@@ -69,10 +144,92 @@ typedef struct scalar_t {
     } m_value;
 } scalar_t;
 
+#define SCALAR_SHORT_STRING_MAX     (sizeof(scalar_t) - offsetof(scalar_t, m_short_string) - 1)
+#define SCALAR_SHORT_INT_OFFSET     (sizeof(scalar_t) - sizeof(int32_t))
+#define SCALAR_SHORT_INT_LENGTH_MAX (SCALAR_SHORT_INT_OFFSET - offsetof(scalar_t, m_short_string) - 1)
+#define SCALAR_VIEW_LENGTH_MAX      (SCALAR_VIEW_LENGTH_MASK >> SCALAR_VIEW_LENGTH_SHIFT)
+#endif
+
 int anon_scalar_init(scalar_t *);
 int anon_scalar_destroy(scalar_t *);
 
-POOL_HEADER_CONTENTS(scalar_t, scalar_handle_t, PTHREAD_MUTEX_RECURSIVE, anon_scalar_init, anon_scalar_destroy);
+/* shared scalars lock through their wrapper's pool_lock_t, which is recursive like SRLOCK needs */
+POOL_HEADER_CONTENTS(scalar_t, scalar_handle_t, PTHREAD_MUTEX_RECURSIVE, POOL_LOCK_INLINE, anon_scalar_init, anon_scalar_destroy);
+
+/*
+=head2 Anonymous Scalar Functions
+
+=over
+
+=item anon_scalar_type()
+
+Returns the type of an anonymous scalar, as one of the SCALAR_* basic types.
+
+=item anon_scalar_is_int()
+
+=item anon_scalar_int()
+
+=item anon_scalar_put_int()
+
+Fast paths for integer scalars, whichever representation is in use.  C<anon_scalar_is_int()> returns non-zero if the
+scalar holds an integer that C<anon_scalar_int()> can read directly.  C<anon_scalar_put_int()> sets an integer value on
+a scalar that holds no resources to clean up: one that's undefined, or for which C<anon_scalar_is_int()> is true.
+
+=cut
+*/
+#ifdef SCALAR_NANBOX
+static inline uint32_t anon_scalar_type(const scalar_t *self) {
+    const uint64_t tag = self->m_bits >> SCALAR_NANBOX_TAG_SHIFT;
+
+    if (tag >= SCALAR_NANBOX_TAG_FLOAT_MIN)  return SCALAR_FLOAT;
+    if (tag & SCALAR_NANBOX_TAG_REF)  return SCALAR_FLAG_REF | (tag & ~SCALAR_NANBOX_TAG_REF);
+    if (tag == SCALAR_NANBOX_TAG_BIG_INT)  return SCALAR_INT;
+    return (tag == SCALAR_NANBOX_TAG_ROPE ? SCALAR_STRING : (uint32_t) tag);
+}
+
+static inline int anon_scalar_is_int(const scalar_t *self) {
+    return (self->m_bits >> SCALAR_NANBOX_TAG_SHIFT) == SCALAR_NANBOX_TAG_INT;
+}
+
+static inline intptr_t anon_scalar_int(const scalar_t *self) {
+    // n.b. relies on right shifts of negative values being arithmetic, which they are everywhere that matters
+    return (intptr_t) (self->m_bits << (64 - SCALAR_NANBOX_TAG_SHIFT)) >> (64 - SCALAR_NANBOX_TAG_SHIFT);
+}
+
+void anon_scalar_set_int_value(scalar_t *, intptr_t);
+
+static inline void anon_scalar_put_int(scalar_t *self, intptr_t ival) {
+    if (ival >= SCALAR_NANBOX_INT_MIN && ival <= SCALAR_NANBOX_INT_MAX) {
+        self->m_bits = (SCALAR_NANBOX_TAG_INT << SCALAR_NANBOX_TAG_SHIFT) | ((uint64_t) ival & SCALAR_NANBOX_PAYLOAD_MASK);
+    }
+    else {
+        anon_scalar_set_int_value(self, ival);
+    }
+}
+#else
+static inline uint32_t anon_scalar_type(const scalar_t *self) {
+    return self->m_flags & SCALAR_TYPE_MASK;
+}
+
+static inline int anon_scalar_is_int(const scalar_t *self) {
+    return self->m_flags == SCALAR_INT;
+}
+
+static inline intptr_t anon_scalar_int(const scalar_t *self) {
+    return self->m_value.as_int;
+}
+
+static inline void anon_scalar_put_int(scalar_t *self, intptr_t ival) {
+    self->m_flags = SCALAR_INT;
+    self->m_value.as_int = ival;
+}
+#endif
+
+/*
+=back
+
+=cut
+*/
 
 int anon_scalar_clone(scalar_t * restrict, const scalar_t * restrict);
 int anon_scalar_assign(scalar_t * restrict, const scalar_t * restrict);
@@ -80,12 +237,24 @@ int anon_scalar_assign(scalar_t * restrict, const scalar_t * restrict);
 void anon_scalar_set_int_value(scalar_t *, intptr_t);
 void anon_scalar_set_float_value(scalar_t *, floatptr_t);
 void anon_scalar_set_string_value(scalar_t *, const string_t *);
+void anon_scalar_set_string_bytes(scalar_t *, size_t, const char *);
+
+void anon_scalar_append_bytes(scalar_t *, size_t, const char *);
+void anon_scalar_append_value(scalar_t * restrict, const scalar_t * restrict);
+void anon_scalar_concatenate(scalar_t * restrict, size_t, scalar_t * restrict);
+
+void anon_scalar_set_substring(scalar_t *, const scalar_t *, size_t, size_t);
+void anon_scalar_compact(scalar_t *);
 
 intptr_t anon_scalar_is_defined(const scalar_t *);
 intptr_t anon_scalar_get_bool_value(const scalar_t *);
 intptr_t anon_scalar_get_int_value(const scalar_t *);
 floatptr_t anon_scalar_get_float_value(const scalar_t *);
 void anon_scalar_get_string_value(const scalar_t *, string_t **);
+const char *anon_scalar_get_string_bytes(const scalar_t *, size_t *);
+size_t anon_scalar_get_string_length(const scalar_t *);
+const rope_t *anon_scalar_get_rope(const scalar_t *);
+const char *anon_scalar_format(const scalar_t *, char *, size_t *);
 
 void anon_scalar_set_scalar_reference(scalar_t *, scalar_handle_t);
 void anon_scalar_set_array_reference(scalar_t *, array_handle_t);
@@ -112,6 +281,8 @@ stream_handle_t anon_scalar_deref_stream_reference(const scalar_t *);
 
 int scalar_pool_init(void);
 int scalar_pool_destroy(void);
+int scalar_pool_flush(void);
+int scalar_pool_stats(pool_magazine_stats_t *);
 
 scalar_handle_t scalar_allocate(uint32_t);
 scalar_handle_t scalar_allocate_many(size_t, uint32_t);
@@ -148,6 +319,9 @@ static inline int scalar_unlock(scalar_handle_t handle) {
 
 Functions for setting values on a pooled scalar.  Any previous value is properly cleaned up.
 
+Pooled scalars can live a long time, so C<scalar_set_value()> doesn't let a small string view keep a much larger
+string alive (see C<anon_scalar_compact()>).
+
 =cut
  */
 static inline void scalar_set_undef(scalar_handle_t handle) {
@@ -198,6 +372,25 @@ static inline void scalar_set_value(scalar_handle_t handle, const scalar_t *val)
     
     if (0 == scalar_lock(handle)) {
         anon_scalar_clone(&SCALAR(handle), val);
+        anon_scalar_compact(&SCALAR(handle));
+        scalar_unlock(handle);
+    }
+}
+
+/*
+=item scalar_append_value()
+
+Appends the string value of val to a pooled scalar in place.  See C<anon_scalar_append_value()>.
+
+=cut
+ */
+static inline void scalar_append_value(scalar_handle_t handle, const scalar_t *val) {
+    assert(POOL_HANDLE_VALID(scalar_t, handle));
+    assert(POOL_HANDLE_IN_USE(scalar_t, handle));
+    assert(val != NULL);
+    
+    if (0 == scalar_lock(handle)) {
+        anon_scalar_append_value(&SCALAR(handle), val);
         scalar_unlock(handle);
     }
 }
@@ -309,7 +502,10 @@ static inline intptr_t scalar_is_defined(scalar_handle_t handle) {
 
 =item scalar_get_value()
 
-Functions for getting values from a pooled scalar.
+=item scalar_take_value()
+
+Functions for getting values from a pooled scalar.  C<scalar_take_value()> moves the value out rather than copying it,
+and leaves the pooled scalar undefined.
 
 =cut
  */
@@ -364,7 +560,7 @@ static inline void scalar_get_value(scalar_handle_t handle, scalar_t *result) {
     assert(POOL_HANDLE_IN_USE(scalar_t, handle));
     assert(result != NULL);
     
-    if ((result->m_flags & SCALAR_TYPE_MASK) != SCALAR_UNDEF)  anon_scalar_destroy(result);
+    if (anon_scalar_type(result) != SCALAR_UNDEF)  anon_scalar_destroy(result);
     
     if (0 == scalar_lock(handle)) {
         anon_scalar_clone(result, &SCALAR(handle));
@@ -372,6 +568,20 @@ static inline void scalar_get_value(scalar_handle_t handle, scalar_t *result) {
     }
 }
 
+static inline void scalar_take_value(scalar_handle_t handle, scalar_t *result) {
+    assert(POOL_HANDLE_VALID(scalar_t, handle));
+    assert(POOL_HANDLE_IN_USE(scalar_t, handle));
+    assert(result != NULL);
+    
+    if (anon_scalar_type(result) != SCALAR_UNDEF)  anon_scalar_destroy(result);
+    
+    if (0 == scalar_lock(handle)) {
+        anon_scalar_assign(result, &SCALAR(handle));
+        anon_scalar_init(&SCALAR(handle));
+        scalar_unlock(handle);
+    }
+}
+
 /*
 =item scalar_deref_scalar_reference()
 
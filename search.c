@@ -0,0 +1,130 @@
+/*
+ *  search.c
+ *  dang
+ *
+=head1 NAME
+
+search
+
+=head1 INTRODUCTION
+
+Searching runs of bytes for substrings and for bytes belonging to a class, for the string instructions in bytecode.c.
+
+Single bytes and substrings are found with memchr() and memmem(), which the C library already vectorises far better
+than portable code could.  A class of bytes is held as a 256-bit set.  Small classes, which covers most delimiter sets
+("," or ",\n" or " \t\n" and so on), are scanned eight bytes at a time: each word is compared against every byte in the
+class at once, with the usual trick for finding a zero byte in a word, and only a word that contains a match is
+examined byte by byte.  Larger classes are scanned a byte at a time against the set.
+
+=head1 PUBLIC INTERFACE
+
+=over
+
+=cut
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "search.h"
+
+#define SEARCH_WORD_ONES    UINT64_C(0x0101010101010101)
+#define SEARCH_WORD_HIGHS   UINT64_C(0x8080808080808080)
+
+/* non-zero if any byte of x is zero */
+#define SEARCH_WORD_HAS_ZERO(x)     (((x) - SEARCH_WORD_ONES) & ~(x) & SEARCH_WORD_HIGHS)
+
+/*
+=item search_bytes()
+
+Returns a pointer to the first occurrence of needle within haystack, or NULL if there isn't one.  An empty needle is
+found at the start of the haystack.
+
+=cut
+ */
+const char *search_bytes(const char *haystack, size_t haystack_length, const char *needle, size_t needle_length) {
+    assert(haystack != NULL || haystack_length == 0);
+    assert(needle != NULL || needle_length == 0);
+
+    if (needle_length == 0)  return haystack;
+    if (needle_length > haystack_length)  return NULL;
+    if (needle_length == 1)  return memchr(haystack, (unsigned char) needle[0], haystack_length);
+
+    return memmem(haystack, haystack_length, needle, needle_length);
+}
+
+/*
+=item search_class_init()
+
+Initialises a class containing each of the bytes given.  Repeated bytes are only counted once.
+
+=cut
+ */
+void search_class_init(search_class_t *self, const char *bytes, size_t length) {
+    assert(self != NULL);
+    assert(bytes != NULL || length == 0);
+
+    memset(self, 0, sizeof(*self));
+
+    for (size_t i = 0; i < length; i++) {
+        const unsigned char c = bytes[i];
+        if (search_class_contains(self, c))  continue;
+
+        self->m_bits[c >> 6] |= UINT64_C(1) << (c & 63);
+        if (self->m_count < SEARCH_CLASS_WORD_MAX)  self->m_words[self->m_count] = SEARCH_WORD_ONES * c;
+        ++self->m_count;
+    }
+}
+
+/*
+=item search_class_first()
+
+=item search_class_first_not()
+
+Return a pointer to the first byte within the given bytes that is (or isn't) in the class, or NULL if there isn't one.
+
+=cut
+ */
+const char *search_class_first(const search_class_t *self, const char *bytes, size_t length) {
+    assert(self != NULL);
+    assert(bytes != NULL || length == 0);
+
+    const char *p = bytes, *end = bytes + length;
+
+    if (self->m_count == 0)  return NULL;
+    if (self->m_count == 1)  return memchr(bytes, (unsigned char) (self->m_words[0] & 0xFF), length);
+
+    if (self->m_count <= SEARCH_CLASS_WORD_MAX) {
+        for (; end - p >= (ptrdiff_t) sizeof(uint64_t); p += sizeof(uint64_t)) {
+            uint64_t word, found = 0;
+            memcpy(&word, p, sizeof(word));
+            for (size_t i = 0; i < self->m_count; i++) {
+                found |= SEARCH_WORD_HAS_ZERO(word ^ self->m_words[i]);
+            }
+            if (found)  break;
+        }
+    }
+
+    for (; p < end; ++p) {
+        if (search_class_contains(self, *p))  return p;
+    }
+    return NULL;
+}
+
+const char *search_class_first_not(const search_class_t *self, const char *bytes, size_t length) {
+    assert(self != NULL);
+    assert(bytes != NULL || length == 0);
+
+    const char *p = bytes, *end = bytes + length;
+
+    for (; p < end; ++p) {
+        if (! search_class_contains(self, *p))  return p;
+    }
+    return NULL;
+}
+
+/*
+=back
+
+=cut
+ */
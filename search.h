@@ -0,0 +1,35 @@
+/*
+ *  search.h
+ *  dang
+ *
+ */
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* classes with up to this many bytes are scanned a word at a time (see search.c) */
+#define SEARCH_CLASS_WORD_MAX   (4)
+
+typedef struct search_class_t {
+    uint64_t m_bits[4];
+    uint64_t m_words[SEARCH_CLASS_WORD_MAX];
+    size_t m_count;
+} search_class_t;
+
+#define SEARCH_WHITESPACE       " \t\n\v\f\r"
+
+const char *search_bytes(const char *, size_t, const char *, size_t);
+
+void search_class_init(search_class_t *, const char *, size_t);
+
+const char *search_class_first(const search_class_t *, const char *, size_t);
+const char *search_class_first_not(const search_class_t *, const char *, size_t);
+
+static inline int search_class_contains(const search_class_t *self, unsigned char c) {
+    return (self->m_bits[c >> 6] >> (c & 63)) & 1;
+}
+
+#endif
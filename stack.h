@@ -43,6 +43,11 @@
 #define STACK_NPUSH(type, stack, count, values) type##_STACK_PUSH(stack, count, values)
 #define STACK_NPOP(type, stack, count, results) type##_STACK_POP(stack, count, results)
 #define STACK_TOP(type, stack, result)          type##_STACK_TOP(stack, result)
+#define STACK_GIVE(type, stack, value)          type##_STACK_GIVE(stack, 1, value)
+#define STACK_TAKE(type, stack, result)         type##_STACK_TAKE(stack, 1, result)
+#define STACK_NGIVE(type, stack, count, values) type##_STACK_GIVE(stack, count, values)
+#define STACK_NTAKE(type, stack, count, results) type##_STACK_TAKE(stack, count, results)
+#define STACK_PEEK(type, stack, n)              type##_STACK_PEEK(stack, n)
 #define STACK_SWAP(type, stack)                 type##_STACK_SWAP(stack)
 #define STACK_DUP(type, stack)                  type##_STACK_DUP(stack)
 #define STACK_OVER(type, stack)                 type##_STACK_OVER(stack)
@@ -68,6 +73,12 @@
  
  You must call this macro exactly once in a source file for each type of stack required, 
  in order to then be able to use these stack functions.
+
+ The GIVE and TAKE functions move objects onto and off the stack rather than copying them:
+ a given object is left zeroed, and a taken object's slot is left zeroed, so an object of
+ type "type" must be safe to destroy (and to copy over) when it is all bits zero, as it
+ already must be for the calloc'd items of a new stack.  PEEK returns a pointer to the nth
+ item from the top, which is only valid until the stack is next modified.
  */
 #define STACK_DEFINITIONS(type, init_func, dest_func, copy_func)                        \
 static inline int type##_STACK_INIT(struct type##_STACK *stack) {                       \
@@ -151,6 +162,49 @@ static inline int type##_STACK_POP( struct type##_STACK *stack, size_t count,
     return status;                                                                      \
 }                                                                                       \
                                                                                         \
+static inline int type##_STACK_GIVE(    struct type##_STACK *stack, size_t count,       \
+                                        type *values) {                                 \
+    assert(stack != NULL);                                                              \
+    assert(count > 0);                                                                  \
+    assert(values != NULL);                                                             \
+                                                                                        \
+    if (0 == type##_STACK_RESERVE(stack, stack->m_count + count)) {                     \
+        for (size_t i = count; i > 0; i--) {                                            \
+            memcpy(&stack->m_items[stack->m_count++], &values[i-1], sizeof(type));      \
+            memset(&values[i-1], 0, sizeof(type));                                      \
+        }                                                                               \
+        return 0;                                                                       \
+    }                                                                                   \
+    else {                                                                              \
+        return -1;                                                                      \
+    }                                                                                   \
+}                                                                                       \
+                                                                                        \
+static inline int type##_STACK_TAKE(    struct type##_STACK *stack, size_t count,       \
+                                        type *results) {                                \
+    assert(stack != NULL);                                                              \
+    assert(count > 0);                                                                  \
+    assert(stack->m_count >= count);                                                    \
+    assert(results != NULL);                                                            \
+                                                                                        \
+    int status = 0;                                                                     \
+    for (size_t i = 0; i < count; i++) {                                                \
+        status = dest_func(&results[i]);                                                \
+        --stack->m_count;                                                               \
+        memcpy(&results[i], &stack->m_items[stack->m_count], sizeof(type));             \
+        memset(&stack->m_items[stack->m_count], 0, sizeof(type));                       \
+    }                                                                                   \
+                                                                                        \
+    return status;                                                                      \
+}                                                                                       \
+                                                                                        \
+static inline type *type##_STACK_PEEK(struct type##_STACK *stack, size_t n) {           \
+    assert(stack != NULL);                                                              \
+    assert(stack->m_count > n);                                                         \
+                                                                                        \
+    return &stack->m_items[stack->m_count - 1 - n];                                     \
+}                                                                                       \
+                                                                                        \
 static inline int type##_STACK_TOP(struct type##_STACK *stack, type *result) {          \
     assert(stack != NULL);                                                              \
     assert(stack->m_count > 0);                                                         \
@@ -176,6 +230,8 @@ static inline int type##_STACK_DUP(struct type##_STACK *stack) {
     assert(stack != NULL);                                                              \
     assert(stack->m_count > 0);                                                         \
                                                                                         \
+    /* reserve first, so the item being copied can't move during the push */           \
+    if (0 != type##_STACK_RESERVE(stack, stack->m_count + 1))  return -1;               \
     return STACK_PUSH(type, stack, &stack->m_items[stack->m_count - 1]);                \
 }                                                                                       \
                                                                                         \
@@ -183,6 +239,7 @@ static inline int type##_STACK_OVER(struct type##_STACK *stack) {
     assert(stack != NULL);                                                              \
     assert(stack->m_count > 1);                                                         \
                                                                                         \
+    if (0 != type##_STACK_RESERVE(stack, stack->m_count + 1))  return -1;               \
     return STACK_PUSH(type, stack, &stack->m_items[stack->m_count - 2]);                \
 }
 
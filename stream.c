@@ -22,11 +22,13 @@ stream
 
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/wait.h>
 
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <netdb.h>
 #include <stdlib.h>
 #include <string.h>
@@ -37,6 +39,13 @@ stream
 
 #define STREAM(handle)  POOL_OBJECT(stream_t, handle)
 
+/* how many pieces of a rope to pass to each writev() */
+#if defined(IOV_MAX) && IOV_MAX < 64
+#define STREAM_IOV_COUNT    (IOV_MAX)
+#else
+#define STREAM_IOV_COUNT    (64)
+#endif
+
 POOL_SOURCE_CONTENTS(stream_t);
 
 int _stream_open_file(stream_t *restrict, flags32_t, const string_t *restrict);
@@ -46,6 +55,7 @@ void _stream_close(stream_t *);
 int _stream_bind(stream_t *, flags32_t, int);
 int _stream_unbind(stream_t *, int);
 int _stream_parse_socket_dest(const string_t *restrict, string_t **restrict, string_t **restrict);
+int _stream_writev(FILE *, const rope_t *);
 
 
 static stream_handle_t _stream_stdin_handle = 0;
@@ -57,7 +67,13 @@ static stream_handle_t _stream_stderr_handle = 0;
 
 =item stream_pool_destroy()
 
-Setup and tear down functions for the stream pool
+=item stream_pool_flush()
+
+=item stream_pool_stats()
+
+Setup and tear down functions for the stream pool.  stream_pool_flush() gives the calling thread's cached free streams
+back to the pool, and must be called by each thread before it finishes.  stream_pool_stats() fills in stats with the
+pool's allocation counts, as POOL_MAGAZINE_STATS() does.
 
 =cut
  */
@@ -84,6 +100,14 @@ int stream_pool_destroy(void) {
     return POOL_DESTROY(stream_t);
 }
 
+int stream_pool_flush(void) {
+    return POOL_FLUSH(stream_t);
+}
+
+int stream_pool_stats(pool_magazine_stats_t *stats) {
+    return POOL_MAGAZINE_STATS(stream_t, stats);
+}
+
 /*
 =item stream_allocate()
 
@@ -273,18 +297,50 @@ string_t *stream_read(stream_handle_t handle, size_t bytes) {
 /*
 =item stream_write()
 
-Writes a string to the stream.
+=item stream_write_bytes()
+
+Writes a string, or length bytes, to the stream.
 
 =cut
  */
 int stream_write(stream_handle_t handle, const string_t *string) {
+    return stream_write_bytes(handle, string_cstr(string), string_length(string));
+}
+
+int stream_write_bytes(stream_handle_t handle, const char *bytes, size_t length) {
     assert(POOL_HANDLE_VALID(stream_t, handle));
     
     int status;
     if (0 == POOL_LOCK(stream_t, handle)) {
         assert(POOL_HANDLE_IN_USE(stream_t, handle));
         assert(STREAM(handle).m_flags & (STREAM_FLAG_WRITE | STREAM_FLAG_APPEND));
-        status = fwrite(string_cstr(string), string_length(string), 1, STREAM(handle).m_file);
+        status = fwrite(bytes, length, 1, STREAM(handle).m_file);
+        POOL_UNLOCK(stream_t, handle);
+    }
+    else {
+        status = -1;
+    }
+
+    return status;
+}
+
+/*
+=item stream_write_rope()
+
+Writes a rope to the stream, straight from its pieces with C<writev()>, rather than flattening it first.  Anything
+already buffered for the stream is flushed first, so the output stays in order.
+
+=cut
+ */
+int stream_write_rope(stream_handle_t handle, const rope_t *rope) {
+    assert(POOL_HANDLE_VALID(stream_t, handle));
+    assert(rope != NULL);
+    
+    int status;
+    if (0 == POOL_LOCK(stream_t, handle)) {
+        assert(POOL_HANDLE_IN_USE(stream_t, handle));
+        assert(STREAM(handle).m_flags & (STREAM_FLAG_WRITE | STREAM_FLAG_APPEND));
+        status = _stream_writev(STREAM(handle).m_file, rope);
         POOL_UNLOCK(stream_t, handle);
     }
     else {
@@ -705,6 +761,46 @@ int _stream_parse_socket_dest(const string_t *restrict dest, string_t **restrict
     return 0;
 }
 
+/*
+=item _stream_writev()
+
+Writes all of a rope's pieces to the file descriptor underlying file, STREAM_IOV_COUNT at a time, carrying on after
+short writes and interruptions.  Returns 1 if everything was written and 0 if not, like C<fwrite()> of a single item.
+
+=cut
+*/
+int _stream_writev(FILE *file, const rope_t *rope) {
+    if (0 != fflush(file))  return 0;
+    
+    const int fd = fileno(file);
+    const size_t count = rope_piece_count(rope);
+    struct iovec iov[STREAM_IOV_COUNT];
+    
+    for (size_t i = 0; i < count; ) {
+        int n = 0;
+        for (; n < STREAM_IOV_COUNT && i < count; n++, i++) {
+            iov[n].iov_base = (void *) rope_piece(rope, i, &iov[n].iov_len);
+        }
+        
+        struct iovec *v = iov;
+        while (n > 0) {
+            ssize_t written = writev(fd, v, n);
+            if (written < 0) {
+                if (errno == EINTR)  continue;
+                debug("writev returned %i\n", errno);
+                return 0;
+            }
+            for (; n > 0 && (size_t) written >= v->iov_len; ++v, --n)  written -= v->iov_len;
+            if (n > 0) {
+                v->iov_base = (char *) v->iov_base + written;
+                v->iov_len -= written;
+            }
+        }
+    }
+    
+    return 1;
+}
+
 /*
 =back
 
@@ -13,6 +13,7 @@
 #include <sys/socket.h>
 #include <stdio.h>
 
+#include "rope.h"
 #include "string.h"
 #include "vmtypes.h"
 
@@ -59,10 +60,12 @@ typedef struct stream_t {
 int _stream_init(stream_t *);
 int _stream_destroy(stream_t *);
 
-POOL_HEADER_CONTENTS(stream_t, stream_handle_t, PTHREAD_MUTEX_ERRORCHECK, _stream_init, _stream_destroy);
+POOL_HEADER_CONTENTS(stream_t, stream_handle_t, PTHREAD_MUTEX_ERRORCHECK, POOL_LOCK_MUTEX, _stream_init, _stream_destroy);
 
 int stream_pool_init(void);
 int stream_pool_destroy(void);
+int stream_pool_flush(void);
+int stream_pool_stats(pool_magazine_stats_t *);
 
 stream_handle_t stream_allocate(void);
 stream_handle_t stream_allocate_many(size_t);
@@ -79,6 +82,8 @@ int stream_close(stream_handle_t);
 string_t *stream_read_delim(stream_handle_t, int);
 string_t *stream_read(stream_handle_t, size_t);
 int stream_write(stream_handle_t, const string_t *);
+int stream_write_bytes(stream_handle_t, const char *, size_t);
+int stream_write_rope(stream_handle_t, const rope_t *);
 
 const char *stream_get_filename(stream_handle_t);
 
@@ -12,27 +12,24 @@
 #include <string.h>
 
 #include "debug.h"
+#include "numeric.h"
 #include "string.h"
 
+static int _string_realloc(string_t **, size_t);
+
+/*
+ Makes sure there's room for at least new_size bytes, and that the caller holds the only reference
+ to the string, so it can be modified in place.  Either may mean replacing *self with a new copy.
+ */
 int string_reserve(string_t **self, size_t new_size) {
     assert(self != NULL && *self != NULL);
     
-    if (new_size > (*self)->m_allocated_size) {
-        new_size = nextupow2(new_size);
-        string_t *tmp = calloc(1, sizeof(*tmp) + new_size);
-        if (tmp) {
-            memcpy(tmp, *self, (*self)->m_length);
-            tmp->m_allocated_size = new_size;
-            tmp->m_length = (*self)->m_length;
-            free(*self);
-            *self = tmp;
-            return 0;
-        }
-        else {
-            return -1;
-        }
+    if (new_size > (*self)->m_allocated_size || string_is_shared(*self)) {
+        return _string_realloc(self, new_size);
     }
     else {
+        // the caller's about to change the contents, so whatever's cached won't be valid any more
+        atomic_store_explicit(&(*self)->m_cached, 0, memory_order_relaxed);
         return 0;
     }
 }
@@ -40,7 +37,7 @@ int string_reserve(string_t **self, size_t new_size) {
 int string_assign(string_t **restrict self, size_t len, const char *restrict str) {
     assert(self != NULL && *self != NULL);
     
-    if (len > (*self)->m_allocated_size)  string_reserve(self, len);
+    if (0 != string_reserve(self, len))  return -1;
     
     memcpy((*self)->m_bytes, str, len);
     memset(&(*self)->m_bytes[len], 0, (*self)->m_allocated_size - len);
@@ -52,10 +49,11 @@ int string_assign(string_t **restrict self, size_t len, const char *restrict str
 int string_append(string_t **restrict self, size_t len, const char *restrict str) {
     assert(self != NULL && *self != NULL);
     
-    if (len > (*self)->m_allocated_size)  string_reserve(self, (*self)->m_length + len);
+    if (0 != string_reserve(self, (*self)->m_length + len))  return -1;
     
     memcpy(&(*self)->m_bytes[(*self)->m_length], str, len);
     (*self)->m_length += len;
+    (*self)->m_bytes[(*self)->m_length] = '\0';
     
     return 0;
 }
@@ -66,6 +64,112 @@ int string_appendc(string_t **self, int c) {
     if (0 != string_reserve(self, (*self)->m_length + 1))  return -1;
     
     (*self)->m_bytes[(*self)->m_length++] = (char) c;
+    (*self)->m_bytes[(*self)->m_length] = '\0';
     
     return 0;
 }
+
+int string_chomp(string_t **self, int delimiter) {
+    assert(self != NULL && *self != NULL);
+
+    const string_t *str = *self;
+    if (str->m_length > 0) {
+        if (    str->m_bytes[str->m_length - 1] == delimiter || 
+                (delimiter == DELIMITER_WHITESPACE && isspace(str->m_bytes[str->m_length - 1]))) {
+            if (0 != string_reserve(self, str->m_length))  return -1;
+            (*self)->m_bytes[--(*self)->m_length] = '\0';
+        }
+    }
+
+    return 0;
+}
+
+/*
+ Return the numeric value of a string, as numeric_parse_int() or numeric_parse_float() would parse it.  The result is
+ cached in the string, so repeated conversions of the same string are cheap.  The string may be shared, but shared
+ strings are never modified, so the only thing that can race here is another thread caching the same value.
+ */
+intptr_t string_int_value(const string_t *self) {
+    assert(self != NULL);
+    string_t *cache = (string_t *) self;
+
+    if (atomic_load_explicit(&cache->m_cached, memory_order_acquire) & STRING_CACHED_INT) {
+        return atomic_load_explicit(&cache->m_int_value, memory_order_relaxed);
+    }
+
+    intptr_t value = numeric_parse_int(self->m_bytes);
+    atomic_store_explicit(&cache->m_int_value, value, memory_order_relaxed);
+    atomic_fetch_or_explicit(&cache->m_cached, STRING_CACHED_INT, memory_order_release);
+    return value;
+}
+
+floatptr_t string_float_value(const string_t *self) {
+    assert(self != NULL);
+    string_t *cache = (string_t *) self;
+
+    if (atomic_load_explicit(&cache->m_cached, memory_order_acquire) & STRING_CACHED_FLOAT) {
+        return atomic_load_explicit(&cache->m_float_value, memory_order_relaxed);
+    }
+
+    floatptr_t value = numeric_parse_float(self->m_bytes);
+    atomic_store_explicit(&cache->m_float_value, value, memory_order_relaxed);
+    atomic_fetch_or_explicit(&cache->m_cached, STRING_CACHED_FLOAT, memory_order_release);
+    return value;
+}
+
+/*
+ Hash length bytes, for hash_t lookups.  This is MurmurHash64A, which mixes in eight bytes at a time, folded down to
+ 32 bits.  Only consistency within a single run matters, so the result is allowed to depend on the byte order of the
+ machine.
+ */
+uint32_t string_hash_bytes(const char *bytes, size_t length) {
+    assert(bytes != NULL || length == 0);
+
+    const uint64_t m = UINT64_C(0xc6a4a7935bd1e995);
+    const int r = 47;
+    const char *end = bytes + (length & ~(size_t) 7);
+    uint64_t h = UINT64_C(0x8445d61a4e774912) ^ (length * m);
+
+    for (; bytes != end; bytes += sizeof(uint64_t)) {
+        uint64_t k;
+        memcpy(&k, bytes, sizeof(k));
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+
+    if (length & 7) {
+        uint64_t k = 0;
+        memcpy(&k, bytes, length & 7);
+        h ^= k;
+        h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return (uint32_t) (h ^ (h >> 32));
+}
+
+/*
+ Replaces *self with an unshared copy of itself, with room for at least new_size bytes.
+ */
+static int _string_realloc(string_t **self, size_t new_size) {
+    new_size = nextupow2(MAX(new_size, (*self)->m_length));
+    string_t *tmp = calloc(1, sizeof(*tmp) + new_size + 1);
+    if (tmp) {
+        atomic_init(&tmp->m_references, 1);
+        tmp->m_allocated_size = new_size;
+        tmp->m_length = (*self)->m_length;
+        memcpy(tmp->m_bytes, (*self)->m_bytes, (*self)->m_length);
+        string_free(*self);
+        *self = tmp;
+        return 0;
+    }
+    else {
+        debug("couldn't allocate string of %zu bytes\n", new_size);
+        return -1;
+    }
+}
@@ -11,12 +11,30 @@
 #define STRING_H
 
 #include <ctype.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "floatptr_t.h"
 #include "util.h"
 
+/*
+ Strings are reference counted and copy-on-write.  string_dup() shares the original rather than copying it, and
+ string_free() releases a share.  The functions below that modify a string take a string_t ** so that, if the string
+ is shared, they can replace it with a private copy first (see string_reserve()).  Anything else that writes to
+ m_bytes directly must only do so to a string it has just allocated.
+
+ A string also caches its numeric value the first time string_int_value() or string_float_value() is asked for it.
+ The cache is flushed by string_reserve(), which everything that modifies a string in place goes through.
+ */
+#define STRING_CACHED_INT       0x01u
+#define STRING_CACHED_FLOAT     0x02u
+
 typedef struct string_t {
+    atomic_size_t m_references;
+    atomic_uint m_cached;
+    atomic_intptr_t m_int_value;
+    _Atomic floatptr_t m_float_value;
     size_t m_allocated_size;
     size_t m_length;
     char m_bytes[];
@@ -24,8 +42,9 @@ typedef struct string_t {
 
 static inline string_t *string_alloc(size_t initial_length, const char *initial_value) {
     size_t size = nextupow2(initial_length);
-    string_t *self = calloc(1, sizeof(*self) + size);
+    string_t *self = calloc(1, sizeof(*self) + size + 1);  // n.b. always room for a terminating '\0'
     if (self) {
+        atomic_init(&self->m_references, 1);
         self->m_allocated_size = size;
         if (initial_value) {
             memcpy(self->m_bytes, initial_value, initial_length);
@@ -35,9 +54,19 @@ static inline string_t *string_alloc(size_t initial_length, const char *initial_
     return self;
 }
 
-static inline string_t *string_dup(const string_t *orig) { return string_alloc(orig->m_length, orig->m_bytes); }
+static inline string_t *string_dup(const string_t *orig) {
+    string_t *self = (string_t *) orig;
+    atomic_fetch_add_explicit(&self->m_references, 1, memory_order_relaxed);
+    return self;
+}
+
+static inline void string_free(string_t *self) {
+    if (self && 1 == atomic_fetch_sub_explicit(&self->m_references, 1, memory_order_acq_rel))  free(self);
+}
 
-static inline void string_free(string_t *self) { free(self); }
+static inline int string_is_shared(const string_t *self) {
+    return atomic_load_explicit(&((string_t *) self)->m_references, memory_order_acquire) > 1;
+}
 
 int string_reserve(string_t **, size_t);
 int string_assign(string_t **restrict, size_t, const char *restrict);
@@ -46,14 +75,12 @@ int string_append(string_t **restrict, size_t, const char *restrict);
 int string_appendc(string_t **, int);
 int string_prepend(string_t **restrict, size_t, const char *restrict);
 
-static inline void string_chomp(string_t *self, int delimiter) {
-    if (self->m_length > 0) {
-        if (    self->m_bytes[self->m_length - 1] == delimiter || 
-                (delimiter == DELIMITER_WHITESPACE && isspace(self->m_bytes[self->m_length - 1]))) {
-            self->m_bytes[--self->m_length] = '\0';
-        }
-    }
-}
+int string_chomp(string_t **, int);
+
+intptr_t string_int_value(const string_t *);
+floatptr_t string_float_value(const string_t *);
+
+uint32_t string_hash_bytes(const char *, size_t);
 
 static inline size_t string_length(const string_t *self) { return self->m_length; }
 static inline const char *string_cstr(const string_t *self) { return self->m_bytes; }
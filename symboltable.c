@@ -30,7 +30,17 @@ typedef struct symboltable_registry_node_t {
 static symboltable_registry_node_t *_symboltable_registry = NULL;
 static pthread_mutex_t _symboltable_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-int _symboltable_insert(symboltable_t *restrict, symbol_t *restrict);
+static atomic_uint_fast64_t _symboltable_serial = 0;
+
+const symbol_t *_symboltable_insert(symboltable_t *restrict, const symbol_t *restrict);
+void _symboltable_reap(symboltable_t *);
+static inline symbol_t *_symboltable_slot(const symboltable_t *, identifier_t);
+static inline const symbol_t *_symboltable_find(const symboltable_t *, identifier_t);
+static inline uint64_t _symboltable_shadow(identifier_t);
+void _symboltable_changed(symboltable_t *);
+void _symboltable_unreference(symboltable_t *);
+int _symbol_cache_get(symbol_cache_t *restrict, const symboltable_t *restrict, identifier_t, int, const symbol_t **);
+void _symbol_cache_set(symbol_cache_t *restrict, const symboltable_t *restrict, uint_fast64_t, const symbol_t *);
 int _symbol_init(symbol_t *);
 int _symbol_destroy(symbol_t *);
 int _symbol_reap(symbol_t *);
@@ -54,20 +64,42 @@ symboltable
 /*
 =item symboltable_init() 
 
-Initialises a symbol table and associates it with its parent.  The symbol table is also registered globally for later
-garbage collection.
+Initialises a symbol table and associates it with its parent.  Unless flags includes SYMBOLTABLE_FLAG_FRAME, the
+symbol table is also registered globally for later garbage collection.
+
+A frame table belongs to a call frame, and its memory is managed by the frame arena of the context that created it
+(see vm_start_scope()).  Frame tables are never seen by other threads, so they skip the registry and its lock
+entirely.  The caller is responsible for releasing a frame table's memory once symboltable_destroy() has destroyed it.
+
+If slot_count is non-zero, symbols with any of the slot_count identifiers given, which must be sorted, are stored
+directly in the table's array of slots rather than in its tree.  The table must have been allocated with room for the
+slots, i.e. with SYMBOLTABLE_SIZE(slot_count) bytes.  Function scopes use slots for the symbols their function
+defines; see program_init() for how those are found.
 
 =cut
  */
-int symboltable_init(symboltable_t *restrict self, symboltable_t *restrict parent) {
+int symboltable_init(symboltable_t *restrict self, symboltable_t *restrict parent, size_t slot_count,
+                     const identifier_t *slot_identifiers, flags32_t flags) {
     assert(self != NULL);
     assert(self != parent);
-    debug("initialising symboltable %p with parent %p\n", self, parent);
+    debug("initialising symboltable %p with parent %p and %zu slots\n", self, parent, slot_count);
     
-    self->m_references = 1;
+    atomic_init(&self->m_references, 1);
     self->m_symbols = NULL;
     self->m_parent = parent;
-    if (self->m_parent != NULL)  ++self->m_parent->m_references;
+    self->m_flags = flags;
+    self->m_symbol_count = 0;
+    self->m_root = (parent != NULL ? parent->m_root : self);
+    self->m_shadows = (parent != NULL && parent->m_parent != NULL ? parent->m_shadows : 0);
+    self->m_slot_identifiers = slot_identifiers;
+    self->m_slot_count = slot_count;
+    memset(self->m_slots, 0, slot_count * sizeof(self->m_slots[0]));
+    for (size_t i = 0; i < slot_count; i++)  self->m_slots[i].m_identifier = slot_identifiers[i];
+    self->m_serial = 1 + atomic_fetch_add_explicit(&_symboltable_serial, 1, memory_order_relaxed);
+    atomic_init(&self->m_version, 0);
+    if (self->m_parent != NULL)  symboltable_reference(self->m_parent);
+
+    if (flags & SYMBOLTABLE_FLAG_FRAME)  return 0;
     
     symboltable_registry_node_t *reg_entry;
     if (NULL != (reg_entry = calloc(1, sizeof(*reg_entry)))) {
@@ -93,16 +125,26 @@ is left in the global registry for later garbage collection.
  */
 int symboltable_destroy(symboltable_t *self) {
     assert(self != NULL);
-    assert(self->m_references > 0);
     debug("destroying symboltable %p\n", self);
 
-    if (self->m_references == 1) {
+    // drop our reference, unless it's the last one.  The last one is left in place while the table's cleaned up, so
+    // that symboltable_garbage_collect() can't mistake it for an abandoned table and collect it at the same time
+    size_t references = atomic_load_explicit(&self->m_references, memory_order_acquire);
+    assert(references > 0);
+    while (references > 1) {
+        if (atomic_compare_exchange_weak_explicit(&self->m_references, &references, references - 1,
+                                                  memory_order_acq_rel, memory_order_acquire))  break;
+    }
+
+    if (references == 1) {
         debug("this is the last reference, cleaning up\n");
-        if (self->m_parent != NULL)  --self->m_parent->m_references;
-        if (self->m_symbols != NULL) {
-            _symbol_reap(self->m_symbols);
-            free(self->m_symbols);
-        } 
+        if (self->m_parent != NULL)  _symboltable_unreference(self->m_parent);
+        _symboltable_reap(self);
+
+        if (self->m_flags & SYMBOLTABLE_FLAG_FRAME) {
+            memset(self, 0, sizeof(*self));
+            return 0;
+        }
         
         if (0 == pthread_mutex_lock(&_symboltable_registry_mutex)) {
             debug("removing my registry entry\n");
@@ -141,8 +183,7 @@ int symboltable_destroy(symboltable_t *self) {
         return 0;
     }
     else {
-        --self->m_references;
-        debug("%zd others still hold references, not cleaning up\n", self->m_references);
+        debug("%zu others still hold references, not cleaning up\n", references - 1);
         return -1;
     }
 }
@@ -154,6 +195,8 @@ Cuts off a symbol table from its parent.  Symbols defined in ancestor scopes wil
 
 To make copies of any needed ancestor symbols prior to isolating a symbol table, use C<symbol_clone()> to clone them.
 
+The table must not have any children yet, because they'd go on treating its old root as their own.
+
 =cut
  */
 int symboltable_isolate(symboltable_t *table) {
@@ -161,9 +204,12 @@ int symboltable_isolate(symboltable_t *table) {
     debug("isolating symboltable %p\n", table);
     
     if (table->m_parent != NULL) {
-        assert(table->m_parent->m_references > 0);
-        --table->m_parent->m_references;
+        assert(atomic_load_explicit(&table->m_references, memory_order_relaxed) == 1);
+        _symboltable_changed(table);
+        _symboltable_unreference(table->m_parent);
         table->m_parent = NULL;
+        table->m_root = table;
+        table->m_shadows = 0;
     }
     
     return 0;
@@ -187,7 +233,7 @@ int symboltable_garbage_collect(void) {
     if (0 == pthread_mutex_lock(&_symboltable_registry_mutex)) {
         while (_symboltable_registry != NULL) {
             assert(_symboltable_registry->m_table != NULL);
-            if (_symboltable_registry->m_table->m_references > 0) {
+            if (atomic_load_explicit(&_symboltable_registry->m_table->m_references, memory_order_acquire) > 0) {
                 debug("symboltable %p reference count is greater than zero, not collecting\n", _symboltable_registry->m_table);
                 break;  
             } 
@@ -200,11 +246,8 @@ int symboltable_garbage_collect(void) {
                 memset(old_reg, 0, sizeof(*old_reg));
                 free(old_reg);
                 
-                if (old_table->m_parent != NULL)  --old_table->m_parent->m_references;
-                if (old_table->m_symbols != NULL) {
-                    _symbol_reap(old_table->m_symbols);
-                    free(old_table->m_symbols);
-                }
+                if (old_table->m_parent != NULL)  _symboltable_unreference(old_table->m_parent);
+                _symboltable_reap(old_table);
                 
                 memset(old_table, 0, sizeof(*old_table));
                 free(old_table);
@@ -232,49 +275,43 @@ Returns the new symbol, or NULL on failure.
 const symbol_t *symbol_define(symboltable_t *table, identifier_t identifier, flags32_t flags, handle_t handle) {
     assert(table != NULL);
 
-    symbol_t *symbol = calloc(1, sizeof(*symbol));
-    if (symbol == NULL)  return NULL;
-
-    _symbol_init(symbol);
-    symbol->m_identifier = identifier;
+    symbol_t symbol;
+    _symbol_init(&symbol);
+    symbol.m_identifier = identifier;
     switch (flags & SYMBOL_TYPE_MASK) {
         case SYMBOL_SCALAR:
-            symbol->m_flags = SYMBOL_SCALAR;
-            symbol->m_referent = (handle ? scalar_reference(handle) : scalar_allocate(flags & ~SYMBOL_TYPE_MASK));
+            symbol.m_flags = SYMBOL_SCALAR;
+            symbol.m_referent = (handle ? scalar_reference(handle) : scalar_allocate(flags & ~SYMBOL_TYPE_MASK));
             break;
         case SYMBOL_ARRAY:
-            symbol->m_flags = SYMBOL_ARRAY;
-            symbol->m_referent = (handle ? array_reference(handle) : array_allocate(flags & ~SYMBOL_TYPE_MASK));
+            symbol.m_flags = SYMBOL_ARRAY;
+            symbol.m_referent = (handle ? array_reference(handle) : array_allocate(flags & ~SYMBOL_TYPE_MASK));
             break;
         case SYMBOL_HASH:
-            symbol->m_flags = SYMBOL_HASH;
-            symbol->m_referent = (handle ? hash_reference(handle) : hash_allocate());
+            symbol.m_flags = SYMBOL_HASH;
+            symbol.m_referent = (handle ? hash_reference(handle) : hash_allocate());
             break;
         case SYMBOL_CHANNEL:
-            symbol->m_flags = SYMBOL_CHANNEL;
-            symbol->m_referent = (handle ? channel_reference(handle) : channel_allocate());
+            symbol.m_flags = SYMBOL_CHANNEL;
+            symbol.m_referent = (handle ? channel_reference(handle) : channel_allocate());
             break;
         case SYMBOL_FUNCTION:
-            symbol->m_flags = SYMBOL_FUNCTION;
-            symbol->m_referent = handle;
+            symbol.m_flags = SYMBOL_FUNCTION;
+            symbol.m_referent = handle;
             break;
         case SYMBOL_STREAM:
-            symbol->m_flags = SYMBOL_STREAM;
-            symbol->m_referent = (handle ? stream_reference(handle) : stream_allocate());
+            symbol.m_flags = SYMBOL_STREAM;
+            symbol.m_referent = (handle ? stream_reference(handle) : stream_allocate());
         //...
         default:
             debug("unhandled symbol type: %"PRIu32"\n", flags);
             break;
     }
     
-    if (0 == _symboltable_insert(table, symbol)) {
-        return symbol;
-    }
-    else {
-        _symbol_destroy(symbol);
-        free(symbol);
-        return NULL;
-    }
+    const symbol_t *result = _symboltable_insert(table, &symbol);
+    if (result == NULL)  _symbol_destroy(&symbol);
+
+    return result;
 }
 
 /*
@@ -291,13 +328,8 @@ const symbol_t *symbol_clone(symboltable_t *table, identifier_t identifier) {
     assert(table != NULL);
     assert(table->m_parent != NULL);
     
-    // temporarily detach the table's parent to do a local-only lookup
-    symboltable_t *tmp = table->m_parent;
-    table->m_parent = NULL;
-    const symbol_t *local_symbol = symbol_lookup(table, identifier);
-    table->m_parent = tmp;
-    
     // if a symbol was found locally, there's nothing to do here
+    const symbol_t *local_symbol = _symboltable_find(table, identifier);
     if (local_symbol != NULL)  return local_symbol;
     
     // find the symbol in an ancestor scope
@@ -305,34 +337,34 @@ const symbol_t *symbol_clone(symboltable_t *table, identifier_t identifier) {
 
     // clone it into the current scope
     if (remote_symbol != NULL) {
-        symbol_t *symbol = calloc(1, sizeof(*symbol));
-        if (symbol == NULL)  return NULL;
-        _symbol_init(symbol);
+        symbol_t symbol;
+        _symbol_init(&symbol);
+        symbol.m_identifier = identifier;
         
         switch (remote_symbol->m_flags & SYMBOL_TYPE_MASK) {
             case SYMBOL_SCALAR:
-                symbol->m_flags = SYMBOL_SCALAR;
-                symbol->m_referent = scalar_reference(remote_symbol->m_referent);
+                symbol.m_flags = SYMBOL_SCALAR;
+                symbol.m_referent = scalar_reference(remote_symbol->m_referent);
                 break;
             case SYMBOL_ARRAY:
-                symbol->m_flags = SYMBOL_ARRAY;
-                symbol->m_referent = array_reference(remote_symbol->m_referent);
+                symbol.m_flags = SYMBOL_ARRAY;
+                symbol.m_referent = array_reference(remote_symbol->m_referent);
                 break;
             case SYMBOL_HASH:
-                symbol->m_flags = SYMBOL_HASH;
-                symbol->m_referent = hash_reference(remote_symbol->m_referent);
+                symbol.m_flags = SYMBOL_HASH;
+                symbol.m_referent = hash_reference(remote_symbol->m_referent);
                 break;
             case SYMBOL_CHANNEL:
-                symbol->m_flags = SYMBOL_CHANNEL;
-                symbol->m_referent = channel_reference(remote_symbol->m_referent);
+                symbol.m_flags = SYMBOL_CHANNEL;
+                symbol.m_referent = channel_reference(remote_symbol->m_referent);
                 break;
             case SYMBOL_FUNCTION:
-                symbol->m_flags = SYMBOL_FUNCTION;
-                symbol->m_referent = remote_symbol->m_referent;
+                symbol.m_flags = SYMBOL_FUNCTION;
+                symbol.m_referent = remote_symbol->m_referent;
                 break;
             case SYMBOL_STREAM:
-                symbol->m_flags = SYMBOL_STREAM;
-                symbol->m_referent = stream_reference(remote_symbol->m_referent);
+                symbol.m_flags = SYMBOL_STREAM;
+                symbol.m_referent = stream_reference(remote_symbol->m_referent);
                 break;
             //...
             default:
@@ -340,14 +372,10 @@ const symbol_t *symbol_clone(symboltable_t *table, identifier_t identifier) {
                 break;
         }
 
-        if (0 == _symboltable_insert(table, symbol)) {
-            return symbol;
-        }
-        else {
-            _symbol_destroy(symbol);
-            free(symbol);
-            return NULL;
-        }
+        const symbol_t *result = _symboltable_insert(table, &symbol);
+        if (result == NULL)  _symbol_destroy(&symbol);
+
+        return result;
     }
     else {
         return NULL;
@@ -366,23 +394,89 @@ Returns a pointer to the symbol_t object found, or NULL if the symbol is not def
  */
 const symbol_t *symbol_lookup(symboltable_t *table, identifier_t identifier) {
     assert(table != NULL);
-    symboltable_t *scope = table;
-    while (scope != NULL) {
-        symbol_t *symbol = scope->m_symbols;
-        while (symbol != NULL) {
-            if (identifier < symbol->m_identifier) {
-                symbol = symbol->m_left_child;
-            }
-            else if (identifier >  symbol->m_identifier) {
-                symbol = symbol->m_right_child;
-            }
-            else {
-                return symbol;
+    for (const symboltable_t *scope = table; scope != NULL; scope = scope->m_parent) {
+        const symbol_t *symbol = _symboltable_find(scope, identifier);
+        if (symbol != NULL)  return symbol;
+    }
+    return NULL;
+}
+
+/*
+=item symbol_clone_cached()
+
+=item symbol_lookup_cached()
+
+Equivalent to symbol_clone() and symbol_lookup(), but first consult the given cache, and update it afterwards.
+
+A cache remembers the result of the last operation performed with it, in one of three forms, each of which is checked
+without searching anything:
+
+=over
+
+=item a symbol found in one of the slots of the table searched
+
+The cache keeps the slot's index, and the table's slot identifiers, which every frame of the same function shares.  It
+holds for any table with the same slot identifiers, as long as that slot is defined, so a function's new frame can
+use the result cached by its previous call.
+
+=item a symbol found in the tree of the table searched
+
+The cache keeps the table's serial number, which isn't reused by later tables the way its address might be, and its
+version.  Defining, undefining or cloning a symbol, or isolating a table, advances that table's version.
+
+=item a symbol found in the root table, or not found at all
+
+The cache keeps the root's serial number and version, and holds for any table with the same root, as long as none of
+the tables between them define the identifier.  Each table keeps a mask of the identifiers that it and its ancestors
+below the root might define (see _symboltable_shadow()), copied from its parent when it's created.  A table that
+defines a symbol while it has children, whose masks can't know about it, advances its root's version instead.
+
+=back
+
+A symbol found in any other table isn't cached.  symbol_clone_cached() only accepts a result from the table being
+searched itself, because a symbol it finds further up still has to be cloned.
+
+Caches are updated without locking, so that the interpreter can keep one per instruction even when several threads are
+executing the same instructions.  A cache must be zero-filled before its first use.
+
+=cut
+ */
+const symbol_t *symbol_clone_cached(symboltable_t *table, identifier_t identifier, symbol_cache_t *cache) {
+    assert(table != NULL);
+    assert(cache != NULL);
+
+    const symbol_t *symbol;
+
+    if (0 != _symbol_cache_get(cache, table, identifier, 1, &symbol)) {
+        // n.b. if this clones the symbol, the table's version moves on and this result is only used once.  A symbol
+        // that wasn't found isn't cached, because only this table's version is checked and an ancestor could define it
+        const uint_fast64_t version = atomic_load_explicit(&table->m_version, memory_order_acquire);
+        symbol = symbol_clone(table, identifier);
+        if (symbol != NULL)  _symbol_cache_set(cache, table, version, symbol);
+    }
+
+    return symbol;
+}
+
+const symbol_t *symbol_lookup_cached(symboltable_t *table, identifier_t identifier, symbol_cache_t *cache) {
+    assert(table != NULL);
+    assert(cache != NULL);
+
+    const symbol_t *symbol;
+
+    if (0 != _symbol_cache_get(cache, table, identifier, 0, &symbol)) {
+        // the same search as symbol_lookup(), but noting which table ended it and that table's version beforehand
+        for (const symboltable_t *scope = table; ; scope = scope->m_parent) {
+            const uint_fast64_t version = atomic_load_explicit(&scope->m_version, memory_order_acquire);
+            symbol = _symboltable_find(scope, identifier);
+            if (symbol != NULL || scope->m_parent == NULL) {
+                if (scope == table || scope->m_parent == NULL)  _symbol_cache_set(cache, scope, version, symbol);
+                break;
             }
         }
-        scope = scope->m_parent;
     }
-    return NULL;
+
+    return symbol;
 }
 
 /*
@@ -399,13 +493,18 @@ int symbol_undefine(symboltable_t *table, identifier_t identifier) {
     assert(table != NULL);
     debug("undefining identifier %"PRIuPTR" from table %p\n", identifier, table);
         
-    // temporarily detach the table's parent to do a local-only lookup
-    symboltable_t *tmp = table->m_parent;
-    table->m_parent = NULL;
-    symbol_t *symbol = (symbol_t *) symbol_lookup(table, identifier);
-    table->m_parent = tmp;
+    symbol_t *symbol = (symbol_t *) _symboltable_find(table, identifier);
     
     if (symbol == NULL)  return 0;
+
+    --table->m_symbol_count;
+    _symboltable_changed(table);
+
+    if (symbol == _symboltable_slot(table, identifier)) {
+        _symbol_destroy(symbol);
+        symbol->m_identifier = identifier;
+        return 0;
+    }
     
     if (symbol->m_left_child != NULL) {
         if (symbol->m_right_child != NULL) {
@@ -521,21 +620,43 @@ int symbol_undefine(symboltable_t *table, identifier_t identifier) {
 /*
 =item _symboltable_insert()
 
-Transfer ownership of a symbol pointer into the given symbol table.  
+Transfer ownership of a symbol's contents into the given symbol table, either into its slot or into a new node in the
+tree.
 
-Returns 0 on success, in which case the caller should I<not> perform any cleanup on their pointer to the symbol.
+Returns the stored symbol on success, in which case the caller should I<not> perform any cleanup on their copy of the
+symbol.
 
-On failure returns non-zero, in which case the caller remains responsible for cleanup of the symbol.
+On failure returns NULL, in which case the caller remains responsible for cleanup of the symbol.
 
 =cut
  */
-int _symboltable_insert(symboltable_t *restrict table, symbol_t *restrict symbol) {
+const symbol_t *_symboltable_insert(symboltable_t *restrict table, const symbol_t *restrict prototype) {
     assert(table != NULL);
-    assert(symbol != NULL);
+    assert(prototype != NULL);
+
+    if (table->m_parent != NULL)  table->m_shadows |= _symboltable_shadow(prototype->m_identifier);
+
+    symbol_t *slot = _symboltable_slot(table, prototype->m_identifier);
+    if (slot != NULL) {
+        if (slot->m_flags != 0) {
+            debug("identifier %"PRIuPTR" is already defined in current scope\n", prototype->m_identifier);
+            return NULL;
+        }
+        *slot = *prototype;
+        ++table->m_symbol_count;
+        _symboltable_changed(table);
+        return slot;
+    }
+
+    symbol_t *symbol = calloc(1, sizeof(*symbol));
+    if (symbol == NULL)  return NULL;
+    *symbol = *prototype;
     
     if (table->m_symbols == NULL) {
         table->m_symbols = symbol;
-        return 0;
+        ++table->m_symbol_count;
+        _symboltable_changed(table);
+        return symbol;
     }
     else {
         symbol_t *parent = table->m_symbols;
@@ -544,7 +665,9 @@ int _symboltable_insert(symboltable_t *restrict table, symbol_t *restrict symbol
                 if (parent->m_left_child == NULL) {
                     parent->m_left_child = symbol;
                     symbol->m_parent = parent;
-                    return 0;
+                    ++table->m_symbol_count;
+                    _symboltable_changed(table);
+                    return symbol;
                 }
                 else {
                     parent = parent->m_left_child;
@@ -554,7 +677,9 @@ int _symboltable_insert(symboltable_t *restrict table, symbol_t *restrict symbol
                 if (parent->m_right_child == NULL) {
                     parent->m_right_child = symbol;
                     symbol->m_parent = parent;
-                    return 0;
+                    ++table->m_symbol_count;
+                    _symboltable_changed(table);
+                    return symbol;
                 }
                 else {
                     parent = parent->m_right_child;
@@ -562,15 +687,216 @@ int _symboltable_insert(symboltable_t *restrict table, symbol_t *restrict symbol
             }
             else {
                 debug("identifier %"PRIuPTR" is already defined in current scope\n", symbol->m_identifier);
-                return -1;
+                free(symbol);
+                return NULL;
             }
         } while (parent != NULL);
         
         debug("not supposed to get here\n");
-        return -1;
+        free(symbol);
+        return NULL;
     }    
 }
 
+/*
+=item _symboltable_slot()
+
+Finds the slot a table keeps for the given identifier, whether or not it's currently defined.
+
+Returns the slot, or NULL if the table doesn't have one for the identifier.
+
+=cut
+ */
+static inline symbol_t *_symboltable_slot(const symboltable_t *table, identifier_t identifier) {
+    size_t low = 0, high = table->m_slot_count;
+
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        const identifier_t slot_identifier = table->m_slots[middle].m_identifier;
+
+        if (identifier < slot_identifier)  high = middle;
+        else if (identifier > slot_identifier)  low = middle + 1;
+        else  return (symbol_t *) &table->m_slots[middle];
+    }
+
+    return NULL;
+}
+
+/*
+=item _symboltable_find()
+
+Looks for a symbol in the given table only, without searching its ancestors.
+
+Returns the symbol, or NULL if the table doesn't define it.
+
+=cut
+ */
+static inline const symbol_t *_symboltable_find(const symboltable_t *table, identifier_t identifier) {
+    assert(table != NULL);
+
+    const symbol_t *slot = _symboltable_slot(table, identifier);
+    if (slot != NULL)  return (slot->m_flags != 0 ? slot : NULL);
+
+    const symbol_t *symbol = table->m_symbols;
+    while (symbol != NULL) {
+        if (identifier < symbol->m_identifier) {
+            symbol = symbol->m_left_child;
+        }
+        else if (identifier >  symbol->m_identifier) {
+            symbol = symbol->m_right_child;
+        }
+        else {
+            return symbol;
+        }
+    }
+    return NULL;
+}
+
+/*
+=item _symboltable_shadow()
+
+Returns the bit that stands for identifier in a table's mask of the identifiers it and its ancestors might define.
+Identifiers share bits, so a set bit only means the identifier might be shadowed.
+
+=cut
+ */
+static inline uint64_t _symboltable_shadow(identifier_t identifier) {
+    return UINT64_C(1) << (identifier % 64);
+}
+
+/*
+=item _symboltable_reap()
+
+Destroys all the symbols in a symbol table, both in its slots and in its tree.
+
+=cut
+ */
+void _symboltable_reap(symboltable_t *table) {
+    assert(table != NULL);
+
+    for (size_t i = 0; i < table->m_slot_count; i++) {
+        if (table->m_slots[i].m_flags != 0)  _symbol_destroy(&table->m_slots[i]);
+    }
+
+    if (table->m_symbols != NULL) {
+        _symbol_reap(table->m_symbols);
+        free(table->m_symbols);
+        table->m_symbols = NULL;
+    }
+}
+
+/*
+=item _symboltable_changed()
+
+Advances a table's version, invalidating any symbol cache that holds a result found in it.  Must be called whenever the
+table's own symbols, or its parent, change.  If the table has children, their masks of shadowed identifiers were copied
+before the change, so its root's version is advanced as well.
+
+Only the context that owns a frame ever changes it, so frames skip the atomic read-modify-write.
+
+=cut
+ */
+void _symboltable_changed(symboltable_t *table) {
+    if (table->m_flags & SYMBOLTABLE_FLAG_FRAME) {
+        const uint_fast64_t version = atomic_load_explicit(&table->m_version, memory_order_relaxed);
+        atomic_store_explicit(&table->m_version, version + 1, memory_order_release);
+    }
+    else {
+        atomic_fetch_add_explicit(&table->m_version, 1, memory_order_release);
+    }
+
+    if (table->m_parent != NULL && atomic_load_explicit(&table->m_references, memory_order_relaxed) > 1) {
+        _symboltable_changed(table->m_root);
+    }
+}
+
+/*
+=item _symboltable_unreference()
+
+Drops a child's reference to its parent table.  If that was the last reference, the parent is left in the registry for
+symboltable_garbage_collect() to find.
+
+=cut
+ */
+void _symboltable_unreference(symboltable_t *table) {
+    size_t old = atomic_fetch_sub_explicit(&table->m_references, 1, memory_order_release);
+    assert(old > 0);
+    (void) old;
+}
+
+/*
+=item _symbol_cache_get()
+
+=item _symbol_cache_set()
+
+Read and write symbol caches.  Each cache is guarded by a sequence number, which is odd while the cache is being
+written.  A reader only accepts an entry whose sequence number was even and unchanged across its reads, and if two
+threads try to write the same cache at once, the one that loses just doesn't cache its result.
+
+_symbol_cache_get() returns 0 and sets *symbol if the cache holds a valid result for a search for identifier starting
+from table, and non-zero otherwise.  If local is non-zero, it only accepts a result found in table itself.  The table
+passed to _symbol_cache_set() is the one the result was found in, which must be either the table searched or its root,
+and version is that table's version from before it was searched.
+
+=cut
+ */
+int _symbol_cache_get(symbol_cache_t *restrict cache, const symboltable_t *restrict table, identifier_t identifier,
+                      int local, const symbol_t **symbol) {
+    const unsigned sequence = atomic_load_explicit(&cache->m_sequence, memory_order_acquire);
+    if (sequence & 1)  return -1;
+
+    const unsigned slot = atomic_load_explicit(&cache->m_slot, memory_order_relaxed);
+    const uintptr_t slot_identifiers = atomic_load_explicit(&cache->m_slot_identifiers, memory_order_relaxed);
+    const uint_fast64_t serial = atomic_load_explicit(&cache->m_serial, memory_order_relaxed);
+    const uint_fast64_t version = atomic_load_explicit(&cache->m_version, memory_order_relaxed);
+    const uintptr_t result = atomic_load_explicit(&cache->m_symbol, memory_order_relaxed);
+
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&cache->m_sequence, memory_order_relaxed) != sequence)  return -1;
+
+    if (slot != 0) {
+        if ((const identifier_t *) slot_identifiers != table->m_slot_identifiers)  return -1;
+        assert(slot <= table->m_slot_count);
+        if (table->m_slots[slot - 1].m_flags == 0)  return -1;
+        *symbol = &table->m_slots[slot - 1];
+        return 0;
+    }
+
+    const symboltable_t *scope;
+    if (table->m_serial == serial) {
+        scope = table;
+    }
+    else if (!local && table->m_root->m_serial == serial
+             && 0 == (table->m_shadows & _symboltable_shadow(identifier))) {
+        scope = table->m_root;
+    }
+    else {
+        return -1;
+    }
+
+    if (atomic_load_explicit(&scope->m_version, memory_order_acquire) != version)  return -1;
+    *symbol = (const symbol_t *) result;
+    return 0;
+}
+
+void _symbol_cache_set(symbol_cache_t *restrict cache, const symboltable_t *restrict table, uint_fast64_t version,
+                       const symbol_t *symbol) {
+    unsigned sequence = atomic_load_explicit(&cache->m_sequence, memory_order_relaxed);
+    if (sequence & 1)  return;
+    if (!atomic_compare_exchange_strong_explicit(&cache->m_sequence, &sequence, sequence + 1,
+                                                 memory_order_relaxed, memory_order_relaxed))  return;
+    atomic_thread_fence(memory_order_release);
+
+    const int in_slot = (symbol != NULL && symbol == _symboltable_slot(table, symbol->m_identifier));
+    atomic_store_explicit(&cache->m_slot, (in_slot ? 1 + (symbol - table->m_slots) : 0), memory_order_relaxed);
+    atomic_store_explicit(&cache->m_slot_identifiers, (uintptr_t) table->m_slot_identifiers, memory_order_relaxed);
+    atomic_store_explicit(&cache->m_serial, table->m_serial, memory_order_relaxed);
+    atomic_store_explicit(&cache->m_version, version, memory_order_relaxed);
+    atomic_store_explicit(&cache->m_symbol, (uintptr_t) symbol, memory_order_relaxed);
+
+    atomic_store_explicit(&cache->m_sequence, sequence + 2, memory_order_release);
+}
+
 /*
 =item _symbol_init()
 
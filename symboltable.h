@@ -10,6 +10,8 @@
 #ifndef SYMBOLTABLE_H
 #define SYMBOLTABLE_H
 
+#include <stdatomic.h>
+
 #include "vmtypes.h"
 
 #define SYMBOL_SCALAR       0x01u
@@ -23,6 +25,8 @@
 
 #define SYMBOL_FLAG_SHARED  0x80000000u
 
+#define SYMBOLTABLE_FLAG_FRAME  0x00000001u     /* owned by a context's frame arena, not registered for collection */
+
 typedef struct symbol_t {
     struct symbol_t *m_parent;
     struct symbol_t *m_left_child;
@@ -34,18 +38,46 @@ typedef struct symbol_t {
 
 typedef struct symboltable_t {
     struct symboltable_t *m_parent;
+    struct symboltable_t *m_root;
     symbol_t *m_symbols;
-    size_t m_references;
+    atomic_size_t m_references;
+    size_t m_symbol_count;
+    flags32_t m_flags;
+    uint_fast64_t m_serial;
+    atomic_uint_fast64_t m_version;
+    uint64_t m_shadows;
+    const identifier_t *m_slot_identifiers;
+    size_t m_slot_count;
+    symbol_t m_slots[];
 } symboltable_t;
 
-int symboltable_init(symboltable_t *restrict, symboltable_t *restrict);
+#define SYMBOLTABLE_SIZE(slot_count)    (sizeof(symboltable_t) + (slot_count) * sizeof(symbol_t))
+
+typedef struct symbol_cache_t {
+    atomic_uint m_sequence;
+    atomic_uint m_slot;
+    atomic_uint_fast64_t m_serial;
+    atomic_uint_fast64_t m_version;
+    atomic_uintptr_t m_symbol;
+    atomic_uintptr_t m_slot_identifiers;
+} symbol_cache_t;
+
+int symboltable_init(symboltable_t *restrict, symboltable_t *restrict, size_t, const identifier_t *, flags32_t);
 int symboltable_destroy(symboltable_t *);
 int symboltable_isolate(symboltable_t *);
+
+static inline symboltable_t *symboltable_reference(symboltable_t *self) {
+    atomic_fetch_add_explicit(&self->m_references, 1, memory_order_relaxed);
+    return self;
+}
+
 int symboltable_garbage_collect(void);
 
 const symbol_t *symbol_define(symboltable_t *, identifier_t, flags32_t, handle_t);
 const symbol_t *symbol_clone(symboltable_t *, identifier_t);
 const symbol_t *symbol_lookup(symboltable_t *, identifier_t);
+const symbol_t *symbol_clone_cached(symboltable_t *, identifier_t, symbol_cache_t *);
+const symbol_t *symbol_lookup_cached(symboltable_t *, identifier_t, symbol_cache_t *);
 int symbol_undefine(symboltable_t *, identifier_t);
 
 #endif
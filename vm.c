@@ -11,6 +11,7 @@
 #include <inttypes.h>
 #include <pthread.h>
 #include <signal.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -25,9 +26,6 @@
 #include "stream.h"
 #include "vm.h"
 
-#define VM_CONTEXT_FLAG_SIG_MANAGER     0x00000001u
-#define VM_CONTEXT_FLAG_IN_SIG_HANDLER  0x00000002u
-
 typedef struct vm_context_registry_node_t {
     struct vm_context_registry_node_t *m_next;
     vm_context_t *m_context;
@@ -43,8 +41,15 @@ static struct {
     const size_t m_count;
     pthread_mutex_t m_mutex;
     function_handle_t m_handlers[NSIG];
-    sigset_t m_sigset;
+    sigset_t m_sigset;          // signals accepted by the signal thread
+    sigset_t m_pending;         // signals received but not yet handled by m_target
+    vm_context_t *m_target;     // context in which handlers are run
+    pthread_t m_thread;
 } _vm_signal_registry = {NSIG, PTHREAD_MUTEX_INITIALIZER, {0}};
+
+static void *_vm_signal_thread(void *);
+static void _vm_signal_default(int);
+static void _vm_print_pool_stats(const char *, int (*)(pool_magazine_stats_t *));
 /*
 =head1 NAME
 
@@ -69,23 +74,61 @@ STACK_DEFINITIONS(vm_state_t, vm_state_init, vm_state_destroy, vm_state_clone);
 
 =item vm_main()
 
-Runs the virtual machine.
+Runs the virtual machine.  With VM_MAIN_FLAG_POOL_STATS in flags, prints each pool's allocation counts to stderr
+once the program has finished, before the pools are destroyed.
 
 =cut
 */
-int vm_main(const uint8_t *bytecode, size_t length, size_t start) {
+int vm_main(const uint8_t *bytecode, size_t length, size_t start, flags32_t flags) {
     vm_context_t *context;
+    program_t program;
+    const op_t *start_op;
+
+    if (0 != program_init(&program, bytecode, length)) {
+        debug("failed to load bytecode\n");
+        return -1;
+    }
+
+    if (NULL == (start_op = program_op(&program, start))) {
+        debug("start position %zu is not an instruction\n", start);
+        program_destroy(&program);
+        return -1;
+    }
 
     if (0 == pthread_mutex_lock(&_vm_signal_registry.m_mutex)) {
-        sigemptyset(&_vm_signal_registry.m_sigset);
         for (size_t i = 0; i < _vm_signal_registry.m_count; i++) {
             _vm_signal_registry.m_handlers[i] = VM_SIGNAL_DEFAULT;
         }
+        sigemptyset(&_vm_signal_registry.m_pending);
+        _vm_signal_registry.m_target = NULL;
+
+        // asynchronous signals are blocked in every vm thread (which inherit this mask) and accepted by the
+        // signal thread instead.  signals that are delivered synchronously to the thread that caused them are
+        // left alone.
+        sigfillset(&_vm_signal_registry.m_sigset);
+        sigdelset(&_vm_signal_registry.m_sigset, SIGABRT);
+        sigdelset(&_vm_signal_registry.m_sigset, SIGBUS);
+        sigdelset(&_vm_signal_registry.m_sigset, SIGFPE);
+        sigdelset(&_vm_signal_registry.m_sigset, SIGILL);
+        sigdelset(&_vm_signal_registry.m_sigset, SIGPIPE);
+        sigdelset(&_vm_signal_registry.m_sigset, SIGSEGV);
+        sigdelset(&_vm_signal_registry.m_sigset, SIGTRAP);
         pthread_sigmask(SIG_SETMASK, &_vm_signal_registry.m_sigset, NULL);
+
+        int status;
+        if (0 != (status = pthread_create(&_vm_signal_registry.m_thread, NULL, _vm_signal_thread, NULL))) {
+            debug("failed to start signal thread: %i\n", status);
+            sigemptyset(&_vm_signal_registry.m_sigset);
+            pthread_sigmask(SIG_SETMASK, &_vm_signal_registry.m_sigset, NULL);
+            pthread_mutex_unlock(&_vm_signal_registry.m_mutex);
+            program_destroy(&program);
+            return -1;
+        }
         pthread_mutex_unlock(&_vm_signal_registry.m_mutex);
     }
     else {
         debug("failed to initialise signal handlers\n");
+        program_destroy(&program);
         return -1;
     }
 
@@ -96,8 +139,12 @@ int vm_main(const uint8_t *bytecode, size_t length, size_t start) {
     stream_pool_init();
     
     if (NULL != (context = calloc(1, sizeof(*context)))) {
-        vm_context_init(context, bytecode, length, start);
+        vm_context_init(context, &program, start_op);
         context->m_flags |= VM_CONTEXT_FLAG_SIG_MANAGER;
+        if (0 == pthread_mutex_lock(&_vm_signal_registry.m_mutex)) {
+            _vm_signal_registry.m_target = context;
+            pthread_mutex_unlock(&_vm_signal_registry.m_mutex);
+        }
         vm_execute(context);
     }
     
@@ -109,8 +156,12 @@ int vm_main(const uint8_t *bytecode, size_t length, size_t start) {
         pthread_mutex_unlock(&_vm_context_registry.m_mutex);
     }
     
+    pthread_cancel(_vm_signal_registry.m_thread);
+    pthread_join(_vm_signal_registry.m_thread, NULL);
+
     if (0 == pthread_mutex_lock(&_vm_signal_registry.m_mutex)) {
         sigemptyset(&_vm_signal_registry.m_sigset);
+        sigemptyset(&_vm_signal_registry.m_pending);
         for (size_t i = 0; i < _vm_signal_registry.m_count; i++) {
             _vm_signal_registry.m_handlers[i] = VM_SIGNAL_DEFAULT;
         }
@@ -125,12 +176,22 @@ int vm_main(const uint8_t *bytecode, size_t length, size_t start) {
         sleep(1);
     }
 
+    if (flags & VM_MAIN_FLAG_POOL_STATS) {
+        _vm_print_pool_stats("scalar", scalar_pool_stats);
+        _vm_print_pool_stats("array", array_pool_stats);
+        _vm_print_pool_stats("hash", hash_pool_stats);
+        _vm_print_pool_stats("channel", channel_pool_stats);
+        _vm_print_pool_stats("stream", stream_pool_stats);
+    }
+
     stream_pool_destroy();
     channel_pool_destroy();
     hash_pool_destroy();
     array_pool_destroy();
     scalar_pool_destroy();
     
+    program_destroy(&program);
+    
     return 0;
 }
 
@@ -168,76 +229,19 @@ void *vm_execute(void *ptr) {
     // set the top of the return stack to point back to the zero'th instruction, which always contains END.
     // this allows the vm entry point to be a normal function that expects to simply return when it's done.
     vm_state_t initial_state = {0};
-    vm_state_init(&initial_state, 0, context->m_flags, context->m_symboltable);
+    vm_state_init(&initial_state, program_op(context->m_program, 0), context->m_flags, context->m_symboltable);
     vm_rs_push(context, &initial_state);
     vm_state_destroy(&initial_state);
     
-    vm_start_scope(context);
-    
-    int incr;
-    while (context->m_counter < context->m_bytecode_length) {
-        uint8_t instruction = context->m_bytecode[context->m_counter];
-        assert(instruction < i__MAX);
-        switch (instruction) {
-            case i_END:
-                goto end;
-            case i_NOOP:
-                context->m_counter++;
-                break;
-            default:
-                incr = instruction_table[instruction](context);
-                assert(incr != 0);
-                context->m_counter += incr;
-                break;
-        }
-        
-        // if this thread is the signal manager, and isn't currently in a signal handler, then deal with the next signal
-        if ((context->m_flags & VM_CONTEXT_FLAG_SIG_MANAGER) && !(context->m_flags & VM_CONTEXT_FLAG_IN_SIG_HANDLER)) {
-            if (0 == pthread_mutex_lock(&_vm_signal_registry.m_mutex)) {
-                sigset_t pending;
-                sigemptyset(&pending);
-                sigpending(&pending);
-                if (!sigisemptyset(&pending)) {
-                    int sig;
-                    if (0 == sigwait(&pending, &sig)) {
-                        if (sig >= 0 && sig < _vm_signal_registry.m_count) {
-                            if (_vm_signal_registry.m_handlers[sig] == VM_SIGNAL_DEFAULT) {
-                                debug("received signal expects default handling, re-raising: %i\n", sig);
-                                raise(sig);
-                                debug("raised\n");
-                            }
-                            else if (_vm_signal_registry.m_handlers[sig] == VM_SIGNAL_IGNORE) {
-                                debug("ignoring signal %i\n", sig);
-                            }
-                            else {
-                                debug("received signal %i, calling handler %"PRIuPTR"\n", sig, _vm_signal_registry.m_handlers[sig]);
-                                vm_state_t post_signal_state = {0};
-                                vm_state_init(&post_signal_state, context->m_counter, context->m_flags, context->m_symboltable);
-                                vm_rs_push(context, &post_signal_state);
-                                vm_state_destroy(&post_signal_state);
-                                vm_start_scope(context);
-                                context->m_flags |= VM_CONTEXT_FLAG_IN_SIG_HANDLER;
-                                context->m_counter = _vm_signal_registry.m_handlers[sig];
-                            }
-                        }
-                        else {
-                            debug("signal %i is out of range for installed handlers, re-raising it\n", sig);
-                            raise(sig);
-                            debug("raised\n");
-                        }
-                    }
-                }
-                pthread_mutex_unlock(&_vm_signal_registry.m_mutex);
-            }
-            else {
-                debug("couldn't lock signal registry mutex, not processing signals\n");
-            }
-        }
-    }
+    vm_start_scope(context, context->m_counter);
+    
+    bytecode_execute(context);
     
-end:
     debug("vm_execute of context %p about to finish\n", context);
-    if (context->m_symboltable)  vm_end_scope(context);
+    if (0 == pthread_mutex_lock(&_vm_signal_registry.m_mutex)) {
+        if (_vm_signal_registry.m_target == context)  _vm_signal_registry.m_target = NULL;
+        pthread_mutex_unlock(&_vm_signal_registry.m_mutex);
+    }
     vm_context_destroy(context);
     debug("context %p destroyed\n", context);
     free(context);
@@ -246,6 +250,79 @@ end:
 }
 
 
+/*
+=item vm_poll_signals()
+
+Called from the interpreter loop when the context's pending signal flag has been raised by the signal thread.  Takes
+the next pending signal and arranges for its handler to be called with the signal number on the stack, as though by
+CALL from the current position: when the handler returns, execution resumes where it left off.
+
+Signals are not processed while a handler is still running; they remain pending until it returns.
+
+=cut
+*/
+int vm_poll_signals(vm_context_t *context) {
+    assert(context != NULL);
+    
+    if (context->m_flags & VM_CONTEXT_FLAG_IN_SIG_HANDLER)  return 0;
+    
+    int sig = 0;
+    function_handle_t handler = VM_SIGNAL_DEFAULT;
+    const op_t *handler_op;
+    
+    if (0 == pthread_mutex_lock(&_vm_signal_registry.m_mutex)) {
+        for (int i = 1; i < _vm_signal_registry.m_count; i++) {
+            if (sigismember(&_vm_signal_registry.m_pending, i) > 0) {
+                sig = i;
+                break;
+            }
+        }
+        if (sig > 0) {
+            sigdelset(&_vm_signal_registry.m_pending, sig);
+            handler = _vm_signal_registry.m_handlers[sig];
+        }
+        if (sigisemptyset(&_vm_signal_registry.m_pending)) {
+            atomic_store_explicit(&context->m_signal_pending, 0, memory_order_relaxed);
+        }
+        pthread_mutex_unlock(&_vm_signal_registry.m_mutex);
+    }
+    else {
+        debug("couldn't lock signal registry mutex, not processing signals\n");
+        return -1;
+    }
+    
+    if (sig == 0)  return 0;
+    
+    if (handler == VM_SIGNAL_DEFAULT) {
+        // the handler was reset since the signal arrived
+        debug("signal %i now expects default handling, re-raising\n", sig);
+        kill(getpid(), sig);
+    }
+    else if (handler == VM_SIGNAL_IGNORE) {
+        debug("ignoring signal %i\n", sig);
+    }
+    else if (NULL == (handler_op = program_op(context->m_program, handler))) {
+        debug("handler %"PRIuPTR" for signal %i is not an instruction, ignoring signal\n", handler, sig);
+    }
+    else {
+        debug("received signal %i, calling handler %"PRIuPTR"\n", sig, handler);
+        vm_state_t post_signal_state = {0};
+        vm_state_init(&post_signal_state, context->m_counter, context->m_flags, context->m_symboltable);
+        vm_rs_push(context, &post_signal_state);
+        vm_state_destroy(&post_signal_state);
+        vm_start_scope(context, handler_op);
+        
+        scalar_t s = {0};
+        anon_scalar_set_int_value(&s, sig);
+        vm_ds_give(context, &s);
+        
+        context->m_flags |= VM_CONTEXT_FLAG_IN_SIG_HANDLER;
+        context->m_counter = handler_op;
+    }
+    
+    return 0;
+}
+
 /*
 =item vm_signal()
 
@@ -254,7 +331,8 @@ Sends a signal to the virtual machine.
 =cut
 */
 int vm_signal(int sig) {
-    return raise(sig);
+    // n.b. not raise(), which would leave it pending on the calling thread, where it is blocked
+    return kill(getpid(), sig);
 }
 
 /*
@@ -269,17 +347,10 @@ int vm_set_signal_handler(int sig, function_handle_t handle) {
     assert(sig < NSIG);
     
     if (0 == pthread_mutex_lock(&_vm_signal_registry.m_mutex)) {
-        _vm_signal_registry.m_handlers[sig] = handle;
-        switch (handle) {
-            case VM_SIGNAL_DEFAULT:
-                sigdelset(&_vm_signal_registry.m_sigset, sig);
-                break;
-            case VM_SIGNAL_IGNORE:
-            default:
-                sigaddset(&_vm_signal_registry.m_sigset, sig);
-                break;
+        if (handle != VM_SIGNAL_DEFAULT && !sigismember(&_vm_signal_registry.m_sigset, sig)) {
+            debug("signal %i is not routed through the signal thread, handler will not be called\n", sig);
         }
-        pthread_sigmask(SIG_SETMASK, &_vm_signal_registry.m_sigset, NULL);
+        _vm_signal_registry.m_handlers[sig] = handle;
         pthread_mutex_unlock(&_vm_signal_registry.m_mutex);
         return 0;
     }
@@ -312,7 +383,23 @@ int vm_set_signal_handler(int sig, function_handle_t handle) {
 
 =item vm_ds_over()
 
-Data stack management functions
+Data stack management functions.  Pushing clones the given values, and popping clones the items into the results.
+
+=item vm_ds_give()
+
+=item vm_ds_take()
+
+=item vm_ds_ngive()
+
+=item vm_ds_ntake()
+
+=item vm_ds_peek()
+
+Data stack management functions that move rather than copy.  Giving moves the given values onto the stack, leaving
+them undefined, so there's no need (but no harm) to destroy them afterwards.  Taking moves items off the stack into the
+results, destroying whatever the results held before.  Peeking returns a pointer to the nth item from the top, without
+popping it.  The pointer is only valid until the data stack is next modified.  Peeked items are contiguous, so
+vm_ds_peek(context, n - 1) points to the first (deepest) of the top n.
 
 =cut
  */
@@ -367,6 +454,40 @@ int vm_ds_over(vm_context_t *context) {
     return STACK_OVER(scalar_t, &context->m_data_stack);
 }
 
+int vm_ds_give(vm_context_t *context, scalar_t *value) {
+    assert(context != NULL);
+    assert(value != NULL);
+
+    return STACK_GIVE(scalar_t, &context->m_data_stack, value);
+}
+
+int vm_ds_take(vm_context_t *context, scalar_t *result) {
+    assert(context != NULL);
+    assert(result != NULL);
+
+    return STACK_TAKE(scalar_t, &context->m_data_stack, result);
+}
+
+int vm_ds_ngive(vm_context_t *context, size_t count, scalar_t *values) {
+    assert(context != NULL);
+    assert(values != NULL);
+
+    return STACK_NGIVE(scalar_t, &context->m_data_stack, count, values);
+}
+
+int vm_ds_ntake(vm_context_t *context, size_t count, scalar_t *results) {
+    assert(context != NULL);
+    assert(results != NULL);
+
+    return STACK_NTAKE(scalar_t, &context->m_data_stack, count, results);
+}
+
+scalar_t *vm_ds_peek(vm_context_t *context, size_t n) {
+    assert(context != NULL);
+
+    return STACK_PEEK(scalar_t, &context->m_data_stack, n);
+}
+
 
 /*
 =item vm_rs_push()
@@ -405,15 +526,38 @@ Starts a new scope within the current context.  Scope affects availability of sy
 in a scope are only available to the scope itself and any descendant scopes, and cease to exist when the 
 scope and all its descendants have ended.
 
+A context's outermost scope holds its globals in a tree.  Every nested scope (i.e. every function call) instead gets a
+slot for each identifier defined by the function starting at entry, as recorded by the program loader, so that its
+locals can be defined and found without searching a tree.  Any other symbols it ends up with go in its tree.
+
+Nested scopes are frames: they're allocated from the context's frame arena and aren't registered for garbage
+collection, so starting and ending one involves neither malloc nor any global lock.  That's safe because nothing
+outside the context can refer to one of its scopes: CORO and FRCORO children start with scopes of their own, and
+symbol_clone() only takes references to the objects that symbols refer to.  The outermost scope is heap allocated and
+registered as usual.
+
 =cut
  */
-int vm_start_scope(vm_context_t *context) {
+int vm_start_scope(vm_context_t *context, const op_t *entry) {
     assert(context != NULL);
-    
-    symboltable_t *new_table = calloc(1, sizeof(*new_table));
-    if (new_table == NULL)  return -1;
-    
-    symboltable_init(new_table, context->m_symboltable);
+    assert(entry != NULL);
+
+    symboltable_t *new_table;
+
+    if (context->m_symboltable != NULL) {
+        const frame_layout_t *layout = entry->m_frame_layout;
+        const size_t slot_count = (layout != NULL ? layout->m_slot_count : 0);
+        new_table = arena_allocate(&context->m_frame_arena, SYMBOLTABLE_SIZE(slot_count));
+        if (new_table == NULL)  return -1;
+        symboltable_init(new_table, context->m_symboltable, slot_count, (layout != NULL ? layout->m_identifiers : NULL),
+                         SYMBOLTABLE_FLAG_FRAME);
+    }
+    else {
+        new_table = calloc(1, SYMBOLTABLE_SIZE(0));
+        if (new_table == NULL)  return -1;
+        symboltable_init(new_table, NULL, 0, NULL, 0);
+    }
+
     context->m_symboltable = new_table;
     
     return 0;
@@ -432,9 +576,20 @@ int vm_end_scope(vm_context_t *context) {
     
     symboltable_t *old_table = context->m_symboltable;
     context->m_symboltable = context->m_symboltable->m_parent;
+
+    const flags32_t flags = old_table->m_flags;
     
     if (0 == symboltable_destroy(old_table)) {
-        free(old_table);
+        if (flags & SYMBOLTABLE_FLAG_FRAME) {
+            arena_release(&context->m_frame_arena, old_table);
+        }
+        else {
+            free(old_table);
+        }
+    }
+    else if (flags & SYMBOLTABLE_FLAG_FRAME) {
+        // n.b. its memory stays allocated until the context is destroyed
+        debug("frame %p is still referenced after its scope ended\n", old_table);
     }
     
     return 0;
@@ -453,15 +608,16 @@ Initialise a vm_context_t object.
 
 =cut
 */
-int vm_context_init(vm_context_t *self, const uint8_t *bytecode, size_t bytecode_len, size_t start) {
+int vm_context_init(vm_context_t *self, const program_t *program, const op_t *start) {
     assert(self != NULL);
     memset(self, 0, sizeof(*self));
     
     if (0 == STACK_INIT(scalar_t, &self->m_data_stack)) {
         if (0 == STACK_INIT(vm_state_t, &self->m_return_stack)) {
-            self->m_bytecode = bytecode;
-            self->m_bytecode_length = bytecode_len;
+            self->m_program = program;
             self->m_counter = start;
+            arena_init(&self->m_frame_arena);
+            atomic_init(&self->m_signal_pending, 0);
             
             vm_context_registry_node_t *node = calloc(1, sizeof(*node));
             if (node) {
@@ -514,11 +670,18 @@ int vm_context_destroy(vm_context_t *self) {
     // clean up
     STACK_DESTROY(scalar_t, &self->m_data_stack);
     STACK_DESTROY(vm_state_t, &self->m_return_stack);
-    
-    if (self->m_symboltable != NULL && 0 == symboltable_destroy(self->m_symboltable)) {
-        free(self->m_symboltable);
-        self->m_symboltable = NULL;
-    }
+
+    // n.b. the context may have ended from within a function, so there can be any number of scopes still open
+    while (self->m_symboltable != NULL)  vm_end_scope(self);
+
+    arena_destroy(&self->m_frame_arena);
+
+    // give this thread's cached free objects back to their pools, before vm_main can decide everything's finished
+    stream_pool_flush();
+    channel_pool_flush();
+    hash_pool_flush();
+    array_pool_flush();
+    scalar_pool_flush();
     
     // remove from registry
     if (0 == pthread_mutex_lock(&_vm_context_registry.m_mutex)) {
@@ -565,13 +728,13 @@ int vm_context_destroy(vm_context_t *self) {
 
 =cut
 */
-int vm_state_init(vm_state_t *restrict self, function_handle_t position, flags32_t flags, symboltable_t *restrict symboltable) {
+int vm_state_init(vm_state_t *restrict self, const op_t *position, flags32_t flags, symboltable_t *restrict symboltable) {
     assert(self != NULL);
     
     self->m_position = position;
     self->m_flags = flags;
     self->m_symboltable_top = symboltable;
-    if (self->m_symboltable_top != NULL)  ++self->m_symboltable_top->m_references;
+    if (self->m_symboltable_top != NULL)  symboltable_reference(self->m_symboltable_top);
     
     return 0;
 }
@@ -584,7 +747,7 @@ int vm_state_destroy(vm_state_t *self) {
         self->m_symboltable_top = NULL;
     }
     
-    self->m_position = 0;
+    self->m_position = NULL;
     self->m_flags = 0;
     return 0;
 }
@@ -595,13 +758,113 @@ int vm_state_clone(vm_state_t *restrict self, const vm_state_t *restrict other)
     assert(self != other);
     
     self->m_position = other->m_position;
+    self->m_flags = other->m_flags;
     self->m_symboltable_top = other->m_symboltable_top;
-    if (self->m_symboltable_top)  ++self->m_symboltable_top->m_references;
+    if (self->m_symboltable_top)  symboltable_reference(self->m_symboltable_top);
     
     return 0;
 }
 
 
+/*
+=back
+
+=head1 PRIVATE INTERFACE
+
+=over
+
+=item _vm_signal_thread()
+
+Accepts every signal in the signal registry's set with sigwait(), so that no interpreter thread ever has to check
+for them.  Signals with a handler installed are added to the pending set, and the target context's pending flag is
+raised; the target notices this with a single relaxed load per instruction.  Ignored signals are dropped, and
+signals with default handling are re-raised in this thread with default disposition.
+
+Runs until cancelled by vm_main().
+
+=cut
+*/
+static void *_vm_signal_thread(void *arg) {
+    for (;;) {
+        int sig, status, cancel_state;
+        
+        if (0 != (status = sigwait(&_vm_signal_registry.m_sigset, &sig))) {
+            debug("sigwait failed with status %i\n", status);
+            continue;
+        }
+        
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancel_state);
+        if (0 == pthread_mutex_lock(&_vm_signal_registry.m_mutex)) {
+            const function_handle_t handler = _vm_signal_registry.m_handlers[sig];
+            
+            if (handler == VM_SIGNAL_DEFAULT) {
+                pthread_mutex_unlock(&_vm_signal_registry.m_mutex);
+                debug("received signal expects default handling, re-raising: %i\n", sig);
+                _vm_signal_default(sig);
+            }
+            else if (handler == VM_SIGNAL_IGNORE) {
+                pthread_mutex_unlock(&_vm_signal_registry.m_mutex);
+                debug("ignoring signal %i\n", sig);
+            }
+            else if (_vm_signal_registry.m_target != NULL) {
+                sigaddset(&_vm_signal_registry.m_pending, sig);
+                atomic_store_explicit(&_vm_signal_registry.m_target->m_signal_pending, 1, memory_order_relaxed);
+                pthread_mutex_unlock(&_vm_signal_registry.m_mutex);
+            }
+            else {
+                pthread_mutex_unlock(&_vm_signal_registry.m_mutex);
+                debug("no context to handle signal %i, dropping it\n", sig);
+            }
+        }
+        else {
+            debug("couldn't lock signal registry mutex, dropping signal %i\n", sig);
+        }
+        pthread_setcancelstate(cancel_state, NULL);
+    }
+    
+    return NULL;
+}
+
+/*
+=item _vm_signal_default()
+
+Delivers a signal to the calling thread with its default disposition, by briefly unblocking it.
+
+=cut
+*/
+static void _vm_signal_default(int sig) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, sig);
+    
+    pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+    raise(sig);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+}
+
+/*
+=item _vm_print_pool_stats()
+
+Prints one line of a pool's allocation counts, as returned by its stats function, to stderr.
+
+=cut
+*/
+static void _vm_print_pool_stats(const char *name, int (*stats_function)(pool_magazine_stats_t *)) {
+    pool_magazine_stats_t stats;
+
+    if (0 != stats_function(&stats)) {
+        debug("couldn't get %s pool stats\n", name);
+        return;
+    }
+
+    fprintf(stderr, "%s pool: %zu allocations, %zu releases, "
+                    "%zu refills (%zu objects), %zu drains (%zu objects), "
+                    "%zu chunks claimed (%zu objects returned)\n", name,
+                    stats.m_allocations, stats.m_releases,
+                    stats.m_refills, stats.m_refilled, stats.m_drains, stats.m_drained,
+                    stats.m_claims, stats.m_returned);
+}
+
 /*
 =back
 
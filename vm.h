@@ -11,7 +11,10 @@
 #define VM_H
 
 #include <pthread.h>
+#include <stdatomic.h>
 
+#include "arena.h"
+#include "program.h"
 #include "scalar.h"
 #include "stack.h"
 #include "symboltable.h"
@@ -19,8 +22,13 @@
 #define VM_SIGNAL_DEFAULT   (function_handle_t)(-1)
 #define VM_SIGNAL_IGNORE    (function_handle_t)(-2)
 
+#define VM_CONTEXT_FLAG_SIG_MANAGER     0x00000001u
+#define VM_CONTEXT_FLAG_IN_SIG_HANDLER  0x00000002u
+
+#define VM_MAIN_FLAG_POOL_STATS         0x00000001u
+
 typedef struct vm_state_t {
-    function_handle_t m_position;
+    const op_t *m_position;
     flags32_t m_flags;
     symboltable_t *m_symboltable_top;
 } vm_state_t;
@@ -30,23 +38,25 @@ typedef STACK_STRUCT(vm_state_t) return_stack_t;
 
 typedef struct vm_context_t {
     flags32_t m_flags;
-    const uint8_t *m_bytecode;
-    size_t  m_bytecode_length;
-    size_t  m_counter;
+    const program_t *m_program;
+    const op_t *m_counter;
     data_stack_t m_data_stack;
     return_stack_t m_return_stack;
     symboltable_t *m_symboltable;
+    arena_t m_frame_arena;
+    atomic_int m_signal_pending;
 } vm_context_t;
 
-int vm_main(const uint8_t *, size_t, size_t);
+int vm_main(const uint8_t *, size_t, size_t, flags32_t);
 void *vm_execute(void *);  // n.b. actually takes and returns a vm_context_t*
+int vm_poll_signals(vm_context_t *);
 int vm_signal(int);
 int vm_set_signal_handler(int, function_handle_t);
 
-int vm_context_init(vm_context_t *, const uint8_t *, size_t, size_t);
+int vm_context_init(vm_context_t *, const program_t *, const op_t *);
 int vm_context_destroy(vm_context_t *);
 
-int vm_state_init(vm_state_t *restrict, function_handle_t, flags32_t, symboltable_t *restrict);
+int vm_state_init(vm_state_t *restrict, const op_t *, flags32_t, symboltable_t *restrict);
 int vm_state_destroy(vm_state_t *);
 int vm_state_clone(vm_state_t *restrict, const vm_state_t *restrict);
 
@@ -58,12 +68,17 @@ int vm_ds_npop(vm_context_t *, size_t, scalar_t *);
 int vm_ds_swap(vm_context_t *);
 int vm_ds_dup(vm_context_t *);
 int vm_ds_over(vm_context_t *);
+int vm_ds_give(vm_context_t *, scalar_t *);
+int vm_ds_take(vm_context_t *, scalar_t *);
+int vm_ds_ngive(vm_context_t *, size_t, scalar_t *);
+int vm_ds_ntake(vm_context_t *, size_t, scalar_t *);
+scalar_t *vm_ds_peek(vm_context_t *, size_t);
 
 int vm_rs_push(vm_context_t *, const vm_state_t *);
 int vm_rs_pop(vm_context_t *, vm_state_t *);
 int vm_rs_top(vm_context_t *, vm_state_t *);
 
-int vm_start_scope(vm_context_t *);
+int vm_start_scope(vm_context_t *, const op_t *);
 int vm_end_scope(vm_context_t *);
 
 #endif